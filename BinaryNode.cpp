@@ -26,6 +26,10 @@
 		structure. The BinaryNode struct's data members are the data it stores, the 
 		height of the BinaryNode, and its left and right child pointers, which are 
 		BinaryNode pointers to the next BinaryNode in the linked data structure. 
+		The size member is an int that stores the number of BinaryNodes in the 
+		subtree whose root is this BinaryNode, including itself, which lets an AVL 
+		Tree find the rank of an element and the element with a given rank 
+		without visiting every node. 
 		The height member is an int that stores the height of the BinaryNode, which 
 		we need in an AVL Tree. There's also a method named is_leaf() that returns 
 		true if this BinaryNode has no children. The BinaryNode struct is
@@ -40,12 +44,20 @@ struct BinaryNode {
 	BinaryNode* left_child;
 	BinaryNode* right_child;
 	int height;
+	int size;
 	BinaryNode(const T& some_data, BinaryNode* left_node, BinaryNode* right_node) 
 	{
 		data = some_data;
 		left_child = left_node;
 		right_child = right_node;
 		height = 0;
+		size = 1;
+		if (left_child != nullptr) {
+			size += left_child->size;
+		}
+		if (right_child != nullptr) {
+			size += right_child->size;
+		}
 	}
 
 	BinaryNode(const T& some_data) {
@@ -53,12 +65,14 @@ struct BinaryNode {
 		left_child = nullptr;
 		right_child = nullptr;
 		height = 0;
+		size = 1;
 	}
 
 	BinaryNode() {
 		left_child = nullptr;
 		right_child = nullptr;
 		height = 0;
+		size = 1;
 	}
 
 	bool is_leaf() {
@@ -14,17 +14,22 @@
 #include "avl.h"
 #include <algorithm>
 #include <cctype>
-#include "haversine.cpp"
+#include "haversine.h"
+#include "trace.h"
+#include "work_counters.h"
 #include "LevelOrderIterator.h"
+#include "perf_profiler.h"
+#include <sstream>
 
 AVL_Tree::AVL_Tree() {
  	root_ = nullptr;
-	std::map<std::string, int> species_count_;
+	hilbert_order_ = false;
 }
 
 AVL_Tree::AVL_Tree(const AVL_Tree& tree) {
+	root_ = nullptr;
+	hilbert_order_ = tree.hilbert_order_;
 	copy_tree(tree.root_);
-	species_count_ = tree.species_count_;
 }
 
 AVL_Tree::~AVL_Tree() {
@@ -47,11 +52,23 @@ int AVL_Tree::height() const {
 }
 
 const Tree& AVL_Tree::find(const Tree& x) const {
-	if (find(x, root_) == x) {
-		return x;
-	} else {
+	PerfRegion region("avl descent");
+	if (frozen_.built()) {
+		BinaryNode<Tree>* node = frozen_.find(x.common_name(), x.id());
+		if (node == nullptr) {
+			return kNotFound.data;
+		}
+		return node->data;
+	}
+	return find(x, root_);
+}
+
+const Tree& AVL_Tree::find_by_id(int tree_id) const {
+	BinaryNode<Tree>* node = id_index_.find(tree_id);
+	if (node == nullptr) {
 		return kNotFound.data;
 	}
+	return node->data;
 }
 
 const Tree& AVL_Tree::findMin() const {
@@ -68,7 +85,48 @@ const Tree& AVL_Tree::findMax() const {
 	return findMax(root_);
 }
 
+int AVL_Tree::rank(const Tree& x) const {
+	if (frozen_.built()) {
+		return frozen_.rank(x.common_name(), x.id());
+	}
+	int count = 0;
+	BinaryNode<Tree>* node = root_;
+	while (node != nullptr) {
+		if (node->data < x) {
+			count += get_number_of_trees(node->left_child) + 1;
+			node = node->right_child;
+		} else {
+			node = node->left_child;
+		}
+	}
+	return count;
+}
+
+const Tree& AVL_Tree::select(int i) const {
+	if (i < 0 || get_number_of_trees() <= i) {
+		return kNotFound.data;
+	}
+	if (frozen_.built()) {
+		return frozen_.row(i)->data;
+	}
+	BinaryNode<Tree>* node = root_;
+	while (node != nullptr) {
+		int left_size = get_number_of_trees(node->left_child);
+		if (i < left_size) {
+			node = node->left_child;
+		} else if (i == left_size) {
+			return node->data;
+		} else {
+			i -= left_size + 1;
+			node = node->right_child;
+		}
+	}
+	return kNotFound.data;
+}
+
 std::list<Tree> AVL_Tree::findallmatches(const Tree& x) const {
+	TraceSpan span("findallmatches");
+	PerfRegion region("species range scan");
 	std::list<Tree> match_list;
 	if (root_ == nullptr) {
 		return match_list;
@@ -82,18 +140,20 @@ std::list<Tree> AVL_Tree::findallmatches(const Tree& x) const {
 	//	first check if x's spc in all lowercase exists in AVL_Tree
 	//	then check if x's spc with the first letter capitalized exists in AVL_Tree
 	//	if neither exist, return an empty list
-	if (species_count_.find(spc) == species_count_.end()) {
+	int spec_count = count_name(spc);
+	if (0 == spec_count && !spc.empty()) {
 		change_case(spc);
-		if (species_count_.find(spc) == species_count_.end()) {
-			return match_list;
-		}
+		spec_count = count_name(spc);
+	}
+	if (0 == spec_count) {
+		return match_list;
 	}
-	int spec_count = species_count_.at(spc);
 	Tree z(0, 0, "", "", spc, 0, "", "", 0, 0);
 	return findallmatches(z, spec_count, match_list, root_);
 }
 
 int AVL_Tree::count_species(const std::string& species_name) const {
+	PerfRegion region("species range scan");
 	if (root_ == nullptr) {
 		return 0;
 	}
@@ -103,13 +163,12 @@ int AVL_Tree::count_species(const std::string& species_name) const {
 			c = tolower(c);
 		}
 	}
-	if (species_count_.find(spc) == species_count_.end()) {
+	int spec_count = count_name(spc);
+	if (0 == spec_count && !spc.empty()) {
 		change_case(spc);
-		if (species_count_.find(spc) == species_count_.end()) {
-			return 0;
-		}
+		spec_count = count_name(spc);
 	}
-	return species_count_.at(spc);
+	return spec_count;
 }
 
 std::list<std::string> AVL_Tree::all_in_zipcode(const int& zip) const {
@@ -118,6 +177,15 @@ std::list<std::string> AVL_Tree::all_in_zipcode(const int& zip) const {
 	if (root_ == nullptr || 99999 < zip) {
 		return match_list;
 	}
+	if (columns_.built()) {
+		std::vector<int> ranks;
+		WorkCounters::add_trees_visited(columns_.in_zipcode(zip, ranks));
+		for (unsigned int i = 0; i < ranks.size(); ++i) {
+			match_list.push_back(frozen_.row(ranks[i])->data.common_name());
+		}
+		return match_list;
+	}
+	WorkCounters::add_trees_visited(get_number_of_trees());
 	return all_in_zipcode(zip, root_, match_list);
 }
 	
@@ -128,24 +196,266 @@ std::list<std::string> AVL_Tree::all_nearby(const double& latitude,
 	if (root_ == nullptr) {
 		return match_list;
 	}
+	PerfRegion region("all_nearby traversal");
+	if (columns_.built()) {
+		//	the ranks are in order, so the names are in the same order as the 
+		//	traversal would give them
+		std::vector<int> ranks;
+		WorkCounters::add_trees_visited(
+		    columns_.candidates(latitude, longitude, distance, ranks));
+		WorkCounters::add_haversines(ranks.size());
+		double tree_lat, tree_lon;
+		for (unsigned int i = 0; i < ranks.size(); ++i) {
+			const Tree& tree = frozen_.row(ranks[i])->data;
+			tree.get_position(tree_lat, tree_lon);
+			if (distance >= haversine(latitude, longitude, tree_lat, tree_lon)) {
+				match_list.push_back(tree.common_name());
+			}
+		}
+		return match_list;
+	}
+	WorkCounters::add_trees_visited(get_number_of_trees());
+	WorkCounters::add_haversines(get_number_of_trees());
 	return all_nearby(latitude, longitude, distance, root_, match_list);
 }
 
+void AVL_Tree::group_all(GroupBy& groups) const {
+	WorkCounters::add_trees_visited(get_number_of_trees());
+	group_all(root_, groups);
+}
+
+void AVL_Tree::group_in_zipcode(const int& zip, GroupBy& groups) const {
+	//	check if zip is a possible zipcode
+	if (99999 < zip) {
+		return;
+	}
+	if (columns_.built()) {
+		std::vector<int> ranks;
+		WorkCounters::add_trees_visited(columns_.in_zipcode(zip, ranks));
+		for (unsigned int i = 0; i < ranks.size(); ++i) {
+			groups.add(frozen_.row(ranks[i])->data);
+		}
+		return;
+	}
+	WorkCounters::add_trees_visited(get_number_of_trees());
+	group_in_zipcode(zip, root_, groups);
+}
+
+void AVL_Tree::group_nearby(const double& latitude, const double& longitude,
+														const double& distance, GroupBy& groups) const {
+	PerfRegion region("all_nearby traversal");
+	if (columns_.built()) {
+		std::vector<int> ranks;
+		WorkCounters::add_trees_visited(
+		    columns_.candidates(latitude, longitude, distance, ranks));
+		WorkCounters::add_haversines(ranks.size());
+		double tree_lat, tree_lon;
+		for (unsigned int i = 0; i < ranks.size(); ++i) {
+			const Tree& tree = frozen_.row(ranks[i])->data;
+			tree.get_position(tree_lat, tree_lon);
+			if (distance >= haversine(latitude, longitude, tree_lat, tree_lon)) {
+				groups.add(tree);
+			}
+		}
+		return;
+	}
+	WorkCounters::add_trees_visited(get_number_of_trees());
+	WorkCounters::add_haversines(get_number_of_trees());
+	group_nearby(latitude, longitude, distance, root_, groups);
+}
+
+long long AVL_Tree::for_each_in_box(const std::vector<CoordinateBox>& boxes,
+                                     const TreeVisitor& visit) const {
+	PerfRegion region("all_nearby traversal");
+	if (columns_.built()) {
+		std::vector<int> ranks;
+		long long rows_read = columns_.candidates(boxes, ranks);
+		for (unsigned int i = 0; i < ranks.size(); ++i) {
+			visit(frozen_.row(ranks[i])->data);
+		}
+		return rows_read;
+	}
+	for_each(visit, root_);
+	return get_number_of_trees();
+}
+
 void AVL_Tree::print(std::ostream& out) const {
 	print(out, root_);
 }
 
+void AVL_Tree::print(std::ostream& out, int first, int last) const {
+	print(out, root_, 0, first, last);
+}
+
+std::list<std::string> AVL_Tree::all_in_zipcode(const int& zip,
+																						WorkStealingPool& pool,
+																						int grain) const {
+	std::list<std::string> match_list;
+	//	check if zip is a possible zipcode
+	if (root_ == nullptr || 99999 < zip) {
+		return match_list;
+	}
+	if (columns_.built()) {
+		std::vector<int> ranks = zipcode_ranks(zip, pool, grain);
+		for (unsigned int i = 0; i < ranks.size(); ++i) {
+			match_list.push_back(frozen_.row(ranks[i])->data.common_name());
+		}
+		return match_list;
+	}
+	WorkCounters::add_trees_visited(get_number_of_trees());
+	std::vector<TraversalPiece> pieces;
+	split(root_, grain, pieces);
+	std::vector<std::list<std::string> > buffers(pieces.size());
+	pool.parallel_for(pieces.size(), [&](int i, int worker) {
+		std::list<std::string>& buffer = buffers[i];
+		visit(pieces[i], [zip, &buffer](const Tree& tree) {
+			if (zip == tree.zip()) {
+				buffer.push_back(tree.common_name());
+			}
+		});
+	});
+	for (unsigned int i = 0; i < buffers.size(); ++i) {
+		match_list.splice(match_list.end(), buffers[i]);
+	}
+	return match_list;
+}
+
+std::list<std::string> AVL_Tree::all_nearby(const double& latitude,
+																						const double& longitude,
+																						const double& distance,
+																						WorkStealingPool& pool,
+																						int grain) const {
+	std::list<std::string> match_list;
+	if (root_ == nullptr) {
+		return match_list;
+	}
+	if (columns_.built()) {
+		std::vector<int> ranks = nearby_ranks(latitude, longitude, distance, 
+		                                      pool, grain);
+		for (unsigned int i = 0; i < ranks.size(); ++i) {
+			match_list.push_back(frozen_.row(ranks[i])->data.common_name());
+		}
+		return match_list;
+	}
+	WorkCounters::add_trees_visited(get_number_of_trees());
+	WorkCounters::add_haversines(get_number_of_trees());
+	std::vector<TraversalPiece> pieces;
+	split(root_, grain, pieces);
+	std::vector<std::list<std::string> > buffers(pieces.size());
+	double lat = latitude, lon = longitude, dist = distance;
+	pool.parallel_for(pieces.size(), [&](int i, int worker) {
+		std::list<std::string>& buffer = buffers[i];
+		visit(pieces[i], [lat, lon, dist, &buffer](const Tree& tree) {
+			double tree_lat, tree_lon;
+			tree.get_position(tree_lat, tree_lon);
+			if (dist >= haversine(lat, lon, tree_lat, tree_lon)) {
+				buffer.push_back(tree.common_name());
+			}
+		});
+	});
+	for (unsigned int i = 0; i < buffers.size(); ++i) {
+		match_list.splice(match_list.end(), buffers[i]);
+	}
+	return match_list;
+}
+
+void AVL_Tree::group_nearby(const double& latitude, const double& longitude,
+														const double& distance, GroupBy& groups,
+														WorkStealingPool& pool, int grain) const {
+	if (columns_.built()) {
+		std::vector<int> ranks = nearby_ranks(latitude, longitude, distance, 
+		                                      pool, grain);
+		for (unsigned int i = 0; i < ranks.size(); ++i) {
+			groups.add(frozen_.row(ranks[i])->data);
+		}
+		return;
+	}
+	WorkCounters::add_trees_visited(get_number_of_trees());
+	WorkCounters::add_haversines(get_number_of_trees());
+	std::vector<TraversalPiece> pieces;
+	split(root_, grain, pieces);
+	//	the counts do not depend on the order, so each worker has one GroupBy
+	std::vector<GroupBy> worker_groups(pool.size(), 
+																		 GroupBy(groups.number_of_species(),
+																						 groups.key()));
+	double lat = latitude, lon = longitude, dist = distance;
+	pool.parallel_for(pieces.size(), [&](int i, int worker) {
+		GroupBy& local = worker_groups[worker];
+		visit(pieces[i], [lat, lon, dist, &local](const Tree& tree) {
+			double tree_lat, tree_lon;
+			tree.get_position(tree_lat, tree_lon);
+			if (dist >= haversine(lat, lon, tree_lat, tree_lon)) {
+				local.add(tree);
+			}
+		});
+	});
+	for (unsigned int w = 0; w < worker_groups.size(); ++w) {
+		groups.merge(worker_groups[w]);
+	}
+}
+
+void AVL_Tree::print(std::ostream& out, WorkStealingPool& pool, int grain)
+										 const {
+	//	the FrozenIndex has the Trees in order in an array, so its pieces are
+	//	ranges of grain ranks
+	int trees = get_number_of_trees();
+	std::vector<TraversalPiece> pieces;
+	if (!frozen_.built()) {
+		split(root_, grain, pieces);
+	}
+	grain = std::max(1, grain);
+	std::vector<std::ostringstream> buffers(frozen_.built() ?
+	                                        (trees + grain - 1) / grain :
+	                                        pieces.size());
+	for (unsigned int i = 0; i < buffers.size(); ++i) {
+		buffers[i].copyfmt(out);
+	}
+	pool.parallel_for(buffers.size(), [&](int i, int worker) {
+		std::ostringstream& buffer = buffers[i];
+		if (frozen_.built()) {
+			int last = std::min(trees, (i + 1) * grain);
+			for (int rank = i * grain; rank < last; ++rank) {
+				buffer << frozen_.row(rank)->data;
+			}
+			return;
+		}
+		visit(pieces[i], [&buffer](const Tree& tree) {
+			buffer << tree;
+		});
+	});
+	for (unsigned int i = 0; i < buffers.size(); ++i) {
+		out << buffers[i].str();
+	}
+	//	leave out formatted the way the last Tree object left it
+	if (!buffers.empty()) {
+		out.copyfmt(buffers.back());
+	}
+}
+
 void AVL_Tree::clear() {
-	species_count_.clear();
+	frozen_.clear();
+	columns_.clear();
+	id_index_.clear();
 	clear(root_);
 }
 
-void AVL_Tree::insert(const Tree& x) {
-	insert(x, root_);
+bool AVL_Tree::insert(const Tree& x) {
+	PerfRegion region("avl insert");
+	if (insert(x, root_, 0)) {
+		frozen_.clear();
+		columns_.clear();
+		return true;
+	}
+	return false;
 }
 
-void AVL_Tree::remove(const Tree& x) {
-	remove(x, root_);
+bool AVL_Tree::remove(const Tree& x) {
+	if (remove(x, root_)) {
+		frozen_.clear();
+		columns_.clear();
+		return true;
+	}
+	return false;
 }
 
 void AVL_Tree::change_case(std::string& species) const {
@@ -158,6 +468,37 @@ void AVL_Tree::change_case(std::string& species) const {
 	}
 }
 
+void AVL_Tree::freeze() {
+	frozen_.build(root_);
+	columns_.build(frozen_, hilbert_order_);
+}
+
+void AVL_Tree::set_hilbert_order(bool on) {
+	hilbert_order_ = on;
+	if (frozen_.built()) {
+		columns_.build(frozen_, on);
+	}
+}
+
+bool AVL_Tree::frozen() const {
+	return frozen_.built();
+}
+
+RebalanceCounters AVL_Tree::rebalance_counters() const {
+	return counters_;
+}
+
+void AVL_Tree::add_memory_usage(MemoryReport& report) const {
+	MemoryUsage nodes;
+	add_memory_usage(root_, nodes);
+	report.add("AVL_Tree nodes", nodes);
+	report.add("Tree common names", Tree::species_names_usage());
+	report.add("tree_id index", id_index_.memory_usage());
+	report.add("FrozenIndex", frozen_.memory_usage());
+	report.add("coordinate columns", columns_.memory_usage());
+	report.add("rebalance counters", vector_usage(counters_.insert_depths));
+}
+
 /*******************************************************************************
 
 																	PROTECTED
@@ -177,8 +518,38 @@ int AVL_Tree::get_number_of_trees(BinaryNode<Tree>* node) const {
 	if (node == nullptr) {
 		return 0;
 	}
-	return 1 + get_number_of_trees(node->left_child) + 
-             get_number_of_trees(node->right_child);
+	return node->size;
+}
+
+void AVL_Tree::update(BinaryNode<Tree>* node) {
+	node->height = std::max(height(node->left_child), height(node->right_child)) +
+													1;
+	node->size = get_number_of_trees(node->left_child) + 
+							 get_number_of_trees(node->right_child) + 1;
+}
+
+//	this is rank() with islessname instead of operator<, so the tree_id of z 
+//	does not matter
+int AVL_Tree::name_rank(const Tree& z, bool or_equal) const {
+	if (frozen_.built()) {
+		return frozen_.name_rank(z.common_name(), or_equal);
+	}
+	int count = 0;
+	BinaryNode<Tree>* node = root_;
+	while (node != nullptr) {
+		if (islessname(node->data, z) || (or_equal && samename(node->data, z))) {
+			count += get_number_of_trees(node->left_child) + 1;
+			node = node->right_child;
+		} else {
+			node = node->left_child;
+		}
+	}
+	return count;
+}
+
+int AVL_Tree::count_name(const std::string& species) const {
+	Tree z(0, 0, "", "", species, 0, "", "", 0, 0);
+	return name_rank(z, true) - name_rank(z, false);
 }
 
 int AVL_Tree::height(BinaryNode<Tree>* node) const {
@@ -190,30 +561,40 @@ int AVL_Tree::height(BinaryNode<Tree>* node) const {
 	return node->height;
 }
 
+void AVL_Tree::add_memory_usage(BinaryNode<Tree>* node, 
+                                MemoryUsage& nodes) const {
+	if (node == nullptr) {
+		return;
+	}
+	nodes += heap_block_usage(node, sizeof(BinaryNode<Tree>),
+	                          sizeof(BinaryNode<Tree>));
+	add_memory_usage(node->left_child, nodes);
+	add_memory_usage(node->right_child, nodes);
+}
+
 const Tree& AVL_Tree::find(const Tree& x, BinaryNode<Tree>* node) const {
 	if (node == nullptr) {
 		return kNotFound.data;
-	} else if (x == node->data) {
-		return x;
 	} else if (x < node->data) {
-		find(x, node->left_child);
+		return find(x, node->left_child);
 	} else if (node->data < x) {
-		find(x, node->right_child);
+		return find(x, node->right_child);
 	}
+	return node->data;
 }
 
 const Tree& AVL_Tree::findMin(BinaryNode<Tree>* node) const {
 	if (node->left_child == nullptr) {
 		return node->data;
 	}
-	findMin(node->left_child);
+	return findMin(node->left_child);
 }
 
 const Tree& AVL_Tree::findMax(BinaryNode<Tree>* node) const {
 	if (node->right_child == nullptr) {
 		return node->data;
 	}
-	findMax(node->right_child);
+	return findMax(node->right_child);
 }
 
 std::list<Tree>& AVL_Tree::findallmatches(const Tree& z, const int& spec_count,
@@ -276,6 +657,50 @@ std::list<std::string>& AVL_Tree::all_nearby(const double& latitude,
 	return match_list;
 }
 
+//	the grouping methods do not need an inorder traversal because the counts 
+//	do not depend on the order the Tree objects are visited in
+void AVL_Tree::group_all(BinaryNode<Tree>* node, GroupBy& groups) const {
+	while (node != nullptr) {
+		group_all(node->left_child, groups);
+		groups.add(node->data);
+		node = node->right_child;
+	}
+}
+
+void AVL_Tree::group_in_zipcode(const int& zip, BinaryNode<Tree>* node,
+																GroupBy& groups) const {
+	while (node != nullptr) {
+		group_in_zipcode(zip, node->left_child, groups);
+		if (zip == node->data.zip()) {
+			groups.add(node->data);
+		}
+		node = node->right_child;
+	}
+}
+
+void AVL_Tree::group_nearby(const double& latitude, const double& longitude,
+														const double& distance, BinaryNode<Tree>* node,
+														GroupBy& groups) const {
+	double tree_lat, tree_lon;
+	while (node != nullptr) {
+		group_nearby(latitude, longitude, distance, node->left_child, groups);
+		node->data.get_position(tree_lat, tree_lon);
+		if (distance >= haversine(latitude, longitude, tree_lat, tree_lon)) {
+			groups.add(node->data);
+		}
+		node = node->right_child;
+	}
+}
+
+void AVL_Tree::for_each(const TreeVisitor& visit, BinaryNode<Tree>* node) 
+    const {
+	while (node != nullptr) {
+		for_each(visit, node->left_child);
+		visit(node->data);
+		node = node->right_child;
+	}
+}
+
 void AVL_Tree::print(std::ostream& out, BinaryNode<Tree>* node) const {
 	if (node == nullptr) {
 		return;
@@ -285,6 +710,19 @@ void AVL_Tree::print(std::ostream& out, BinaryNode<Tree>* node) const {
 	print(out, node->right_child);
 }
 
+void AVL_Tree::print(std::ostream& out, BinaryNode<Tree>* node, int offset,
+										 int first, int last) const {
+	if (node == nullptr || last <= offset || offset + node->size <= first) {
+		return;
+	}
+	int node_rank = offset + get_number_of_trees(node->left_child);
+	print(out, node->left_child, offset, first, last);
+	if (first <= node_rank && node_rank < last) {
+		out << node->data;
+	}
+	print(out, node->right_child, node_rank + 1, first, last);
+}
+
 void AVL_Tree::clear(BinaryNode<Tree>*& node) {
 	if (node == nullptr) {
 		return;
@@ -295,108 +733,120 @@ void AVL_Tree::clear(BinaryNode<Tree>*& node) {
 	node = nullptr;
 }
 
-void AVL_Tree::insert(const Tree& x, BinaryNode<Tree>*& node) {
+bool AVL_Tree::insert(const Tree& x, BinaryNode<Tree>*& node, int depth) {
 	if (node == nullptr) {
 		node = new BinaryNode<Tree>(x);
-		//	add species to species_count_
-		if (species_count_.find(x.common_name()) == species_count_.end()) {
-			species_count_[x.common_name()] = 1;
-		} else {
-			++species_count_[x.common_name()];
+		id_index_.insert(x.id(), node);
+		if (static_cast<int>(counters_.insert_depths.size()) <= depth) {
+			counters_.insert_depths.resize(depth + 1, 0);
 		}
-		return;
+		++counters_.insert_depths[depth];
+		return true;
 	} else if (x < node->data) {
-		insert(x, node->left_child);
+		if (!insert(x, node->left_child, depth + 1)) {
+			return false;
+		}
 		if ((height(node->left_child) - height(node->right_child)) == 2) {
 			if (x < node->left_child->data) {
+				++counters_.ll_rotations;
 				LL_rotate(node);
 			} else {
+				++counters_.lr_rotations;
 				LR_rotate(node);
 			}
 		}
 	} else if (node->data < x) {
-		insert(x, node->right_child);
+		if (!insert(x, node->right_child, depth + 1)) {
+			return false;
+		}
 		if ((height(node->right_child) - height(node->left_child)) == 2) {
 			if (node->right_child->data < x) {
+				++counters_.rr_rotations;
 				RR_rotate(node);
 			} else {
+				++counters_.rl_rotations;
 				RL_rotate(node);
 			}
 		}
 	} else {
-		return;
+		return false;
 	}
-	node->height = std::max(height(node->left_child), height(node->right_child)) +
-													1;
+	update(node);
+	return true;
 }
 
-void AVL_Tree::remove(const Tree& x, BinaryNode<Tree>*& node) {
+bool AVL_Tree::remove(const Tree& x, BinaryNode<Tree>*& node) {
 	if (node == nullptr) {
-		return;
-	} else if (x == node->data) {
-		remove_node(node);
-		--species_count_[x.common_name()];
+		return false;
 	} else if (x < node->data) {
-		remove(x, node->left_child);
-		if (height(node->right_child) - height(node->left_child) == 2) {
-			if (height((node->right_child)->right_child) >=
-					height((node->right_child)->left_child)) {
-				RR_rotate(node);
-			} else {
-				RL_rotate(node);
-			}
+		if (!remove(x, node->left_child)) {
+			return false;
 		}
 	} else if (node->data < x) {
-		remove(x, node->right_child);
-		if (height(node->left_child) - height(node->right_child) == 2) {
-			if (height((node->left_child)->left_child) >=
-					height((node->left_child)->right_child)) {
-				LL_rotate(node);
-			} else {
-				LR_rotate(node);
-			}
+		if (!remove(x, node->right_child)) {
+			return false;
 		}
+	} else if (node->left_child != nullptr && node->right_child != nullptr) {
+		//	replace x with its inorder successor and remove the successor from the
+		//	right subtree, so every node on the way down is rebalanced and resized
+		//	The successor now lives in node, so its tree_id has to point there
+		if (id_index_.find(node->data.id()) == node) {
+			id_index_.erase(node->data.id());
+		}
+		node->data = findMin(node->right_child);
+		remove(node->data, node->right_child);
+		id_index_.insert(node->data.id(), node);
+	} else {
+		if (id_index_.find(node->data.id()) == node) {
+			id_index_.erase(node->data.id());
+		}
+		remove_node(node);
+		return true;
 	}
-	if (node != nullptr) {
-		node->height = std::max(height(node->left_child),
-														height(node->right_child)) + 1;
-	}
+	balance(node);
+	return true;
 }
 
 void AVL_Tree::remove_node(BinaryNode<Tree>*& node) {
-	if (node->is_leaf()) {
-		delete node;
-		node = nullptr;
-	} else if (node->left_child != nullptr && node->right_child != nullptr) {
-		node->data = inorder_successor(node->right_child);
+	BinaryNode<Tree>* node_to_delete = node;
+	if (node->left_child != nullptr) {
+		node = node->left_child;
 	} else {
-		BinaryNode<Tree>* node_to_delete = node;
-		if (node->left_child != nullptr) {
-			node = node->left_child;
-		} else if (node->right_child != nullptr) {
-			node = node->right_child;
-		}
-		delete node_to_delete;
+		node = node->right_child;
 	}
+	delete node_to_delete;
 }
 
-Tree AVL_Tree::inorder_successor(BinaryNode<Tree>*& node) {
-	if (node->left_child == nullptr) {
-		Tree tree(node->data);
-		remove_node(node);
-		return tree;
+void AVL_Tree::balance(BinaryNode<Tree>*& node) {
+	if (height(node->right_child) - height(node->left_child) == 2) {
+		if (height((node->right_child)->right_child) >=
+				height((node->right_child)->left_child)) {
+			++counters_.rr_rotations;
+			RR_rotate(node);
+		} else {
+			++counters_.rl_rotations;
+			RL_rotate(node);
+		}
+	} else if (height(node->left_child) - height(node->right_child) == 2) {
+		if (height((node->left_child)->left_child) >=
+				height((node->left_child)->right_child)) {
+			++counters_.ll_rotations;
+			LL_rotate(node);
+		} else {
+			++counters_.lr_rotations;
+			LR_rotate(node);
+		}
+	} else {
+		update(node);
 	}
-	inorder_successor(node->left_child);
 }
 
-
 void AVL_Tree::LL_rotate(BinaryNode<Tree>*& node) {
 	BinaryNode<Tree>* new_root = node->left_child;
 	node->left_child = new_root->right_child;
 	new_root->right_child = node;
-	node->height = std::max(height(node->left_child), height(node->right_child)) +
-													1;
-	new_root->height = std::max(node->height, height(new_root->right_child)) + 1;
+	update(node);
+	update(new_root);
 	node = new_root;
 }
 
@@ -409,9 +859,8 @@ void AVL_Tree::RR_rotate(BinaryNode<Tree>*& node) {
 	BinaryNode<Tree>* new_root = node->right_child;
 	node->right_child = new_root->left_child;
 	new_root->left_child = node;
-	node->height = std::max(height(node->left_child), height(node->right_child)) +
-													1;
-	new_root->height = std::max(height(new_root->left_child), node->height) + 1;
+	update(node);
+	update(new_root);
 	node = new_root;
 }
 
@@ -420,3 +869,85 @@ void AVL_Tree::RL_rotate(BinaryNode<Tree>*& node) {
 	RR_rotate(node);
 }
 
+std::vector<int> AVL_Tree::zipcode_ranks(int zip, WorkStealingPool& pool,
+                                         int grain) const {
+	int blocks = std::max(1, grain / kColumnBlockRows);
+	std::vector<std::vector<int> > found(
+	    (columns_.number_of_blocks() + blocks - 1) / blocks);
+	pool.parallel_for(found.size(), [&](int i, int worker) {
+		WorkCounters::add_trees_visited(
+		    columns_.in_zipcode(zip, i * blocks, (i + 1) * blocks, found[i]));
+	});
+	return join_ranks(found);
+}
+
+std::vector<int> AVL_Tree::nearby_ranks(double latitude, double longitude,
+                                        double distance, WorkStealingPool& pool,
+                                        int grain) const {
+	int blocks = std::max(1, grain / kColumnBlockRows);
+	std::vector<std::vector<int> > found(
+	    (columns_.number_of_blocks() + blocks - 1) / blocks);
+	pool.parallel_for(found.size(), [&](int i, int worker) {
+		std::vector<int> ranks;
+		WorkCounters::add_trees_visited(
+		    columns_.candidates(latitude, longitude, distance, i * blocks, 
+		                        (i + 1) * blocks, ranks));
+		WorkCounters::add_haversines(ranks.size());
+		double tree_lat, tree_lon;
+		for (unsigned int j = 0; j < ranks.size(); ++j) {
+			frozen_.row(ranks[j])->data.get_position(tree_lat, tree_lon);
+			if (distance >= haversine(latitude, longitude, tree_lat, tree_lon)) {
+				found[i].push_back(ranks[j]);
+			}
+		}
+	});
+	return join_ranks(found);
+}
+
+//	in rank order the pieces are ranges of ranks, so only Hilbert order needs
+//	the sort
+std::vector<int> AVL_Tree::join_ranks(const std::vector<std::vector<int> >& 
+                                      found) const {
+	std::vector<int> ranks;
+	for (unsigned int i = 0; i < found.size(); ++i) {
+		ranks.insert(ranks.end(), found[i].begin(), found[i].end());
+	}
+	if (columns_.hilbert_order()) {
+		std::sort(ranks.begin(), ranks.end());
+	}
+	return ranks;
+}
+
+void AVL_Tree::split(BinaryNode<Tree>* node, int grain,
+										 std::vector<TraversalPiece>& pieces) const {
+	if (node == nullptr) {
+		return;
+	}
+	if (node->size <= grain) {
+		TraversalPiece piece = {node, true};
+		pieces.push_back(piece);
+		return;
+	}
+	split(node->left_child, grain, pieces);
+	TraversalPiece piece = {node, false};
+	pieces.push_back(piece);
+	split(node->right_child, grain, pieces);
+}
+
+void AVL_Tree::visit(const TraversalPiece& piece,
+										 const std::function<void(const Tree&)>& action) const {
+	if (piece.whole_subtree) {
+		visit(piece.node, action);
+	} else {
+		action(piece.node->data);
+	}
+}
+
+void AVL_Tree::visit(BinaryNode<Tree>* node,
+										 const std::function<void(const Tree&)>& action) const {
+	while (node != nullptr) {
+		visit(node->left_child, action);
+		action(node->data);
+		node = node->right_child;
+	}
+}
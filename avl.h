@@ -17,8 +17,15 @@
 
 #include "BinaryNode.cpp"
 #include "tree.h"
+#include "group_by.h"
+#include "tree_id_index.h"
+#include "frozen_index.h"
+#include "coordinate_columns.h"
+#include "tree_index.h"
+#include "work_stealing.h"
+#include <functional>
 #include <list>
-#include <map>
+#include <vector>
 const BinaryNode<Tree> kNotFound(Tree(0, 0, "", "", "x", 0, "", "", 0, 0));
 //	No Tree objects have "x" for an spc_common member, which is why kNotFound's
 //	spc_common member is "x"
@@ -39,10 +46,24 @@ const BinaryNode<Tree> kNotFound(Tree(0, 0, "", "", "x", 0, "", "", 0, 0));
 		and for finding all Tree objects that are a certain distance within given 
 		latitude and longitude coordinates
 
+		The map is no longer kept. Instead, each BinaryNode also stores the size 
+		of its subtree, which makes the AVL_Tree an order statistic tree: the 
+		number of Tree objects, the rank of a Tree object and the Tree object 
+		with a given rank are all found without visiting every node. The number 
+		of Tree objects that have the same spc_common member is the difference 
+		between the ranks of the first and last keys with that spc_common. The 
+		AVL_Tree also encapsulates a TreeIdIndex, a hash table from each Tree's 
+		tree_id to the BinaryNode that stores it, so a Tree can be found and 
+		removed using only its tree_id. Once the AVL_Tree stops changing, 
+		freeze() copies its keys into a FrozenIndex, an array that find, rank, 
+		select and the species counts search instead of the BinaryNodes until 
+		the next insert or remove. AVL_Tree is the TreeIndex that a 
+		TreeCollection uses unless it is given another one
+
 *******************************************************************************/
 
 
-class AVL_Tree {
+class AVL_Tree : public TreeIndex {
  public:
 	//	Default constructor for AVL_Tree object
 	AVL_Tree();
@@ -57,15 +78,20 @@ class AVL_Tree {
 	bool empty() const;
 
 	//	Returns the number of Tree objects in AVL_Tree object
+	//	This takes constant time because every BinaryNode stores its size
 	int get_number_of_trees() const;
 
 	//	Returns the height of the AVL_Tree
 	int height() const;
 
-	//	Returns Tree x if x is found. Otherwise, returns the Tree object stored 
-	//	in kNotFound if x is not found  
+	//	Returns the stored Tree object that is equal to x if x is found. 
+	//	Otherwise, returns the Tree object stored in kNotFound if x is not found  
 	const Tree& find(const Tree& x) const;
 
+	//	Returns the Tree object whose tree_id is tree_id using the TreeIdIndex
+	//	Returns the Tree object stored in kNotFound if there is no such Tree
+	const Tree& find_by_id(int tree_id) const;
+
 	//	Returns the minimum Tree object in the AVL_Tree
 	//	If called when AVL_Tree is empty, returns kNotFound
 	const Tree& findMin() const;
@@ -74,6 +100,14 @@ class AVL_Tree {
 	//	If called when AVL_Tree is empty, returns kNotFound
 	const Tree& findMax() const;
 
+	//	Returns the number of Tree objects in the AVL_Tree that are less than x 
+	//	which is the position x has or would have in an inorder traversal
+	int rank(const Tree& x) const;
+
+	//	Returns the Tree object whose rank is i, counting from 0
+	//	If i is not less than the number of Tree objects, returns kNotFound
+	const Tree& select(int i) const;
+
 	//	Returns a list of Tree objects whose spc_common member is equal to 
 	//	x's spc_common member. If x's spc_common member does not exist in the 
 	//	AVL_Tree object, the returned list will be empty
@@ -98,35 +132,156 @@ class AVL_Tree {
 																		const double& longitude,
 																		const double& distance) const;
 
+	//	Counts every Tree object in the AVL_Tree object in groups
+	void group_all(GroupBy& groups) const;
+
+	//	Counts the Tree objects found in the given zipcode in groups
+	void group_in_zipcode(const int& zip, GroupBy& groups) const;
+
+	//	Counts the Tree objects found within the given distance of the given 
+	//	latitude and longitude coordinates in kilometers in groups
+	void group_nearby(const double& latitude, const double& longitude,
+										const double& distance, GroupBy& groups) const;
+
+	//	Calls visit with each Tree object that may be inside one of boxes. If 
+	//	the AVL_Tree is frozen, only the Trees that the coordinate columns find
+	//	in the boxes are visited, and each of them once, and otherwise every 
+	//	Tree is. Returns the number of Trees read
+	long long for_each_in_box(const std::vector<CoordinateBox>& boxes,
+	                          const TreeVisitor& visit) const;
+
 	//	Prints all the Tree objects in the AVL_Tree object
 	void print(std::ostream& out) const;
 
+	//	Prints the Tree objects whose ranks are from first up to but not 
+	//	including last, in order
+	void print(std::ostream& out, int first, int last) const;
+
+	//	These methods give the same results as the methods above with the same 
+	//	names, in the same order, but split the traversal into pieces that pool 
+	//	does in parallel. A piece is either a subtree of at most grain Tree 
+	//	objects or a single node above such subtrees. Every piece collects its 
+	//	results in its own buffer, and the buffers are joined in the order of 
+	//	the pieces, which is the inorder order. group_nearby counts into one 
+	//	GroupBy per worker and adds them to groups at the end. When the 
+	//	AVL_Tree is frozen, the searches split the blocks of the coordinate 
+	//	columns into pieces of about grain rows instead, and print splits the 
+	//	FrozenIndex into ranges of grain ranks
+	std::list<std::string> all_in_zipcode(const int& zip, WorkStealingPool& pool,
+																				int grain = kTraversalGrain) const;
+	std::list<std::string> all_nearby(const double& latitude,
+																		const double& longitude,
+																		const double& distance,
+																		WorkStealingPool& pool,
+																		int grain = kTraversalGrain) const;
+	void group_nearby(const double& latitude, const double& longitude,
+										const double& distance, GroupBy& groups,
+										WorkStealingPool& pool, int grain = kTraversalGrain) const;
+	void print(std::ostream& out, WorkStealingPool& pool,
+						 int grain = kTraversalGrain) const;
+
 	//	Removes all Tree objects from the AVL_Tree object
 	//	After this method is called, root_ will point to null
 	void clear(); 
 
 	//	Adds the Tree object x to the AVL_Tree object
-	void insert(const Tree& x); 
+	//	Returns false if a Tree object equal to x was already stored
+	bool insert(const Tree& x); 
 
 	//	Removes the Tree object x from the AVL_Tree object
-	void remove(const Tree& x);
+	//	Returns false if no Tree object equal to x was stored
+	bool remove(const Tree& x);
 
 	//	Changes the case of species to match the case of the spc_common members 
 	//	of the Tree objects in the AVL_Tree object
 	void change_case(std::string& species) const;
 
+	//	Copies the keys of the Tree objects into the FrozenIndex so that find, 
+	//	rank, select and count_species search it. The next insert, remove or 
+	//	clear throws the FrozenIndex away
+	void freeze();
+
+	//	Makes the coordinate columns that freeze builds follow a Hilbert curve 
+	//	if on is true, so the nearby and zipcode searches skip the blocks of 
+	//	Trees that are far away, and rebuilds them if the AVL_Tree is frozen
+	void set_hilbert_order(bool on);
+
+	//	Returns true if freeze was called and the AVL_Tree has not changed since
+	bool frozen() const;
+
+	//	Returns how many times each rotation was done and how deep each Tree 
+	//	object was inserted since the AVL_Tree object was made
+	RebalanceCounters rebalance_counters() const;
+
+	//	Adds the memory used by the BinaryNodes, the common names the Tree 
+	//	objects share, the tree_id index and the FrozenIndex to report
+	void add_memory_usage(MemoryReport& report) const;
+
  protected:
+	//	A piece of a parallel traversal: the whole subtree of node if 
+	//	whole_subtree is true, or else only node itself
+	struct TraversalPiece {
+		BinaryNode<Tree>* node;
+		bool whole_subtree;
+	};
+
+	//	Adds the pieces of the AVL_Tree whose root is node to pieces, in order
+	//	Subtrees with more than grain Tree objects are split into their left 
+	//	subtree, their root and their right subtree
+	void split(BinaryNode<Tree>* node, int grain,
+						 std::vector<TraversalPiece>& pieces) const;
+
+	//	Calls action on every Tree object of piece in order
+	void visit(const TraversalPiece& piece,
+						 const std::function<void(const Tree&)>& action) const;
+
+	//	Return the ranks of the Tree objects in zip, or within distance 
+	//	kilometers of (latitude, longitude), in increasing order. columns_ must
+	//	be built. The blocks of columns_ are split into pieces of about grain 
+	//	rows that pool scans in parallel
+	std::vector<int> zipcode_ranks(int zip, WorkStealingPool& pool, 
+	                               int grain) const;
+	std::vector<int> nearby_ranks(double latitude, double longitude,
+	                              double distance, WorkStealingPool& pool,
+	                              int grain) const;
+
+	//	Returns the ranks in found, which each piece of a scan of columns_ 
+	//	added in increasing order, joined in increasing order
+	std::vector<int> join_ranks(const std::vector<std::vector<int> >& found)
+	                            const;
+
+	//	Calls action on every Tree object in the AVL_Tree whose root is node, 
+	//	in order
+	void visit(BinaryNode<Tree>* node,
+						 const std::function<void(const Tree&)>& action) const;
+
 	//	Copies the AVL_Tree whose root is node
 	void copy_tree(BinaryNode<Tree>* node);
 
 	//	Returns the number of Tree objects in the AVL_Tree whose root is node
 	int get_number_of_trees(BinaryNode<Tree>* node) const;
 
+	//	Sets the height and size of the BinaryNode that node points to from the 
+	//	heights and sizes of its children
+	void update(BinaryNode<Tree>* node);
+
+	//	Returns the number of Tree objects whose spc_common member is less than 
+	//	z's spc_common member, or less than or equal to it if or_equal is true
+	int name_rank(const Tree& z, bool or_equal) const;
+
+	//	Returns the number of Tree objects whose spc_common member is exactly 
+	//	species, which is case sensitive
+	int count_name(const std::string& species) const;
+
 	//	Returns the height of the AVL_Tree whose root is node
 	int height(BinaryNode<Tree>* node) const;
 
-	//	Returns Tree x if x is found in the AVL_Tree whose root is node. 
-	//	Otherwise, returns the Tree object stored in kNotFound if x is not found  
+	//	Adds the memory used by the BinaryNodes of the AVL_Tree whose root is
+	//	node to nodes
+	void add_memory_usage(BinaryNode<Tree>* node, MemoryUsage& nodes) const;
+
+	//	Returns the stored Tree equal to x if x is found in the AVL_Tree whose 
+	//	root is node. Otherwise, returns the Tree object stored in kNotFound
 	const Tree& find(const Tree& x, BinaryNode<Tree>* node) const;
 
 	//	Returns the minimum Tree object in the AVL_Tree whose root is node
@@ -167,28 +322,56 @@ class AVL_Tree {
 																		 BinaryNode<Tree>* node,
 																		 std::list<std::string>& match_list) const;
 
+	//	Counts the Tree object of the BinaryNode that node points to and the 
+	//	Tree objects in its subtrees in groups
+	void group_all(BinaryNode<Tree>* node, GroupBy& groups) const;
+
+	//	Counts the Tree objects in the AVL_Tree whose root is node that are in 
+	//	the given zipcode in groups
+	void group_in_zipcode(const int& zip, BinaryNode<Tree>* node,
+												GroupBy& groups) const;
+
+	//	Counts the Tree objects in the AVL_Tree whose root is node that are 
+	//	within the given distance of the given coordinates in groups
+	void group_nearby(const double& latitude, const double& longitude,
+										const double& distance, BinaryNode<Tree>* node,
+										GroupBy& groups) const;
+
+	//	Calls visit with every Tree object in the AVL_Tree whose root is node
+	void for_each(const TreeVisitor& visit, BinaryNode<Tree>* node) const;
+
 	//	Prints the Tree object stored in the BinaryNode that node points to
 	//	This method uses an inorder traversal
 	void print(std::ostream& out, BinaryNode<Tree>* node) const;
 
+	//	Prints the Tree objects in the AVL_Tree whose root is node whose ranks 
+	//	are from first up to but not including last. offset is the rank of the 
+	//	smallest Tree object in this AVL_Tree. Subtrees that are completely 
+	//	outside of the range are skipped using their sizes
+	void print(std::ostream& out, BinaryNode<Tree>* node, int offset, int first,
+						 int last) const;
+
 	//	Uses a postorder traversal to delete the AVL_Tree whose root is node
 	void clear(BinaryNode<Tree>*& node);
 
 	//	Adds x to this AVL_Tree object. The Tree object of the BinaryNode that 
 	//	node points to is used to determine where to place x is the AVL_Tree
-	void insert(const Tree& x, BinaryNode<Tree>*& node);
+	//	depth is the number of levels node is below the root
+	//	Returns false if x was already in the AVL_Tree
+	bool insert(const Tree& x, BinaryNode<Tree>*& node, int depth);
 
 	//	Removes x from this AVL_Tree object. The Tree object of the BinaryNode 
 	//	that node points to is used to search for x
-	void remove(const Tree& x, BinaryNode<Tree>*& node);
+	//	Returns false if x was not in the AVL_Tree
+	bool remove(const Tree& x, BinaryNode<Tree>*& node);
 
-	//	Deletes the BinaryNode object pointed to by node
+	//	Deletes the BinaryNode object pointed to by node, which has at most one 
+	//	child, and replaces it with its child
 	void remove_node(BinaryNode<Tree>*& node);
 
-	//	Returns a Tree object that is the inorder successor of the Tree object we 
-	//	want to remove from the AVL_Tree. The Tree object of the BinaryNode that 
-	//	node points to is used to search for the inorder successor
-	Tree inorder_successor(BinaryNode<Tree>*& node);
+	//	Rotates node if the heights of its subtrees differ by 2 so that the 
+	//	AVL_Tree whose root is node is balanced again
+	void balance(BinaryNode<Tree>*& node);
 
 	//	Rotates node and its left child to the right to rebalance AVL_Tree object
 	void LL_rotate(BinaryNode<Tree>*& node);
@@ -208,9 +391,24 @@ class AVL_Tree {
 	//	Pointer to the root of the AVL_Tree object
 	BinaryNode<Tree>* root_;
 
-	//	Map that stores all the spc_common members of the Tree objects and
-	//	how many Tree objects have a particular spc_common
-	std::map<std::string, int> species_count_;
+	//	Maps the tree_id of every stored Tree to the BinaryNode that stores it
+	//	Rotations move BinaryNodes but not the Tree inside them, so only insert
+	//	and remove have to change it
+	TreeIdIndex id_index_;
+
+	//	The keys of the Tree objects as they were when freeze was called, or 
+	//	nothing if the AVL_Tree changed after that
+	FrozenIndex frozen_;
+
+	//	The coordinates and zipcodes of the Tree objects in frozen_, built and 
+	//	thrown away with it, which the nearby and zipcode searches scan
+	CoordinateColumns columns_;
+
+	//	Whether columns_ is built along a Hilbert curve
+	bool hilbert_order_;
+
+	//	The rotations done and the depths of the inserted BinaryNodes
+	RebalanceCounters counters_;
 };
 
 #endif
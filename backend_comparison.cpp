@@ -0,0 +1,206 @@
+/*******************************************************************************
+  Title          : backend_comparison.cpp
+  Description    : The implementation file for the BackendComparison class
+  Purpose        : To run the same commands on a TreeCollection of each 
+                   IndexBackend, check that they all output the same thing 
+                   and time each one
+  Usage          : Use in place of a TreeCollection, then call report()
+  Build with     : g++ -c -std=c++11 backend_comparison.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "backend_comparison.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+//	The word that follows rollup in a command file for each GroupKey
+const char* const kGroupKeyWords[] = {"species", "zip", "borough", "health",
+                                      "diameter"};
+
+BackendComparison::BackendComparison() : mismatches_(0) {
+	for (int b = 0; b < kNumberOfBackends; ++b) {
+		collections_[b].reset(new TreeCollection(static_cast<IndexBackend>(b)));
+	}
+}
+
+BackendComparison::~BackendComparison() {
+}
+
+int BackendComparison::load(std::istream& tree_file) {
+	//	read the file once so that reading it is not timed
+	std::ostringstream contents;
+	contents << tree_file.rdbuf();
+	std::string census = contents.str();
+	int number_of_trees = 0;
+	run("load", [&census, &number_of_trees](TreeCollection& collection) {
+		std::istringstream census_file(census);
+		number_of_trees = collection.load(census_file);
+	});
+	return number_of_trees;
+}
+
+void BackendComparison::set_traversal_pool(WorkStealingPool* pool) {
+	for (int b = 0; b < kNumberOfBackends; ++b) {
+		collections_[b]->set_traversal_pool(pool);
+	}
+}
+
+void BackendComparison::tree_info(const std::string& partial_name) {
+	run("tree_info " + partial_name, [&partial_name](TreeCollection& c) {
+		c.tree_info(partial_name);
+	});
+}
+
+void BackendComparison::list_all_names() {
+	run("listall_names", [](TreeCollection& c) {
+		c.list_all_names();
+	});
+}
+
+void BackendComparison::list_all_in_zip(int& zipcode) {
+	run("listall_inzip " + std::to_string(zipcode), 
+	    [&zipcode](TreeCollection& c) {
+		c.list_all_in_zip(zipcode);
+	});
+}
+
+void BackendComparison::list_all_near(double& latitude, double& longitude,
+                                      double& distance) {
+	std::ostringstream command;
+	command << "list_near " << latitude << " " << longitude << " " << distance;
+	run(command.str(), [&latitude, &longitude, &distance](TreeCollection& c) {
+		c.list_all_near(latitude, longitude, distance);
+	});
+}
+
+void BackendComparison::list_all_near_batch(const std::vector<NearbyQuery>& 
+                                            queries) {
+	run("list_near_batch " + std::to_string(queries.size()),
+	    [&queries](TreeCollection& c) {
+		c.list_all_near_batch(queries);
+	});
+}
+
+void BackendComparison::list_in_corridor(const Corridor& corridor) {
+	std::ostringstream command;
+	command << "corridor " << corridor.distance();
+	for (const CorridorPoint& point : corridor.points()) {
+		command << " " << point.latitude << " " << point.longitude;
+	}
+	run(command.str(), [&corridor](TreeCollection& c) {
+		c.list_in_corridor(corridor);
+	});
+}
+
+void BackendComparison::rollup(GroupKey key) {
+	run(std::string("rollup ") + kGroupKeyWords[key], [key](TreeCollection& c) {
+		c.rollup(key);
+	});
+}
+
+void BackendComparison::lookup(int tree_id) {
+	run("lookup " + std::to_string(tree_id), [tree_id](TreeCollection& c) {
+		c.lookup(tree_id);
+	});
+}
+
+void BackendComparison::remove(int tree_id) {
+	run("remove " + std::to_string(tree_id), [tree_id](TreeCollection& c) {
+		c.remove(tree_id);
+	});
+}
+
+void BackendComparison::print_trees(int first, int last) {
+	run("print " + std::to_string(first) + " " + std::to_string(last),
+	    [first, last](TreeCollection& c) {
+		c.print_trees(first, last);
+	});
+}
+
+void BackendComparison::verify() {
+	run("verify", [](TreeCollection& c) {
+		c.verify();
+	});
+}
+
+bool BackendComparison::reload(const std::string& file_name) {
+	std::cout << "reload " << file_name;
+	std::cout << " is not available when comparing backends";
+	std::cout << std::endl << std::endl;
+	return false;
+}
+
+int BackendComparison::mismatches() const {
+	return mismatches_;
+}
+
+void BackendComparison::report(std::ostream& out) const {
+	out << std::left << std::setw(16) << "command" << std::right 
+	    << std::setw(8) << "runs";
+	for (int b = 0; b < kNumberOfBackends; ++b) {
+		out << std::setw(16) << 
+		    (backend_name(static_cast<IndexBackend>(b)) + std::string(" ms"));
+	}
+	out << std::endl;
+	out << std::fixed << std::setprecision(3);
+	std::map<std::string, CommandTiming>::const_iterator it;
+	for (it = timings_.begin(); it != timings_.end(); ++it) {
+		out << std::left << std::setw(16) << it->first << std::right 
+		    << std::setw(8) << it->second.runs;
+		for (int b = 0; b < kNumberOfBackends; ++b) {
+			out << std::setw(16) << it->second.seconds[b] * 1000;
+		}
+		out << std::endl;
+	}
+	out << mismatches_ << " commands had different outputs" << std::endl;
+	out.copyfmt(std::ios(nullptr));
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+void BackendComparison::run(const std::string& command,
+                            const std::function<void(TreeCollection&)>& 
+                            action) {
+	std::string name = command.substr(0, command.find(' '));
+	//	a new CommandTiming starts with every count set to 0
+	CommandTiming& timing = timings_[name];
+	++timing.runs;
+
+	//	every run starts with the format flags std::cout had before the first
+	std::ios format(nullptr);
+	format.copyfmt(std::cout);
+	std::streambuf* console = std::cout.rdbuf();
+	std::array<std::string, kNumberOfBackends> outputs;
+	for (int b = 0; b < kNumberOfBackends; ++b) {
+		std::ostringstream output;
+		std::cout.copyfmt(format);
+		std::cout.rdbuf(output.rdbuf());
+		std::chrono::steady_clock::time_point start = 
+		    std::chrono::steady_clock::now();
+		action(*collections_[b]);
+		std::chrono::steady_clock::time_point end = 
+		    std::chrono::steady_clock::now();
+		std::cout.rdbuf(console);
+		timing.seconds[b] += 
+		    std::chrono::duration<double>(end - start).count();
+		outputs[b] = output.str();
+	}
+	std::cout << outputs[0];
+	for (int b = 1; b < kNumberOfBackends; ++b) {
+		if (outputs[b] != outputs[0]) {
+			std::cerr << "Outputs differ for " << command << ": " 
+			          << backend_name(static_cast<IndexBackend>(b)) 
+			          << " does not match "
+			          << backend_name(static_cast<IndexBackend>(0)) << std::endl;
+			++mismatches_;
+			break;
+		}
+	}
+}
@@ -0,0 +1,106 @@
+/*******************************************************************************
+  Title          : backend_comparison.h
+  Description    : The interface file for the BackendComparison class
+  Purpose        : To run the same commands on a TreeCollection of each 
+                   IndexBackend, check that they all output the same thing 
+                   and time each one
+  Usage          : Use in place of a TreeCollection, then call report()
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __BACKEND_COMPARISON_H__
+#define __BACKEND_COMPARISON_H__
+
+#include "tree_collection.h"
+#include "tree_index.h"
+#include <array>
+#include <functional>
+#include <istream>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+
+/*******************************************************************************
+
+		The BackendComparison class holds one TreeCollection for each 
+		IndexBackend and answers the same queries as TreeCollection by running 
+		each one on every TreeCollection in turn. While a TreeCollection runs a 
+		command, std::cout writes into a buffer and the command is timed. The 
+		output of the first TreeCollection is then written to std::cout, so the 
+		program outputs what it would with a single TreeCollection, and if the 
+		output of any other TreeCollection is different, the command is written
+		to std::cerr as a mismatch. The format flags of std::cout are reset 
+		before each run so that every TreeCollection starts from the same 
+		state. report() outputs the number of times each command ran and how 
+		long it took on each backend
+
+*******************************************************************************/
+
+class BackendComparison {
+ public:
+	//	Creates a BackendComparison object with an empty TreeCollection for 
+	//	each IndexBackend
+	BackendComparison();
+
+	//	Destroys BackendComparison object
+	~BackendComparison();
+
+	//	Reads tree_file and loads its trees into every TreeCollection, timing
+	//	each one. Returns the number of Trees inserted into the first one
+	int load(std::istream& tree_file);
+
+	//	Calls set_traversal_pool(pool) on every TreeCollection
+	void set_traversal_pool(WorkStealingPool* pool);
+
+	//	These methods run the TreeCollection methods with the same names on 
+	//	every TreeCollection
+	void tree_info(const std::string& partial_name);
+	void list_all_names();
+	void list_all_in_zip(int& zipcode);
+	void list_all_near(double& latitude, double& longitude, double& distance);
+	void list_all_near_batch(const std::vector<NearbyQuery>& queries);
+	void list_in_corridor(const Corridor& corridor);
+	void rollup(GroupKey key);
+	void lookup(int tree_id);
+	void remove(int tree_id);
+	void print_trees(int first, int last);
+	void verify();
+
+	//	Outputs that reloading is not available when comparing backends
+	bool reload(const std::string& file_name);
+
+	//	Returns the number of commands whose outputs were not all the same
+	int mismatches() const;
+
+	//	Outputs, for each command, the number of times it ran and the total and
+	//	average time it took on each backend
+	void report(std::ostream& out) const;
+
+ protected:
+	//	The number of runs of a command and their total time on each backend
+	struct CommandTiming {
+		int runs;
+		std::array<double, kNumberOfBackends> seconds;
+	};
+
+	//	Runs action on every TreeCollection as described above. command is the
+	//	text of the command, and its first word is the name it is timed under
+	void run(const std::string& command,
+	         const std::function<void(TreeCollection&)>& action);
+
+ private:
+	//	The TreeCollection of each IndexBackend, indexed by IndexBackend
+	std::array<std::unique_ptr<TreeCollection>, kNumberOfBackends> collections_;
+
+	//	The timings of each command name, in alphabetical order
+	std::map<std::string, CommandTiming> timings_;
+
+	//	The number of commands whose outputs were not all the same
+	int mismatches_;
+};
+
+#endif
@@ -0,0 +1,311 @@
+/*******************************************************************************
+  Title          : bench.cpp
+  Description    : Times the operations of Tree, AVL_Tree and TreeCollection 
+                   that the commands spend most of their time in, on the trees
+                   of a census file, and outputs the times as JSON
+  Purpose        : To measure whether a change makes the program faster or 
+                   slower
+  Usage          : ./project2_bench [--rows N] [--warmup N] [--repetitions N]
+                   [--baseline old.json] census_file.csv > new.json
+                   The census file's lines are repeated with new tree_ids 
+                   until there are N of them (100000 by default). A table of 
+                   the results, and their change from the medians in 
+                   old.json if it is given, is written to standard error
+  Build with     : make bench
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdlib.h>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "avl.h"
+#include "benchmark.h"
+#include "street_dictionary.h"
+#include "tree.h"
+#include "tree_collection.h"
+
+//	The largest number of Trees that the find benchmarks look up
+const int kFindQueries = 10000;
+
+//	The distance in kilometers used by the nearby benchmarks
+const double kNearbyDistance = 0.5;
+
+//	Results of the benchmarks are added to this so that the compiler cannot 
+//	skip the work that computes them
+volatile long long bench_sink = 0;
+
+//	A stream buffer that throws away everything written to it, which std::cout
+//	writes to while the TreeCollection commands are timed
+class NullBuffer : public std::streambuf {
+ protected:
+	int overflow(int c) {
+		return c;
+	}
+};
+
+//	Returns number_of_rows lines made by repeating the lines of census, with 
+//	the first column, the tree_id, replaced by the number of the line
+std::vector<std::string> make_rows(const std::vector<std::string>& census,
+                                   int number_of_rows) {
+	std::vector<std::string> rows;
+	rows.reserve(number_of_rows);
+	for (int i = 0; i < number_of_rows; ++i) {
+		const std::string& line = census[i % census.size()];
+		rows.push_back(std::to_string(i) + line.substr(line.find(',')));
+	}
+	return rows;
+}
+
+int main(int argc, char* argv[]) {
+	int number_of_rows = 100000;
+	int warmup = 3;
+	int repetitions = 30;
+	std::string baseline_file;
+	std::string census_file;
+	for (int i = 1; i < argc; ++i) {
+		std::string option = argv[i];
+		if ("--rows" == option && i + 1 < argc) {
+			number_of_rows = atoi(argv[++i]);
+		} else if ("--warmup" == option && i + 1 < argc) {
+			warmup = atoi(argv[++i]);
+		} else if ("--repetitions" == option && i + 1 < argc) {
+			repetitions = atoi(argv[++i]);
+		} else if ("--baseline" == option && i + 1 < argc) {
+			baseline_file = argv[++i];
+		} else {
+			census_file = option;
+		}
+	}
+	if (census_file.empty() || number_of_rows < 1) {
+		std::cerr << "Usage: " << argv[0] << " [--rows N] [--warmup N] "
+		          << "[--repetitions N] [--baseline old.json] census_file.csv"
+		          << std::endl;
+		exit(1);
+	}
+
+	std::ifstream census_stream(census_file);
+	std::vector<std::string> census;
+	std::string line;
+	while (std::getline(census_stream, line)) {
+		if (line.find(',') != std::string::npos) {
+			census.push_back(line);
+		}
+	}
+	if (census.empty()) {
+		std::cerr << "Unable to read trees from census file: " << census_file
+		          << std::endl;
+		exit(1);
+	}
+	std::vector<std::string> rows = make_rows(census, number_of_rows);
+	StreetDictionary streets;
+	std::vector<Tree> trees;
+	std::set<std::string> species;
+	std::vector<int> zipcodes;
+	for (const std::string& row : rows) {
+		trees.push_back(Tree(row, streets));
+		species.insert(trees.back().common_name());
+		if (zipcodes.size() < 5 && 
+		    std::find(zipcodes.begin(), zipcodes.end(), trees.back().zip()) ==
+		    zipcodes.end()) {
+			zipcodes.push_back(trees.back().zip());
+		}
+	}
+	//	spread the looked up Trees and the nearby points over the whole file
+	std::vector<Tree> queries;
+	int stride = std::max(1, number_of_rows / kFindQueries);
+	for (int i = 0; i < number_of_rows && 
+	     static_cast<int>(queries.size()) < kFindQueries; i += stride) {
+		queries.push_back(trees[i]);
+	}
+	std::vector<std::pair<double, double> > points;
+	for (int i = 0; i < 5; ++i) {
+		double latitude, longitude;
+		trees[(i * 7919) % trees.size()].get_position(latitude, longitude);
+		points.push_back(std::make_pair(latitude, longitude));
+	}
+	std::vector<std::string> species_queries;
+	for (const std::string& name : species) {
+		//	the commands give names in any case
+		std::string upper = name;
+		std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+		species_queries.push_back(upper);
+	}
+
+	BenchmarkRunner runner(warmup, repetitions);
+
+	runner.run("tree_parse", rows.size(), [&rows, &streets]() {
+		long long sum = 0;
+		for (const std::string& row : rows) {
+			sum += Tree(row, streets).id();
+		}
+		bench_sink += sum;
+	});
+
+	runner.run("tree_nearest_address", trees.size(), [&trees]() {
+		long long sum = 0;
+		for (const Tree& tree : trees) {
+			sum += tree.nearest_address().size();
+		}
+		bench_sink += sum;
+	});
+
+	std::unique_ptr<AVL_Tree> built;
+	runner.run("avl_insert", trees.size(), [&trees, &built]() {
+		for (const Tree& tree : trees) {
+			built->insert(tree);
+		}
+	}, [&built]() {
+		built.reset(new AVL_Tree());
+	});
+
+	AVL_Tree avl;
+	for (const Tree& tree : trees) {
+		avl.insert(tree);
+	}
+	AVL_Tree frozen(avl);
+	frozen.freeze();
+	AVL_Tree hilbert(avl);
+	hilbert.set_hilbert_order(true);
+	hilbert.freeze();
+
+	runner.run("avl_find", queries.size(), [&avl, &queries]() {
+		long long sum = 0;
+		for (const Tree& query : queries) {
+			sum += avl.find(query).id();
+		}
+		bench_sink += sum;
+	});
+	runner.run("avl_find_frozen", queries.size(), [&frozen, &queries]() {
+		long long sum = 0;
+		for (const Tree& query : queries) {
+			sum += frozen.find(query).id();
+		}
+		bench_sink += sum;
+	});
+	runner.run("avl_findallmatches", species.size(), [&avl, &species]() {
+		long long sum = 0;
+		for (const std::string& name : species) {
+			Tree z(0, 0, "", "", name, 0, "", "", 0, 0);
+			sum += avl.findallmatches(z).size();
+		}
+		bench_sink += sum;
+	});
+	runner.run("avl_count_species", species_queries.size(), 
+	           [&avl, &species_queries]() {
+		long long sum = 0;
+		for (const std::string& name : species_queries) {
+			sum += avl.count_species(name);
+		}
+		bench_sink += sum;
+	});
+	runner.run("avl_count_species_frozen", species_queries.size(), 
+	           [&frozen, &species_queries]() {
+		long long sum = 0;
+		for (const std::string& name : species_queries) {
+			sum += frozen.count_species(name);
+		}
+		bench_sink += sum;
+	});
+	runner.run("avl_all_in_zipcode", zipcodes.size(), [&avl, &zipcodes]() {
+		long long sum = 0;
+		for (int zip : zipcodes) {
+			sum += avl.all_in_zipcode(zip).size();
+		}
+		bench_sink += sum;
+	});
+	runner.run("avl_all_in_zipcode_frozen", zipcodes.size(), 
+	           [&frozen, &zipcodes]() {
+		long long sum = 0;
+		for (int zip : zipcodes) {
+			sum += frozen.all_in_zipcode(zip).size();
+		}
+		bench_sink += sum;
+	});
+	runner.run("avl_all_in_zipcode_hilbert", zipcodes.size(), 
+	           [&hilbert, &zipcodes]() {
+		long long sum = 0;
+		for (int zip : zipcodes) {
+			sum += hilbert.all_in_zipcode(zip).size();
+		}
+		bench_sink += sum;
+	});
+	runner.run("avl_all_nearby", points.size(), [&avl, &points]() {
+		long long sum = 0;
+		for (const std::pair<double, double>& point : points) {
+			sum += avl.all_nearby(point.first, point.second, kNearbyDistance)
+			       .size();
+		}
+		bench_sink += sum;
+	});
+	runner.run("avl_all_nearby_frozen", points.size(), [&frozen, &points]() {
+		long long sum = 0;
+		for (const std::pair<double, double>& point : points) {
+			sum += frozen.all_nearby(point.first, point.second, kNearbyDistance)
+			       .size();
+		}
+		bench_sink += sum;
+	});
+	runner.run("avl_all_nearby_hilbert", points.size(), [&hilbert, &points]() {
+		long long sum = 0;
+		for (const std::pair<double, double>& point : points) {
+			sum += hilbert.all_nearby(point.first, point.second, kNearbyDistance)
+			       .size();
+		}
+		bench_sink += sum;
+	});
+
+	//	the TreeCollection commands write to std::cout, which is thrown away
+	std::ostringstream census_text;
+	for (const std::string& row : rows) {
+		census_text << row << '\n';
+	}
+	std::istringstream census_input(census_text.str());
+	TreeCollection collection;
+	collection.load(census_input);
+	const char* const tree_info_names[] = {"oak", "maple", "london", "pear",
+	                                        "honeylocust"};
+	NullBuffer null_buffer;
+	std::streambuf* console = std::cout.rdbuf(&null_buffer);
+	runner.run("tree_info", 5, [&collection, &tree_info_names]() {
+		for (const char* name : tree_info_names) {
+			collection.tree_info(name);
+		}
+	});
+	runner.run("list_all_near", points.size(), [&collection, &points]() {
+		for (const std::pair<double, double>& point : points) {
+			double latitude = point.first, longitude = point.second;
+			double distance = kNearbyDistance;
+			collection.list_all_near(latitude, longitude, distance);
+		}
+	});
+	std::cout.rdbuf(console);
+	std::cout.copyfmt(std::ios(nullptr));
+
+	std::map<std::string, std::string> context;
+	context["census"] = census_file;
+	context["rows"] = std::to_string(number_of_rows);
+	context["warmup"] = std::to_string(warmup);
+	runner.write_json(std::cout, context);
+	runner.write_table(std::cerr);
+	if (!baseline_file.empty()) {
+		std::ifstream baseline(baseline_file);
+		if (baseline.fail()) {
+			std::cerr << "Unable to open baseline file: " << baseline_file 
+			          << std::endl;
+			exit(1);
+		}
+		std::cerr << std::endl;
+		runner.compare(std::cerr, BenchmarkRunner::read_medians(baseline));
+	}
+	return 0;
+}
@@ -0,0 +1,192 @@
+/*******************************************************************************
+  Title          : benchmark.cpp
+  Description    : The implementation file for the BenchmarkRunner class
+  Purpose        : To time small pieces of code many times and summarize the 
+                   times in a form that can be compared between runs
+  Usage          : Call run() for every piece of code to time, then 
+                   write_json() or write_table()
+  Build with     : g++ -c -std=c++11 benchmark.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "benchmark.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <ios>
+#include <numeric>
+#include <sstream>
+
+BenchmarkRunner::BenchmarkRunner(int warmup, int repetitions)
+    : warmup_(warmup), repetitions_(std::max(repetitions, 1)) {
+}
+
+BenchmarkRunner::~BenchmarkRunner() {
+}
+
+void BenchmarkRunner::run(const std::string& name, int operations,
+                          const std::function<void()>& body,
+                          const std::function<void()>& setup) {
+	BenchmarkResult result;
+	result.name = name;
+	result.operations = std::max(operations, 1);
+	for (int i = 0; i < warmup_ + repetitions_; ++i) {
+		if (setup) {
+			setup();
+		}
+		std::chrono::steady_clock::time_point start = 
+		    std::chrono::steady_clock::now();
+		body();
+		std::chrono::steady_clock::time_point end = 
+		    std::chrono::steady_clock::now();
+		if (warmup_ <= i) {
+			double total = std::chrono::duration<double, std::nano>(end - start)
+			               .count();
+			result.nanoseconds.push_back(total / result.operations);
+		}
+	}
+	std::vector<double> sorted(result.nanoseconds);
+	std::sort(sorted.begin(), sorted.end());
+	result.median = percentile(sorted, 0.5);
+	result.p99 = percentile(sorted, 0.99);
+	result.mean = std::accumulate(sorted.begin(), sorted.end(), 0.0) / 
+	              sorted.size();
+	result.minimum = sorted.front();
+	results_.push_back(result);
+}
+
+const std::vector<BenchmarkResult>& BenchmarkRunner::results() const {
+	return results_;
+}
+
+void BenchmarkRunner::write_json(std::ostream& out,
+                                 const std::map<std::string, std::string>& 
+                                 context) const {
+	out << "{" << std::endl << "  \"context\": {";
+	std::map<std::string, std::string>::const_iterator it;
+	for (it = context.begin(); it != context.end(); ++it) {
+		if (it != context.begin()) {
+			out << ", ";
+		}
+		write_string(out, it->first);
+		out << ": ";
+		write_string(out, it->second);
+	}
+	out << "}," << std::endl << "  \"benchmarks\": [" << std::endl;
+	out << std::fixed << std::setprecision(2);
+	for (unsigned int i = 0; i < results_.size(); ++i) {
+		const BenchmarkResult& result = results_[i];
+		//	every benchmark is on its own line so that read_medians and diff can
+		//	work one line at a time
+		out << "    {\"name\": ";
+		write_string(out, result.name);
+		out << ", \"operations\": " << result.operations 
+		    << ", \"repetitions\": " << result.nanoseconds.size()
+		    << ", \"median_ns\": " << result.median
+		    << ", \"p99_ns\": " << result.p99 
+		    << ", \"mean_ns\": " << result.mean
+		    << ", \"min_ns\": " << result.minimum << "}";
+		if (i + 1 < results_.size()) {
+			out << ",";
+		}
+		out << std::endl;
+	}
+	out << "  ]" << std::endl << "}" << std::endl;
+	out.copyfmt(std::ios(nullptr));
+}
+
+void BenchmarkRunner::write_table(std::ostream& out) const {
+	out << std::left << std::setw(28) << "benchmark" << std::right 
+	    << std::setw(10) << "ops" << std::setw(14) << "median ns/op" 
+	    << std::setw(14) << "p99 ns/op" << std::setw(14) << "min ns/op" 
+	    << std::endl;
+	out << std::fixed << std::setprecision(1);
+	for (unsigned int i = 0; i < results_.size(); ++i) {
+		const BenchmarkResult& result = results_[i];
+		out << std::left << std::setw(28) << result.name << std::right 
+		    << std::setw(10) << result.operations << std::setw(14) 
+		    << result.median << std::setw(14) << result.p99 << std::setw(14) 
+		    << result.minimum << std::endl;
+	}
+	out.copyfmt(std::ios(nullptr));
+}
+
+void BenchmarkRunner::compare(std::ostream& out,
+                              const std::map<std::string, double>& baseline)
+                              const {
+	out << std::left << std::setw(28) << "benchmark" << std::right 
+	    << std::setw(14) << "baseline ns" << std::setw(14) << "median ns" 
+	    << std::setw(10) << "change" << std::endl;
+	out << std::fixed << std::setprecision(1);
+	for (unsigned int i = 0; i < results_.size(); ++i) {
+		const BenchmarkResult& result = results_[i];
+		out << std::left << std::setw(28) << result.name << std::right;
+		std::map<std::string, double>::const_iterator it = 
+		    baseline.find(result.name);
+		if (it == baseline.end() || it->second <= 0) {
+			out << std::setw(14) << "-" << std::setw(14) << result.median 
+			    << std::setw(10) << "new" << std::endl;
+			continue;
+		}
+		double change = 100 * (result.median - it->second) / it->second;
+		out << std::setw(14) << it->second << std::setw(14) << result.median 
+		    << std::setw(9) << std::showpos << change << std::noshowpos << "%" 
+		    << std::endl;
+	}
+	out.copyfmt(std::ios(nullptr));
+}
+
+std::map<std::string, double> BenchmarkRunner::read_medians(std::istream& in) {
+	std::map<std::string, double> medians;
+	std::string line;
+	const std::string name_field = "\"name\": \"";
+	const std::string median_field = "\"median_ns\": ";
+	while (std::getline(in, line)) {
+		std::string::size_type name_start = line.find(name_field);
+		std::string::size_type median_start = line.find(median_field);
+		if (name_start == std::string::npos || 
+		    median_start == std::string::npos) {
+			continue;
+		}
+		name_start += name_field.size();
+		std::string name = line.substr(name_start, 
+		                               line.find('"', name_start) - name_start);
+		std::istringstream median(line.substr(median_start + 
+		                                      median_field.size()));
+		double value = 0;
+		if (median >> value) {
+			medians[name] = value;
+		}
+	}
+	return medians;
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+double BenchmarkRunner::percentile(const std::vector<double>& sorted, double p)
+{
+	int rank = static_cast<int>(std::ceil(p * sorted.size())) - 1;
+	rank = std::min(std::max(rank, 0), static_cast<int>(sorted.size()) - 1);
+	return sorted[rank];
+}
+
+void BenchmarkRunner::write_string(std::ostream& out, const std::string& value)
+{
+	out << '"';
+	for (char c : value) {
+		if ('"' == c || '\\' == c) {
+			out << '\\' << c;
+		} else if (static_cast<unsigned char>(c) < 0x20) {
+			out << ' ';
+		} else {
+			out << c;
+		}
+	}
+	out << '"';
+}
@@ -0,0 +1,103 @@
+/*******************************************************************************
+  Title          : benchmark.h
+  Description    : The interface file for the BenchmarkRunner class
+  Purpose        : To time small pieces of code many times and summarize the 
+                   times in a form that can be compared between runs
+  Usage          : Call run() for every piece of code to time, then 
+                   write_json() or write_table()
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+#include <functional>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//	The times of one benchmark, in nanoseconds per operation
+struct BenchmarkResult {
+	std::string name;
+	int operations;
+	std::vector<double> nanoseconds;
+	double median;
+	double p99;
+	double mean;
+	double minimum;
+};
+
+/*******************************************************************************
+
+		The BenchmarkRunner class times a benchmark, which is a function that 
+		does some number of operations, by calling it a few times without timing
+		it so that caches and the branch predictor warm up, and then timing each
+		of a number of repetitions. Each repetition's time is divided by the 
+		number of operations, and the median, 99th percentile, mean and minimum 
+		of those times are kept. An optional setup function runs before every 
+		call and is not timed, so a benchmark that changes its data can start 
+		from the same state each time. The results are written as JSON, one 
+		benchmark per line, and read_medians() reads such a file back so a run 
+		can be compared with a stored baseline
+
+*******************************************************************************/
+
+class BenchmarkRunner {
+ public:
+	//	Creates a BenchmarkRunner object that calls each benchmark warmup times
+	//	without timing it and then times it repetitions times
+	BenchmarkRunner(int warmup, int repetitions);
+
+	//	Destroys BenchmarkRunner object
+	~BenchmarkRunner();
+
+	//	Times body, which does operations operations, calling setup before 
+	//	each call to body if setup is not empty, and keeps its result under name
+	void run(const std::string& name, int operations,
+	         const std::function<void()>& body,
+	         const std::function<void()>& setup = std::function<void()>());
+
+	//	Returns the results of every benchmark run so far, in the order they ran
+	const std::vector<BenchmarkResult>& results() const;
+
+	//	Outputs the results as a JSON object. context holds extra strings, like
+	//	the census file used, that are output with them
+	void write_json(std::ostream& out, 
+	                const std::map<std::string, std::string>& context) const;
+
+	//	Outputs the results as a table that is easy to read
+	void write_table(std::ostream& out) const;
+
+	//	Outputs the change of each benchmark's median from its median in 
+	//	baseline, which maps benchmark names to medians
+	void compare(std::ostream& out,
+	             const std::map<std::string, double>& baseline) const;
+
+	//	Returns the median of every benchmark in in, which holds JSON written by
+	//	write_json
+	static std::map<std::string, double> read_medians(std::istream& in);
+
+ protected:
+	//	Returns the value at fraction p of sorted, using the nearest rank
+	static double percentile(const std::vector<double>& sorted, double p);
+
+	//	Outputs value as a JSON string
+	static void write_string(std::ostream& out, const std::string& value);
+
+ private:
+	//	The number of untimed calls to each benchmark
+	int warmup_;
+
+	//	The number of timed calls to each benchmark
+	int repetitions_;
+
+	//	The results of every benchmark run so far
+	std::vector<BenchmarkResult> results_;
+};
+
+#endif
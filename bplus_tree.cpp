@@ -0,0 +1,664 @@
+/*******************************************************************************
+  Title          : bplus_tree.cpp
+  Description    : The implementation file for the BPlusTree class
+  Purpose        : To store the trees of the 2015 NYC Street Tree Census in 
+                   wide nodes that take fewer cache misses to search than the 
+                   nodes of AVL_Tree
+  Usage          : Use in the same way as AVL_Tree
+  Build with     : g++ -c -std=c++11 bplus_tree.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "bplus_tree.h"
+#include "haversine.h"
+#include "work_counters.h"
+#include <algorithm>
+#include <cctype>
+#include <utility>
+#include <vector>
+
+BPlusTree::BPlusTree() : root_(nullptr), first_leaf_(nullptr),
+    last_leaf_(nullptr), size_(0), height_(-1) {
+}
+
+BPlusTree::BPlusTree(const BPlusTree& tree) : root_(nullptr),
+    first_leaf_(nullptr), last_leaf_(nullptr), size_(0), height_(-1) {
+	for (const BPlusLeaf* leaf = tree.first_leaf_; leaf != nullptr; 
+	     leaf = leaf->next) {
+		for (int i = 0; i < leaf->count; ++i) {
+			insert(leaf->record(i));
+		}
+	}
+}
+
+BPlusTree::~BPlusTree() {
+	clear();
+}
+
+bool BPlusTree::empty() const {
+	return 0 == size_;
+}
+
+int BPlusTree::get_number_of_trees() const {
+	return size_;
+}
+
+int BPlusTree::height() const {
+	return height_;
+}
+
+const Tree& BPlusTree::find(const Tree& x) const {
+	std::string species = x.common_name();
+	BPlusKey key = {&species, x.id()};
+	const Tree* stored = locate(key);
+	if (stored == nullptr) {
+		return kNotFound.data;
+	}
+	return *stored;
+}
+
+const Tree& BPlusTree::find_by_id(int tree_id) const {
+	std::unordered_map<int, const std::string*>::const_iterator it = 
+	    ids_.find(tree_id);
+	if (it == ids_.end()) {
+		return kNotFound.data;
+	}
+	BPlusKey key = {it->second, tree_id};
+	const Tree* stored = locate(key);
+	if (stored == nullptr) {
+		return kNotFound.data;
+	}
+	return *stored;
+}
+
+const Tree& BPlusTree::findMin() const {
+	if (first_leaf_ == nullptr) {
+		return kNotFound.data;
+	}
+	return first_leaf_->record(0);
+}
+
+const Tree& BPlusTree::findMax() const {
+	if (last_leaf_ == nullptr) {
+		return kNotFound.data;
+	}
+	return last_leaf_->record(last_leaf_->count - 1);
+}
+
+int BPlusTree::rank(const Tree& x) const {
+	std::string species = x.common_name();
+	BPlusKey key = {&species, x.id()};
+	int count = 0;
+	const BPlusNode* node = root_;
+	while (node != nullptr && !node->is_leaf) {
+		const BPlusInternal* internal = static_cast<const BPlusInternal*>(node);
+		int i = child_index(internal, key);
+		for (int c = 0; c < i; ++c) {
+			count += internal->sizes[c];
+		}
+		node = internal->children[i];
+	}
+	if (node != nullptr) {
+		count += lower_bound(static_cast<const BPlusLeaf*>(node), key);
+	}
+	return count;
+}
+
+const Tree& BPlusTree::select(int i) const {
+	if (i < 0 || size_ <= i) {
+		return kNotFound.data;
+	}
+	const BPlusLeaf* leaf = nullptr;
+	int index = 0;
+	locate_rank(i, leaf, index);
+	return leaf->record(index);
+}
+
+std::list<Tree> BPlusTree::findallmatches(const Tree& x) const {
+	std::list<Tree> match_list;
+	std::string spc = stored_name(x.common_name());
+	int matches = count_name(spc);
+	if (0 == matches) {
+		return match_list;
+	}
+	//	the matching Trees are next to each other in the leaves
+	const BPlusLeaf* leaf = nullptr;
+	int index = 0;
+	locate_rank(name_rank(spc, false), leaf, index);
+	while (0 < matches) {
+		if (leaf->count <= index) {
+			leaf = leaf->next;
+			index = 0;
+			continue;
+		}
+		match_list.push_back(leaf->record(index));
+		++index;
+		--matches;
+	}
+	return match_list;
+}
+
+int BPlusTree::count_species(const std::string& name_of_species) const {
+	return count_name(stored_name(name_of_species));
+}
+
+std::list<std::string> BPlusTree::all_in_zipcode(const int& zip) const {
+	std::list<std::string> match_list;
+	//	check if zip is a possible zipcode
+	if (99999 < zip) {
+		return match_list;
+	}
+	WorkCounters::add_trees_visited(size_);
+	for (const BPlusLeaf* leaf = first_leaf_; leaf != nullptr; 
+	     leaf = leaf->next) {
+		for (int i = 0; i < leaf->count; ++i) {
+			if (zip == leaf->record(i).zip()) {
+				match_list.push_back(leaf->record(i).common_name());
+			}
+		}
+	}
+	return match_list;
+}
+
+std::list<std::string> BPlusTree::all_nearby(const double& latitude,
+                                             const double& longitude,
+                                             const double& distance) const {
+	std::list<std::string> match_list;
+	WorkCounters::add_trees_visited(size_);
+	WorkCounters::add_haversines(size_);
+	double tree_lat, tree_lon;
+	for (const BPlusLeaf* leaf = first_leaf_; leaf != nullptr; 
+	     leaf = leaf->next) {
+		for (int i = 0; i < leaf->count; ++i) {
+			leaf->record(i).get_position(tree_lat, tree_lon);
+			if (distance >= haversine(latitude, longitude, tree_lat, tree_lon)) {
+				match_list.push_back(leaf->record(i).common_name());
+			}
+		}
+	}
+	return match_list;
+}
+
+//	the grouping methods do not depend on the order, so they go through the 
+//	records of each leaf in slot order, which is the order they are in memory
+void BPlusTree::group_all(GroupBy& groups) const {
+	WorkCounters::add_trees_visited(size_);
+	for (const BPlusLeaf* leaf = first_leaf_; leaf != nullptr; 
+	     leaf = leaf->next) {
+		for (int s = 0; s < leaf->count; ++s) {
+			groups.add(leaf->records[s]);
+		}
+	}
+}
+
+void BPlusTree::group_in_zipcode(const int& zip, GroupBy& groups) const {
+	//	check if zip is a possible zipcode
+	if (99999 < zip) {
+		return;
+	}
+	WorkCounters::add_trees_visited(size_);
+	for (const BPlusLeaf* leaf = first_leaf_; leaf != nullptr; 
+	     leaf = leaf->next) {
+		for (int s = 0; s < leaf->count; ++s) {
+			if (zip == leaf->records[s].zip()) {
+				groups.add(leaf->records[s]);
+			}
+		}
+	}
+}
+
+void BPlusTree::group_nearby(const double& latitude, const double& longitude,
+                             const double& distance, GroupBy& groups) const {
+	WorkCounters::add_trees_visited(size_);
+	WorkCounters::add_haversines(size_);
+	double tree_lat, tree_lon;
+	for (const BPlusLeaf* leaf = first_leaf_; leaf != nullptr; 
+	     leaf = leaf->next) {
+		for (int s = 0; s < leaf->count; ++s) {
+			leaf->records[s].get_position(tree_lat, tree_lon);
+			if (distance >= haversine(latitude, longitude, tree_lat, tree_lon)) {
+				groups.add(leaf->records[s]);
+			}
+		}
+	}
+}
+
+long long BPlusTree::for_each_in_box(const std::vector<CoordinateBox>& boxes,
+                                      const TreeVisitor& visit) const {
+	for (const BPlusLeaf* leaf = first_leaf_; leaf != nullptr; 
+	     leaf = leaf->next) {
+		for (int s = 0; s < leaf->count; ++s) {
+			visit(leaf->records[s]);
+		}
+	}
+	return size_;
+}
+
+void BPlusTree::print(std::ostream& out) const {
+	for (const BPlusLeaf* leaf = first_leaf_; leaf != nullptr; 
+	     leaf = leaf->next) {
+		for (int i = 0; i < leaf->count; ++i) {
+			out << leaf->record(i);
+		}
+	}
+}
+
+void BPlusTree::print(std::ostream& out, int first, int last) const {
+	first = std::max(first, 0);
+	last = std::min(last, size_);
+	if (last <= first) {
+		return;
+	}
+	const BPlusLeaf* leaf = nullptr;
+	int index = 0;
+	locate_rank(first, leaf, index);
+	for (int i = first; i < last; ++i) {
+		if (leaf->count <= index) {
+			leaf = leaf->next;
+			index = 0;
+		}
+		out << leaf->record(index);
+		++index;
+	}
+}
+
+void BPlusTree::clear() {
+	clear(root_);
+	root_ = nullptr;
+	first_leaf_ = last_leaf_ = nullptr;
+	size_ = 0;
+	height_ = -1;
+	ids_.clear();
+}
+
+bool BPlusTree::insert(const Tree& x) {
+	std::string species = x.common_name();
+	BPlusKey probe = {&species, x.id()};
+	if (locate(probe) != nullptr) {
+		return false;
+	}
+	BPlusKey key = {&*species_.insert(species).first, x.id()};
+	if (root_ == nullptr) {
+		BPlusLeaf* leaf = new BPlusLeaf;
+		root_ = first_leaf_ = last_leaf_ = leaf;
+		height_ = 0;
+	}
+	BPlusKey separator;
+	BPlusNode* sibling = insert(root_, key, x, separator);
+	if (sibling != nullptr) {
+		//	the root was split, so the BPlusTree grows a level
+		BPlusInternal* new_root = new BPlusInternal;
+		new_root->count = 2;
+		new_root->children[0] = root_;
+		new_root->children[1] = sibling;
+		new_root->keys[0] = separator;
+		new_root->sizes[0] = subtree_size(root_);
+		new_root->sizes[1] = subtree_size(sibling);
+		root_ = new_root;
+		++height_;
+	}
+	++size_;
+	ids_[x.id()] = key.species;
+	return true;
+}
+
+bool BPlusTree::remove(const Tree& x) {
+	std::string species = x.common_name();
+	BPlusKey key = {&species, x.id()};
+	if (locate(key) == nullptr) {
+		return false;
+	}
+	remove(root_, key);
+	--size_;
+	//	the root keeps at least one child, so shrink the BPlusTree while the 
+	//	root has only one
+	while (!root_->is_leaf && 1 == root_->count) {
+		BPlusInternal* old_root = static_cast<BPlusInternal*>(root_);
+		root_ = old_root->children[0];
+		delete old_root;
+		--height_;
+	}
+	if (root_->is_leaf && 0 == root_->count) {
+		delete static_cast<BPlusLeaf*>(root_);
+		root_ = nullptr;
+		first_leaf_ = last_leaf_ = nullptr;
+		height_ = -1;
+	}
+	std::unordered_map<int, const std::string*>::iterator it = 
+	    ids_.find(x.id());
+	if (it != ids_.end() && *it->second == species) {
+		ids_.erase(it);
+	}
+	return true;
+}
+
+void BPlusTree::change_case(std::string& species) const {
+	char c = species[0];
+	if (islower(c)) {
+		species[0] = toupper(c);
+	} else if (ispunct(c)) {
+		c = species[1];
+		species[1] = toupper(c);
+	}
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+bool BPlusTree::less(const BPlusKey& a, const BPlusKey& b) {
+	//	keys of the same stored species point to the same string
+	if (a.species != b.species) {
+		int order = a.species->compare(*b.species);
+		if (0 != order) {
+			return order < 0;
+		}
+	}
+	return a.tree_id < b.tree_id;
+}
+
+int BPlusTree::child_index(const BPlusInternal* node, const BPlusKey& key) {
+	int i = 0;
+	while (i < node->count - 1 && !less(key, node->keys[i])) {
+		++i;
+	}
+	return i;
+}
+
+int BPlusTree::lower_bound(const BPlusLeaf* leaf, const BPlusKey& key) {
+	int low = 0, high = leaf->count;
+	while (low < high) {
+		int middle = (low + high) / 2;
+		if (less(leaf->keys[middle], key)) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+	return low;
+}
+
+int BPlusTree::subtree_size(const BPlusNode* node) {
+	if (node->is_leaf) {
+		return node->count;
+	}
+	const BPlusInternal* internal = static_cast<const BPlusInternal*>(node);
+	int size = 0;
+	for (int c = 0; c < internal->count; ++c) {
+		size += internal->sizes[c];
+	}
+	return size;
+}
+
+const Tree* BPlusTree::locate(const BPlusKey& key) const {
+	const BPlusNode* node = root_;
+	if (node == nullptr) {
+		return nullptr;
+	}
+	while (!node->is_leaf) {
+		const BPlusInternal* internal = static_cast<const BPlusInternal*>(node);
+		node = internal->children[child_index(internal, key)];
+	}
+	const BPlusLeaf* leaf = static_cast<const BPlusLeaf*>(node);
+	int i = lower_bound(leaf, key);
+	if (i < leaf->count && !less(key, leaf->keys[i])) {
+		return &leaf->record(i);
+	}
+	return nullptr;
+}
+
+void BPlusTree::locate_rank(int i, const BPlusLeaf*& leaf, int& index) const {
+	const BPlusNode* node = root_;
+	while (!node->is_leaf) {
+		const BPlusInternal* internal = static_cast<const BPlusInternal*>(node);
+		int c = 0;
+		while (internal->sizes[c] <= i) {
+			i -= internal->sizes[c];
+			++c;
+		}
+		node = internal->children[c];
+	}
+	leaf = static_cast<const BPlusLeaf*>(node);
+	index = i;
+}
+
+BPlusNode* BPlusTree::insert(BPlusNode* node, const BPlusKey& key,
+                             const Tree& x, BPlusKey& separator) {
+	if (node->is_leaf) {
+		BPlusLeaf* leaf = static_cast<BPlusLeaf*>(node);
+		int position = lower_bound(leaf, key);
+		if (leaf->count < kBPlusLeafSize) {
+			//	the new record goes in the first free slot and only the keys and
+			//	slot numbers after it move
+			for (int i = leaf->count; i > position; --i) {
+				leaf->keys[i] = leaf->keys[i - 1];
+				leaf->slots[i] = leaf->slots[i - 1];
+			}
+			leaf->keys[position] = key;
+			leaf->slots[position] = leaf->count;
+			leaf->records[leaf->count] = x;
+			++leaf->count;
+			return nullptr;
+		}
+		//	split the full leaf: the lower half of the keys and the new one stay
+		//	and the upper half moves to a new leaf after it
+		std::vector<std::pair<BPlusKey, const Tree*> > all;
+		for (int i = 0; i < leaf->count; ++i) {
+			all.push_back(std::make_pair(leaf->keys[i], &leaf->record(i)));
+		}
+		all.insert(all.begin() + position, std::make_pair(key, &x));
+		std::vector<Tree> kept;
+		int half = all.size() / 2;
+		for (int i = 0; i < half; ++i) {
+			kept.push_back(*all[i].second);
+		}
+		BPlusLeaf* right = new BPlusLeaf;
+		for (unsigned int i = half; i < all.size(); ++i) {
+			right->keys[right->count] = all[i].first;
+			right->slots[right->count] = right->count;
+			right->records[right->count] = *all[i].second;
+			++right->count;
+		}
+		for (int i = 0; i < half; ++i) {
+			leaf->keys[i] = all[i].first;
+			leaf->slots[i] = i;
+			leaf->records[i] = kept[i];
+		}
+		leaf->count = half;
+		right->next = leaf->next;
+		right->previous = leaf;
+		if (leaf->next != nullptr) {
+			leaf->next->previous = right;
+		} else {
+			last_leaf_ = right;
+		}
+		leaf->next = right;
+		separator = right->keys[0];
+		return right;
+	}
+
+	BPlusInternal* internal = static_cast<BPlusInternal*>(node);
+	int c = child_index(internal, key);
+	BPlusKey child_separator;
+	BPlusNode* new_child = insert(internal->children[c], key, x, 
+	                              child_separator);
+	if (new_child == nullptr) {
+		++internal->sizes[c];
+		return nullptr;
+	}
+	if (internal->count < kBPlusFanout) {
+		for (int i = internal->count; i > c + 1; --i) {
+			internal->children[i] = internal->children[i - 1];
+			internal->sizes[i] = internal->sizes[i - 1];
+			internal->keys[i - 1] = internal->keys[i - 2];
+		}
+		internal->children[c + 1] = new_child;
+		internal->keys[c] = child_separator;
+		internal->sizes[c] = subtree_size(internal->children[c]);
+		internal->sizes[c + 1] = subtree_size(new_child);
+		++internal->count;
+		return nullptr;
+	}
+	//	split the full internal node around the middle key, which moves up
+	std::vector<BPlusNode*> children(internal->children,
+	                                 internal->children + internal->count);
+	std::vector<BPlusKey> keys(internal->keys, 
+	                           internal->keys + internal->count - 1);
+	children.insert(children.begin() + c + 1, new_child);
+	keys.insert(keys.begin() + c, child_separator);
+	int half = children.size() / 2;
+	BPlusInternal* right = new BPlusInternal;
+	internal->count = half;
+	right->count = children.size() - half;
+	for (int i = 0; i < internal->count; ++i) {
+		internal->children[i] = children[i];
+		internal->sizes[i] = subtree_size(children[i]);
+		if (i + 1 < internal->count) {
+			internal->keys[i] = keys[i];
+		}
+	}
+	for (int i = 0; i < right->count; ++i) {
+		right->children[i] = children[half + i];
+		right->sizes[i] = subtree_size(children[half + i]);
+		if (i + 1 < right->count) {
+			right->keys[i] = keys[half + i];
+		}
+	}
+	separator = keys[half - 1];
+	return right;
+}
+
+void BPlusTree::remove(BPlusNode* node, const BPlusKey& key) {
+	if (node->is_leaf) {
+		BPlusLeaf* leaf = static_cast<BPlusLeaf*>(node);
+		remove_from_leaf(leaf, lower_bound(leaf, key));
+		return;
+	}
+	BPlusInternal* internal = static_cast<BPlusInternal*>(node);
+	int c = child_index(internal, key);
+	BPlusNode* child = internal->children[c];
+	remove(child, key);
+	--internal->sizes[c];
+	if (0 < child->count) {
+		return;
+	}
+	//	the child is empty, so take it and one of the keys next to it out. The
+	//	keys that are left still separate the children that are left
+	if (child->is_leaf) {
+		BPlusLeaf* leaf = static_cast<BPlusLeaf*>(child);
+		if (leaf->previous != nullptr) {
+			leaf->previous->next = leaf->next;
+		} else {
+			first_leaf_ = leaf->next;
+		}
+		if (leaf->next != nullptr) {
+			leaf->next->previous = leaf->previous;
+		} else {
+			last_leaf_ = leaf->previous;
+		}
+		delete leaf;
+	} else {
+		delete static_cast<BPlusInternal*>(child);
+	}
+	int removed_key = (0 == c) ? 0 : c - 1;
+	for (int i = removed_key; i + 1 < internal->count - 1; ++i) {
+		internal->keys[i] = internal->keys[i + 1];
+	}
+	for (int i = c; i + 1 < internal->count; ++i) {
+		internal->children[i] = internal->children[i + 1];
+		internal->sizes[i] = internal->sizes[i + 1];
+	}
+	--internal->count;
+}
+
+void BPlusTree::remove_from_leaf(BPlusLeaf* leaf, int i) {
+	//	keep the records in slots 0 up to count by moving the last slot's 
+	//	record into the slot that is freed
+	int freed = leaf->slots[i];
+	int last = leaf->count - 1;
+	if (freed != last) {
+		for (int j = 0; j < leaf->count; ++j) {
+			if (last == leaf->slots[j]) {
+				leaf->slots[j] = freed;
+				break;
+			}
+		}
+		leaf->records[freed] = leaf->records[last];
+	}
+	for (int j = i; j < last; ++j) {
+		leaf->keys[j] = leaf->keys[j + 1];
+		leaf->slots[j] = leaf->slots[j + 1];
+	}
+	--leaf->count;
+}
+
+int BPlusTree::name_rank(const std::string& species, bool or_equal) const {
+	//	a key is counted if its species is less than species, or equal to it 
+	//	when or_equal is true. The keys that are counted come first
+	int count = 0;
+	const BPlusNode* node = root_;
+	while (node != nullptr && !node->is_leaf) {
+		const BPlusInternal* internal = static_cast<const BPlusInternal*>(node);
+		int c = 0;
+		while (c < internal->count - 1) {
+			int order = internal->keys[c].species->compare(species);
+			if (order > 0 || (0 == order && !or_equal)) {
+				break;
+			}
+			count += internal->sizes[c];
+			++c;
+		}
+		node = internal->children[c];
+	}
+	if (node != nullptr) {
+		const BPlusLeaf* leaf = static_cast<const BPlusLeaf*>(node);
+		for (int i = 0; i < leaf->count; ++i) {
+			int order = leaf->keys[i].species->compare(species);
+			if (order > 0 || (0 == order && !or_equal)) {
+				break;
+			}
+			++count;
+		}
+	}
+	return count;
+}
+
+int BPlusTree::count_name(const std::string& species) const {
+	return name_rank(species, true) - name_rank(species, false);
+}
+
+std::string BPlusTree::stored_name(const std::string& species_name) const {
+	std::string spc = species_name;
+	for (char& c : spc) {
+		if (isupper(c)) {
+			c = tolower(c);
+		}
+	}
+	if (0 == count_name(spc) && !spc.empty()) {
+		//	the same change as AVL_Tree::change_case
+		if (islower(spc[0])) {
+			spc[0] = toupper(spc[0]);
+		} else if (ispunct(spc[0]) && 1 < spc.size()) {
+			spc[1] = toupper(spc[1]);
+		}
+	}
+	return spc;
+}
+
+void BPlusTree::clear(BPlusNode* node) {
+	if (node == nullptr) {
+		return;
+	}
+	if (node->is_leaf) {
+		delete static_cast<BPlusLeaf*>(node);
+		return;
+	}
+	BPlusInternal* internal = static_cast<BPlusInternal*>(node);
+	for (int c = 0; c < internal->count; ++c) {
+		clear(internal->children[c]);
+	}
+	delete internal;
+}
@@ -0,0 +1,281 @@
+/*******************************************************************************
+  Title          : bplus_tree.h
+  Description    : The interface file for the BPlusTree class
+  Purpose        : To store the trees of the 2015 NYC Street Tree Census in 
+                   wide nodes that take fewer cache misses to search than the 
+                   nodes of AVL_Tree
+  Usage          : Use in the same way as AVL_Tree. It has the same public 
+                   methods and gives the same results
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __BPLUS_TREE_H__
+#define __BPLUS_TREE_H__
+
+#include "avl.h"
+#include "tree.h"
+#include "group_by.h"
+#include "tree_index.h"
+#include <list>
+#include <ostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+//	The largest number of children of an internal node
+const int kBPlusFanout = 16;
+
+//	The largest number of Tree objects in a leaf
+const int kBPlusLeafSize = 32;
+
+//	The key of a Tree object in a BPlusTree: its spc_common member, which 
+//	points to the one copy of the name that the BPlusTree keeps, and its 
+//	tree_id. Keys made to search for a Tree may point to any string
+struct BPlusKey {
+	const std::string* species;
+	int tree_id;
+};
+
+//	The part that internal nodes and leaves have in common. count is the 
+//	number of children of an internal node or of Tree objects in a leaf
+struct BPlusNode {
+	bool is_leaf;
+	int count;
+
+	explicit BPlusNode(bool leaf) : is_leaf(leaf), count(0) {
+	}
+};
+
+//	An internal node holds only keys, child pointers and the number of Tree 
+//	objects under each child. keys[i] is the smallest key that can be under 
+//	children[i + 1] and is larger than every key under children[i]
+struct BPlusInternal : public BPlusNode {
+	BPlusKey keys[kBPlusFanout - 1];
+	BPlusNode* children[kBPlusFanout];
+	int sizes[kBPlusFanout];
+
+	BPlusInternal() : BPlusNode(false) {
+	}
+};
+
+//	A leaf holds its keys in order. The Tree object of keys[i] is 
+//	records[slots[i]]. The records stay in slots 0 up to count and do not move
+//	when keys are inserted before them, so inserting only shifts keys and 
+//	slot numbers. The leaves are linked in order
+struct BPlusLeaf : public BPlusNode {
+	BPlusKey keys[kBPlusLeafSize];
+	unsigned char slots[kBPlusLeafSize];
+	Tree records[kBPlusLeafSize];
+	BPlusLeaf* previous;
+	BPlusLeaf* next;
+
+	BPlusLeaf() : BPlusNode(true), previous(nullptr), next(nullptr) {
+	}
+
+	//	Returns the Tree object of keys[i]
+	const Tree& record(int i) const {
+		return records[slots[i]];
+	}
+};
+
+/*******************************************************************************
+
+		The BPlusTree class stores Tree objects in the same order as AVL_Tree,
+		using the spc_common member as the primary key and the tree_id as the 
+		secondary key, and has the same public methods with the same results. 
+		Internal nodes have up to kBPlusFanout children and hold nothing but keys,
+		so a search reads a few wide nodes instead of about 20 BinaryNodes in 
+		different places. Every key points to the BPlusTree's only copy of its 
+		species name, so comparing two keys of the same species compares two 
+		pointers. Each internal node also stores the number of Tree objects 
+		under each child, which makes rank, select and the count of a species 
+		take O(log n) time. The Tree objects are kept in the leaves, and the 
+		leaves are linked, so the Trees of a species and the queries that visit 
+		every Tree read the leaves one after another. A leaf that becomes empty 
+		is removed, but leaves and internal nodes that are only partly full are 
+		not merged with their neighbors. BPlusTree is one of the TreeIndex 
+		implementations that a TreeCollection can use
+
+*******************************************************************************/
+
+class BPlusTree : public TreeIndex {
+ public:
+	//	Default constructor for BPlusTree object
+	BPlusTree();
+
+	//	Copy constructor for BPlusTree object
+	BPlusTree(const BPlusTree& tree);
+
+	//	Destructor for BPlusTree object
+	~BPlusTree();
+
+	//	Returns true if BPlusTree object contains no trees
+	bool empty() const;
+
+	//	Returns the number of Tree objects in BPlusTree object
+	int get_number_of_trees() const;
+
+	//	Returns the number of levels of internal nodes above the leaves, or -1
+	//	if the BPlusTree is empty
+	int height() const;
+
+	//	Returns the stored Tree object that is equal to x if x is found.
+	//	Otherwise, returns the Tree object stored in kNotFound
+	const Tree& find(const Tree& x) const;
+
+	//	Returns the stored Tree object whose tree_id is tree_id, or the Tree 
+	//	object stored in kNotFound if there is no such Tree
+	const Tree& find_by_id(int tree_id) const;
+
+	//	Returns the minimum Tree object in the BPlusTree object
+	//	If called when BPlusTree is empty, returns kNotFound
+	const Tree& findMin() const;
+
+	//	Returns the maximum Tree object in the BPlusTree object
+	//	If called when BPlusTree is empty, returns kNotFound
+	const Tree& findMax() const;
+
+	//	Returns the number of Tree objects that are less than x
+	int rank(const Tree& x) const;
+
+	//	Returns the Tree object whose rank is i, counting from 0
+	//	If i is out of range, returns the Tree object stored in kNotFound
+	const Tree& select(int i) const;
+
+	//	Returns a list of Tree objects whose spc_common member is equal to
+	//	x's spc_common member, using the same rules as AVL_Tree::findallmatches
+	std::list<Tree> findallmatches(const Tree& x) const;
+
+	//	Returns the number of Tree objects whose spc_common member equals
+	//	name_of_species, using the same rules as AVL_Tree::count_species
+	int count_species(const std::string& name_of_species) const;
+
+	//	Returns a list of the spc_common members of all the Tree objects found in
+	//	the given zipcode, in order. The returned list will contain duplicates
+	std::list<std::string> all_in_zipcode(const int& zip) const;
+
+	//	Returns a list of the spc_common members of all the Tree objects found
+	//	within the given distance of the given latitude and longitude 
+	//	coordinates in kilometers, in order
+	std::list<std::string> all_nearby(const double& latitude,
+	                                  const double& longitude,
+	                                  const double& distance) const;
+
+	//	Counts every Tree object in groups
+	void group_all(GroupBy& groups) const;
+
+	//	Counts the Tree objects found in the given zipcode in groups
+	void group_in_zipcode(const int& zip, GroupBy& groups) const;
+
+	//	Counts the Tree objects found within the given distance of the given 
+	//	coordinates in groups
+	void group_nearby(const double& latitude, const double& longitude,
+	                  const double& distance, GroupBy& groups) const;
+
+	//	Calls visit with every Tree object, in one pass over the leaves, since
+	//	the leaves keep no boxes. Returns the number of Trees read
+	long long for_each_in_box(const std::vector<CoordinateBox>& boxes,
+	                          const TreeVisitor& visit) const;
+
+	//	The versions of the queries above that take a WorkStealingPool, which 
+	//	run on the calling thread
+	using TreeIndex::all_in_zipcode;
+	using TreeIndex::all_nearby;
+	using TreeIndex::group_nearby;
+
+	//	Prints all the Tree objects in the BPlusTree object
+	void print(std::ostream& out) const;
+
+	//	Prints the Tree objects whose ranks are from first up to but not 
+	//	including last, in order
+	void print(std::ostream& out, int first, int last) const;
+
+	//	Removes all Tree objects from BPlusTree object
+	void clear();
+
+	//	Adds the Tree object x to the BPlusTree object
+	//	Returns false if a Tree object equal to x was already stored
+	bool insert(const Tree& x);
+
+	//	Removes the Tree object x from the BPlusTree object
+	//	Returns false if no Tree object equal to x was stored
+	bool remove(const Tree& x);
+
+	//	Makes species the same as AVL_Tree::change_case makes it
+	void change_case(std::string& species) const;
+
+ protected:
+	//	Returns true if key a comes before key b
+	static bool less(const BPlusKey& a, const BPlusKey& b);
+
+	//	Returns the child of node that key belongs under
+	static int child_index(const BPlusInternal* node, const BPlusKey& key);
+
+	//	Returns the position of the first key in leaf that is not less than key
+	static int lower_bound(const BPlusLeaf* leaf, const BPlusKey& key);
+
+	//	Returns the number of Tree objects under node
+	static int subtree_size(const BPlusNode* node);
+
+	//	Returns the stored Tree object whose key equals key, or null
+	const Tree* locate(const BPlusKey& key) const;
+
+	//	Sets leaf and index to the leaf and position of the Tree object whose 
+	//	rank is i, which must be less than the number of Tree objects
+	void locate_rank(int i, const BPlusLeaf*& leaf, int& index) const;
+
+	//	Adds x with key to the subtree whose root is node. If node had to be 
+	//	split, returns the new node that holds its upper half and sets 
+	//	separator to the smallest key that can be in it. Otherwise returns null
+	BPlusNode* insert(BPlusNode* node, const BPlusKey& key, const Tree& x,
+	                  BPlusKey& separator);
+
+	//	Removes the Tree object with key from the subtree whose root is node, 
+	//	which must contain it. Nodes under node that become empty are deleted
+	void remove(BPlusNode* node, const BPlusKey& key);
+
+	//	Removes the key at position i of leaf and its Tree object
+	void remove_from_leaf(BPlusLeaf* leaf, int i);
+
+	//	Returns the number of Tree objects whose spc_common member is less than
+	//	species, or less than or equal to it if or_equal is true
+	int name_rank(const std::string& species, bool or_equal) const;
+
+	//	Returns the number of Tree objects whose spc_common is exactly species
+	int count_name(const std::string& species) const;
+
+	//	Returns the spc_common that the stored Trees use for species_name, which
+	//	is species_name in lowercase or with its first letter capitalized
+	std::string stored_name(const std::string& species_name) const;
+
+	//	Deletes the subtree whose root is node
+	void clear(BPlusNode* node);
+
+ private:
+	//	Pointer to the root, which is null if the BPlusTree is empty
+	BPlusNode* root_;
+
+	//	The first and last leaves in order
+	BPlusLeaf* first_leaf_;
+	BPlusLeaf* last_leaf_;
+
+	//	The number of Tree objects stored
+	int size_;
+
+	//	The number of levels of internal nodes, or -1 if the BPlusTree is empty
+	int height_;
+
+	//	One copy of each spc_common member that has been stored. Keys point into
+	//	it, and since std::set never moves its strings the pointers stay valid
+	std::set<std::string> species_;
+
+	//	Maps the tree_id of every stored Tree to its spc_common, so the key of 
+	//	a Tree can be found from its tree_id. Like AVL_Tree's index, if two 
+	//	stored Trees have the same tree_id, the last one inserted is found
+	std::unordered_map<int, const std::string*> ids_;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/*******************************************************************************
+  Title          : census_file.cpp
+  Description    : The implementation file for the CensusFile class
+  Purpose        : To keep the tree census file mapped into memory so that the
+                   fields of a Tree that queries rarely need can be parsed from
+                   its record only when they are asked for
+  Usage          : Call open() with the census file name and give the 
+                   CensusFile to TreeCollection::load
+  Build with     : g++ -c -std=c++11 census_file.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "census_file.h"
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CensusFile::CensusFile() : data_(nullptr), size_(0), mapped_(false) {
+}
+
+CensusFile::~CensusFile() {
+#ifdef __unix__
+	if (mapped_) {
+		munmap(const_cast<char*>(data_), size_);
+	}
+#endif
+}
+
+bool CensusFile::open(const std::string& file_name) {
+#ifdef __unix__
+	int fd = ::open(file_name.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat status;
+	if (0 == fstat(fd, &status) && 0 < status.st_size) {
+		void* bytes = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 
+		                   0);
+		if (bytes != MAP_FAILED) {
+			//	the records are read from first to last while loading, until 
+			//	end_scan() is called
+			madvise(bytes, status.st_size, MADV_SEQUENTIAL);
+			data_ = static_cast<const char*>(bytes);
+			size_ = status.st_size;
+			mapped_ = true;
+			close(fd);
+			return true;
+		}
+	}
+	close(fd);
+#endif
+	//	an empty file cannot be mapped, and some systems have no mmap
+	std::ifstream census(file_name.c_str(), std::ios::binary);
+	if (census.fail()) {
+		return false;
+	}
+	buffer_.assign(std::istreambuf_iterator<char>(census), 
+	               std::istreambuf_iterator<char>());
+	data_ = buffer_.data();
+	size_ = buffer_.size();
+	return true;
+}
+
+const char* CensusFile::data() const {
+	return data_;
+}
+
+long CensusFile::size() const {
+	return size_;
+}
+
+long CensusFile::record_end(long offset) const {
+	const void* newline = memchr(data_ + offset, '\n', size_ - offset);
+	if (newline == nullptr) {
+		return -1;
+	}
+	return static_cast<const char*>(newline) - data_;
+}
+
+std::string CensusFile::record(long offset) const {
+	long end = record_end(offset);
+	if (end < 0) {
+		end = size_;
+	}
+	return std::string(data_ + offset, end - offset);
+}
+
+void CensusFile::end_scan() const {
+#ifdef __unix__
+	if (mapped_) {
+		//	without this the pages behind the load scan may already be dropped,
+		//	and a record printed later would bring in its neighbors as well
+		madvise(const_cast<char*>(data_), size_, MADV_RANDOM);
+	}
+#endif
+}
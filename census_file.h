@@ -0,0 +1,79 @@
+/*******************************************************************************
+  Title          : census_file.h
+  Description    : The interface file for the CensusFile class
+  Purpose        : To keep the tree census file mapped into memory so that the
+                   fields of a Tree that queries rarely need can be parsed from
+                   its record only when they are asked for
+  Usage          : Call open() with the census file name and give the 
+                   CensusFile to TreeCollection::load
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __CENSUS_FILE_H__
+#define __CENSUS_FILE_H__
+
+#include <string>
+#include <vector>
+
+/*******************************************************************************
+
+		The CensusFile class maps a tree census file into memory with mmap, or 
+		reads all of it into a buffer where mmap is not available, and gives 
+		out its records, which are its lines, by the byte offset where they 
+		start. Only lines that end in a newline are records, the same lines 
+		that TreeCollection::load(std::istream&) reads. The file is mapped for
+		reading from first to last, which lets the system read ahead and drop 
+		the pages behind the load scan, and end_scan() switches it to reading 
+		single records in any order, as printing Trees does. The file stays 
+		mapped until the CensusFile is destroyed, so it must outlive every Tree 
+		made from it
+
+*******************************************************************************/
+
+class CensusFile {
+ public:
+	//	Creates a CensusFile object with no file
+	CensusFile();
+
+	//	Unmaps the file
+	~CensusFile();
+
+	//	Maps the file file_name. Returns false if it cannot be opened or mapped
+	bool open(const std::string& file_name);
+
+	//	Returns the first byte of the file
+	const char* data() const;
+
+	//	Returns the number of bytes in the file
+	long size() const;
+
+	//	Returns the offset of the newline that ends the record at offset, or -1
+	//	if the record does not end in a newline
+	long record_end(long offset) const;
+
+	//	Returns the record at offset without its newline
+	std::string record(long offset) const;
+
+	//	Tells the system that the records are now read in any order, one at a 
+	//	time, instead of from first to last. Call it once the load scan is done
+	void end_scan() const;
+
+ private:
+	CensusFile(const CensusFile&);
+	CensusFile& operator=(const CensusFile&);
+
+	//	The mapped bytes, or the first byte of buffer_
+	const char* data_;
+	long size_;
+
+	//	True if data_ was mapped with mmap and has to be unmapped
+	bool mapped_;
+
+	//	The bytes of the file if it could not be mapped
+	std::vector<char> buffer_;
+};
+
+#endif
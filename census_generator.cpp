@@ -0,0 +1,334 @@
+/*******************************************************************************
+  Title          : census_generator.cpp
+  Description    : The implementation file for the CensusGenerator class
+  Purpose        : To make census files and command files of any size that 
+                   look like the 2015 NYC Street Tree Census, for testing the
+                   program on more trees than the real census has
+  Usage          : Call write_row() for each tree and write_command() for 
+                   each command. Nothing is kept between calls, so files of 
+                   any size can be written
+  Build with     : g++ -c -std=c++11 census_generator.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "census_generator.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+
+//	A species of the census and about how many trees of it the real census has
+struct SpeciesEntry {
+	const char* latin;
+	const char* common;
+	int count;
+};
+
+const SpeciesEntry kSpecies[] = {
+	{"Platanus x acerifolia", "London planetree", 87014},
+	{"Gleditsia triacanthos var. inermis", "honeylocust", 64264},
+	{"Pyrus calleryana", "Callery pear", 58931},
+	{"Quercus palustris", "pin oak", 53185},
+	{"Acer platanoides", "Norway maple", 34189},
+	{"Tilia cordata", "littleleaf linden", 29742},
+	{"Prunus", "cherry", 29279},
+	{"Zelkova serrata", "Japanese zelkova", 29258},
+	{"Ginkgo biloba", "ginkgo", 21024},
+	{"Styphnolobium japonicum", "Sophora", 19338},
+	{"Acer rubrum", "red maple", 17246},
+	{"Fraxinus pennsylvanica", "green ash", 16251},
+	{"Tilia americana", "American linden", 13530},
+	{"Acer saccharinum", "silver maple", 12277},
+	{"Liquidambar styraciflua", "sweetgum", 10657},
+	{"Quercus rubra", "northern red oak", 8400},
+	{"Quercus bicolor", "swamp white oak", 7975},
+	{"Malus", "crab apple", 7974},
+	{"Ulmus americana", "American elm", 7975},
+	{"Acer", "maple", 7080},
+	{"Quercus phellos", "willow oak", 5027},
+	{"Prunus virginiana", "'Schubert' chokecherry", 4888},
+	{"Syringa reticulata", "Japanese tree lilac", 3596},
+	{"Cercis canadensis", "eastern redbud", 3517},
+	{"Ulmus parvifolia", "Chinese elm", 3450},
+	{"Prunus cerasifera", "purple-leaf plum", 3260},
+	{"Koelreuteria paniculata", "golden raintree", 2998},
+	{"Robinia pseudoacacia", "black locust", 2885},
+	{"Crataegus", "hawthorn", 2769},
+	{"Fraxinus", "ash", 2736},
+	{"Gymnocladus dioicus", "Kentucky coffeetree", 2470},
+	{"Acer campestre", "hedge maple", 2461},
+	{"Celtis occidentalis", "hackberry", 2327},
+	{"Acer pseudoplatanus", "sycamore maple", 2142},
+	{"Quercus alba", "white oak", 1865},
+	{"Liriodendron tulipifera", "tulip-poplar", 1785},
+	{"Betula nigra", "river birch", 1580},
+	{"Amelanchier", "serviceberry", 1383},
+	{"Ailanthus altissima", "tree of heaven", 1281},
+	{"Carpinus betulus", "European hornbeam", 1176},
+	{"Acer ginnala", "Amur maple", 1066},
+	{"Chionanthus retusus", "Chinese fringetree", 926},
+	{"Prunus serotina", "black cherry", 817},
+	{"Metasequoia glyptostroboides", "dawn redwood", 765},
+	{"Quercus coccinea", "scarlet oak", 722},
+	{"Morus", "mulberry", 709},
+	{"Acer negundo", "boxelder", 673},
+	{"Ulmus pumila", "Siberian elm", 587},
+	{"Catalpa", "catalpa", 570},
+	{"Picea abies", "Norway spruce", 486},
+	{"Styrax japonicus", "Japanese snowbell", 471},
+	{"Salix babylonica", "weeping willow", 289},
+	{"Quercus acutissima", "sawtooth oak", 280},
+	{"Cornus kousa", "kousa dogwood", 276},
+	{"Pinus strobus", "eastern white pine", 212},
+	{"Magnolia", "magnolia", 182},
+	{"Castanea dentata", "American chestnut", 111},
+	{"Juniperus virginiana", "eastern redcedar", 99},
+	{"Aesculus hippocastanum", "horse chestnut", 92},
+	{"Cladrastis kentukea", "Kentucky yellowwood", 66},
+	{"Pinus nigra", "Austrian pine", 55},
+	{"Quercus macrocarpa", "bur oak", 30},
+	{"Pinus sylvestris", "Scots pine", 25},
+	{"Eucommia ulmoides", "hardy rubber tree", 14},
+	{"Pinus rigida", "pitch pine", 11},
+	{"Maclura pomifera", "Osage-orange", 6},
+};
+
+//	A zipcode of a borough and the city that the census gives for it
+struct ZipEntry {
+	int zip;
+	const char* city;
+};
+
+//	A borough, about how many trees the real census has in it, the box its 
+//	trees are in, and some of its zipcodes
+struct BoroughEntry {
+	const char* name;
+	const char* nta_prefix;
+	int code;
+	int count;
+	double south, north, west, east;
+	std::vector<ZipEntry> zips;
+};
+
+const BoroughEntry kBoroughs[] = {
+	{"Manhattan", "MN", 1, 65423, 40.70, 40.87, -74.02, -73.91,
+	 {{10002, "New York"}, {10003, "New York"}, {10009, "New York"},
+	  {10011, "New York"}, {10019, "New York"}, {10025, "New York"},
+	  {10028, "New York"}, {10031, "New York"}, {10032, "New York"},
+	  {10034, "New York"}, {10065, "New York"}, {10128, "New York"}}},
+	{"Bronx", "BX", 2, 85203, 40.80, 40.91, -73.93, -73.77,
+	 {{10451, "Bronx"}, {10452, "Bronx"}, {10453, "Bronx"}, {10456, "Bronx"},
+	  {10457, "Bronx"}, {10458, "Bronx"}, {10461, "Bronx"}, {10462, "Bronx"},
+	  {10465, "Bronx"}, {10469, "Bronx"}, {10471, "Bronx"}}},
+	{"Brooklyn", "BK", 3, 177293, 40.58, 40.74, -74.04, -73.86,
+	 {{11201, "Brooklyn"}, {11205, "Brooklyn"}, {11215, "Brooklyn"},
+	  {11217, "Brooklyn"}, {11218, "Brooklyn"}, {11220, "Brooklyn"},
+	  {11223, "Brooklyn"}, {11226, "Brooklyn"}, {11229, "Brooklyn"},
+	  {11234, "Brooklyn"}, {11236, "Brooklyn"}}},
+	{"Queens", "QN", 4, 250551, 40.55, 40.80, -73.96, -73.70,
+	 {{11101, "Long Island City"}, {11102, "Astoria"}, {11354, "Flushing"},
+	  {11355, "Flushing"}, {11357, "Whitestone"}, {11360, "Bayside"},
+	  {11364, "Oakland Gardens"}, {11375, "Forest Hills"}, 
+	  {11385, "Ridgewood"}, {11432, "Jamaica"}, {11434, "Jamaica"},
+	  {11691, "Far Rockaway"}}},
+	{"Staten Island", "SI", 5, 105318, 40.50, 40.65, -74.25, -74.06,
+	 {{10301, "Staten Island"}, {10304, "Staten Island"}, 
+	  {10305, "Staten Island"}, {10306, "Staten Island"},
+	  {10308, "Staten Island"}, {10309, "Staten Island"},
+	  {10312, "Staten Island"}, {10314, "Staten Island"}}},
+};
+
+const char* const kStreets[] = {"BROADWAY", "AVENUE", "STREET", "PLACE",
+                                "ROAD", "BOULEVARD", "DRIVE", "PARKWAY"};
+const char* const kProblems[] = {"Stones", "BranchLights", "BranchOther",
+                                 "RootOther", "TrunkOther", "WiresRope",
+                                 "MetalGrates", "Sneakers", "TrunkLights"};
+const char* const kStewards[] = {"None", "1or2", "3or4", "4orMore"};
+const char* const kGuards[] = {"None", "Helpful", "Harmful", "Unsure"};
+const char* const kUserTypes[] = {"TreesCount Staff", "Volunteer",
+                                  "NYC Parks Staff"};
+const char* const kRollupKeys[] = {"species", "zip", "borough", "health",
+                                   "diameter"};
+const double kDistances[] = {0.025, 0.05, 0.1, 0.25, 0.5, 1, 2};
+
+//	The share of trees that are dead and that are stumps in the real census
+const double kDeadShare = 0.020;
+const double kStumpShare = 0.026;
+
+//	The share of trees with more than one problem
+const double kManyProblemsShare = 0.1;
+
+const int kNumberOfSpecies = sizeof(kSpecies) / sizeof(kSpecies[0]);
+const int kNumberOfBoroughs = sizeof(kBoroughs) / sizeof(kBoroughs[0]);
+
+CensusGenerator::CensusGenerator(unsigned int seed, long long number_of_rows)
+    : random_(seed), number_of_rows_(std::max(number_of_rows, 1LL)) {
+	std::vector<double> weights;
+	for (int s = 0; s < kNumberOfSpecies; ++s) {
+		weights.push_back(kSpecies[s].count);
+	}
+	species_ = std::discrete_distribution<int>(weights.begin(), weights.end());
+	weights.clear();
+	for (int b = 0; b < kNumberOfBoroughs; ++b) {
+		weights.push_back(kBoroughs[b].count);
+	}
+	boroughs_ = std::discrete_distribution<int>(weights.begin(), weights.end());
+}
+
+CensusGenerator::~CensusGenerator() {
+}
+
+void CensusGenerator::write_row(std::ostream& out, long long tree_id) {
+	const BoroughEntry& borough = kBoroughs[boroughs_(random_)];
+	const ZipEntry& zip = borough.zips[uniform(0, borough.zips.size() - 1)];
+	double latitude = uniform_real(borough.south, borough.north);
+	double longitude = uniform_real(borough.west, borough.east);
+	//	the state plane coordinates are a rough linear fit, in feet
+	double x_sp = 987000 + (longitude + 73.99) * 276000;
+	double y_sp = 200000 + (latitude - 40.70) * 364000;
+
+	double status_draw = uniform_real(0, 1);
+	bool stump = status_draw < kStumpShare;
+	bool dead = !stump && status_draw < kStumpShare + kDeadShare;
+	bool alive = !stump && !dead;
+	int diameter = stump ? 0 : std::min(1 + static_cast<int>(
+	               std::exponential_distribution<double>(1.0 / 10)(random_)), 
+	               60);
+	int stump_diameter = stump ? uniform(4, 40) : 0;
+
+	char buffer[1024];
+	int length = snprintf(buffer, sizeof(buffer), "%lld,%d,%02d/%02d/%d,%d,%d,%s,"
+	    "%s,", tree_id, uniform(100000, 999999), uniform(5, 12), 
+	    uniform(1, 28), chance(0.9) ? 2015 : 2016, diameter, stump_diameter, 
+	    chance(0.95) ? "OnCurb" : "OffsetFromCurb", 
+	    alive ? "Alive" : (dead ? "Dead" : "Stump"));
+	out.write(buffer, length);
+
+	if (alive) {
+		const SpeciesEntry& species = kSpecies[species_(random_)];
+		double health_draw = uniform_real(0, 1);
+		const char* health = health_draw < 0.81 ? "Good" : 
+		                     (health_draw < 0.96 ? "Fair" : "Poor");
+		out << health << ',' << species.latin << ',' << species.common << ','
+		    << kStewards[pick({70, 20, 8, 2})] << ','
+		    << kGuards[pick({85, 8, 4, 3})] << ','
+		    << (chance(0.7) ? "NoDamage" : "Damage") << ','
+		    << kUserTypes[pick({40, 35, 25})] << ',';
+		if (chance(kManyProblemsShare)) {
+			//	a quoted column with more than one problem separated by commas
+			int first = uniform(0, 8);
+			int second = (first + uniform(1, 8)) % 9;
+			out << '"' << kProblems[first] << ',' << kProblems[second] << '"';
+		} else if (chance(0.3)) {
+			out << kProblems[uniform(0, 8)];
+		} else {
+			out << "None";
+		}
+	} else {
+		out << ",,,,,," << kUserTypes[pick({40, 35, 25})] << ',';
+	}
+	//	the nine root, trunk and branch problem columns
+	for (int i = 0; i < 9; ++i) {
+		out << ',' << (alive && chance(0.1) ? "Yes" : "No");
+	}
+
+	int community_board = borough.code * 100 + uniform(1, 18);
+	length = snprintf(buffer, sizeof(buffer), ",%d %d %s,%d,%s,%d,%d,%s,%d,%d,"
+	    "%d,%s%02d,%s Area %d,%d%06d,New York,%.8f,%.8f,%.4f,%.4f\n",
+	    uniform(1, 2999), uniform(1, 250), kStreets[uniform(0, 7)], zip.zip,
+	    zip.city, community_board, borough.code, borough.name, uniform(1, 51),
+	    uniform(23, 87), uniform(10, 36), borough.nta_prefix, uniform(1, 99),
+	    borough.name, uniform(1, 99), borough.code, uniform(100, 999999),
+	    latitude, longitude, x_sp, y_sp);
+	out.write(buffer, length);
+}
+
+void CensusGenerator::write_command(std::ostream& out, 
+                                    const std::string& command) {
+	if ("tree_info" == command) {
+		if (chance(0.05)) {
+			out << "tree_info banyan" << std::endl;
+			return;
+		}
+		//	a whole species name or one word of it, like the command files use
+		std::string name = kSpecies[species_(random_)].common;
+		std::vector<std::string> words;
+		std::string::size_type start = 0;
+		while (start < name.size()) {
+			std::string::size_type end = name.find(' ', start);
+			if (end == std::string::npos) {
+				end = name.size();
+			}
+			words.push_back(name.substr(start, end - start));
+			start = end + 1;
+		}
+		if (chance(0.5)) {
+			name = words[uniform(0, words.size() - 1)];
+		}
+		if (chance(0.2)) {
+			std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+		}
+		out << "tree_info " << name << std::endl;
+	} else if ("listall_names" == command) {
+		out << "listall_names" << std::endl;
+	} else if ("listall_inzip" == command) {
+		const BoroughEntry& borough = kBoroughs[boroughs_(random_)];
+		int zip = chance(0.05) ? 99999 : 
+		          borough.zips[uniform(0, borough.zips.size() - 1)].zip;
+		out << "listall_inzip " << zip << std::endl;
+	} else if ("list_near" == command) {
+		const BoroughEntry& borough = kBoroughs[boroughs_(random_)];
+		char buffer[128];
+		snprintf(buffer, sizeof(buffer), "list_near %.8f %.8f %g", 
+		         uniform_real(borough.south, borough.north),
+		         uniform_real(borough.west, borough.east), 
+		         kDistances[uniform(0, 6)]);
+		out << buffer << std::endl;
+	} else if ("rollup" == command) {
+		out << "rollup " << kRollupKeys[uniform(0, 4)] << std::endl;
+	} else if ("lookup" == command) {
+		std::uniform_int_distribution<long long> ids(1, number_of_rows_);
+		out << "lookup " << ids(random_) << std::endl;
+	} else if ("print" == command) {
+		std::uniform_int_distribution<long long> ranks(0, number_of_rows_ - 1);
+		long long first = ranks(random_);
+		out << "print " << first << " " << first + uniform(10, 100) << std::endl;
+	} else if ("verify" == command) {
+		out << "verify" << std::endl;
+	}
+}
+
+std::string CensusGenerator::pick_command(const std::map<std::string, double>& 
+                                          mix) {
+	std::vector<std::string> names;
+	std::vector<double> weights;
+	std::map<std::string, double>::const_iterator it;
+	for (it = mix.begin(); it != mix.end(); ++it) {
+		names.push_back(it->first);
+		weights.push_back(it->second);
+	}
+	return names[pick(weights)];
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+int CensusGenerator::uniform(int low, int high) {
+	return std::uniform_int_distribution<int>(low, high)(random_);
+}
+
+double CensusGenerator::uniform_real(double low, double high) {
+	return std::uniform_real_distribution<double>(low, high)(random_);
+}
+
+bool CensusGenerator::chance(double p) {
+	return uniform_real(0, 1) < p;
+}
+
+int CensusGenerator::pick(const std::vector<double>& weights) {
+	return std::discrete_distribution<int>(weights.begin(), weights.end())(
+	    random_);
+}
@@ -0,0 +1,101 @@
+/*******************************************************************************
+  Title          : census_generator.h
+  Description    : The interface file for the CensusGenerator class
+  Purpose        : To make census files and command files of any size that 
+                   look like the 2015 NYC Street Tree Census, for testing the
+                   program on more trees than the real census has
+  Usage          : Call write_row() for each tree and write_command() for 
+                   each command. Nothing is kept between calls, so files of 
+                   any size can be written
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __CENSUS_GENERATOR_H__
+#define __CENSUS_GENERATOR_H__
+
+#include <map>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+//	The commands that write_command can write
+const char* const kGeneratedCommands[] = {"tree_info", "listall_names",
+                                          "listall_inzip", "list_near",
+                                          "rollup", "lookup", "print", 
+                                          "verify"};
+const int kNumberOfGeneratedCommands = 8;
+
+/*******************************************************************************
+
+		The CensusGenerator class writes random lines in the 41 column layout of 
+		the 2015 NYC Street Tree Census, which the Tree constructor for a line
+		reads. The species are drawn with the frequencies they have in the real
+		census, so a few species have most of the trees and many have only a 
+		few, and about 5% of the trees are dead trees or stumps with no species.
+		The borough is drawn with the real share of trees in each borough, the 
+		zipcode and its city are drawn from the real zipcodes of that borough, 
+		and the latitude and longitude are inside the borough's bounding box. 
+		About 1 tree in 10 has more than one problem, which is written as a 
+		quoted column with commas in it, like the real census. The same 
+		generator writes command files whose arguments are species, zipcodes, 
+		places and tree_ids that exist in the generated census. The same seed 
+		always gives the same files
+
+*******************************************************************************/
+
+class CensusGenerator {
+ public:
+	//	Creates a CensusGenerator object that draws its random numbers from 
+	//	seed and whose census has number_of_rows trees with tree_ids from 1 to
+	//	number_of_rows
+	CensusGenerator(unsigned int seed, long long number_of_rows);
+
+	//	Destroys CensusGenerator object
+	~CensusGenerator();
+
+	//	Writes one census line for the tree with the given tree_id, followed by
+	//	a newline
+	void write_row(std::ostream& out, long long tree_id);
+
+	//	Writes one line of the command named command, which is one of 
+	//	kGeneratedCommands, with random arguments
+	void write_command(std::ostream& out, const std::string& command);
+
+	//	Returns the command named by mix, which maps command names to weights,
+	//	drawn with probability proportional to its weight
+	std::string pick_command(const std::map<std::string, double>& mix);
+
+ protected:
+	//	Returns a random integer from low to high, including both
+	int uniform(int low, int high);
+
+	//	Returns a random number from low up to high
+	double uniform_real(double low, double high);
+
+	//	Returns true with probability p
+	bool chance(double p);
+
+	//	Returns the index of an element of weights, drawn with probability 
+	//	proportional to the element
+	int pick(const std::vector<double>& weights);
+
+ private:
+	//	The random number generator
+	std::mt19937 random_;
+
+	//	The number of trees in the census
+	long long number_of_rows_;
+
+	//	Draws a species of the species table in census_generator.cpp with the 
+	//	share of trees it has in the real census
+	std::discrete_distribution<int> species_;
+
+	//	Draws a borough with the share of trees it has in the real census
+	std::discrete_distribution<int> boroughs_;
+};
+
+#endif
@@ -0,0 +1,200 @@
+/*******************************************************************************
+  Title          : command_stats.cpp
+  Description    : The implementation file for the LatencyHistogram and
+                   CommandStats classes
+  Purpose        : To keep the time each command takes and the work it does,
+                   for every kind of command, and summarize them at the end
+  Usage          : Call start() before each command and finish() with its name
+                   after it, then write_table() or write_json()
+  Build with     : g++ -c -std=c++11 command_stats.cpp
+  Modifications  :
+
+*******************************************************************************/
+
+#include "command_stats.h"
+#include "work_counters.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ios>
+#include <iostream>
+
+LatencyHistogram::LatencyHistogram() : count_(0), max_(0) {
+}
+
+void LatencyHistogram::record(long long value) {
+	if (value < 0) {
+		value = 0;
+	}
+	int bucket = bucket_of(value);
+	if (static_cast<int>(buckets_.size()) <= bucket) {
+		buckets_.resize(bucket + 1, 0);
+	}
+	++buckets_[bucket];
+	++count_;
+	max_ = std::max(max_, value);
+}
+
+long long LatencyHistogram::count() const {
+	return count_;
+}
+
+long long LatencyHistogram::max() const {
+	return max_;
+}
+
+long long LatencyHistogram::percentile(double p) const {
+	if (0 == count_) {
+		return 0;
+	}
+	//	the nearest rank, counting from 1
+	long long rank = static_cast<long long>(std::ceil(p * count_));
+	rank = std::min(std::max(rank, 1LL), count_);
+	long long seen = 0;
+	for (unsigned int b = 0; b < buckets_.size(); ++b) {
+		seen += buckets_[b];
+		if (rank <= seen) {
+			return std::min(bucket_end(b), max_);
+		}
+	}
+	return max_;
+}
+
+CommandStats::CommandStats()
+    : counter_(std::cout.rdbuf()), original_(std::cout.rdbuf()),
+      start_trees_visited_(0), start_haversines_(0), start_lines_(0) {
+	WorkCounters::enable(true);
+	std::cout.rdbuf(&counter_);
+}
+
+CommandStats::~CommandStats() {
+	std::cout.flush();
+	std::cout.rdbuf(original_);
+	WorkCounters::enable(false);
+}
+
+void CommandStats::start() {
+	start_trees_visited_ = WorkCounters::trees_visited();
+	start_haversines_ = WorkCounters::haversines();
+	start_lines_ = counter_.lines();
+	start_time_ = std::chrono::steady_clock::now();
+}
+
+void CommandStats::finish(const std::string& name) {
+	std::chrono::steady_clock::time_point end =
+	    std::chrono::steady_clock::now();
+	CommandSummary& summary = summaries_[name];
+	summary.nanoseconds.record(
+	    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_time_)
+	    .count());
+	summary.trees_visited += WorkCounters::trees_visited() -
+	                         start_trees_visited_;
+	summary.haversines += WorkCounters::haversines() - start_haversines_;
+	summary.output_lines += counter_.lines() - start_lines_;
+}
+
+const std::map<std::string, CommandSummary>& CommandStats::summaries() const {
+	return summaries_;
+}
+
+void CommandStats::write_table(std::ostream& out) const {
+	out << std::left << std::setw(16) << "command" << std::right
+	    << std::setw(8) << "count" << std::setw(12) << "p50 us"
+	    << std::setw(12) << "p90 us" << std::setw(12) << "p99 us"
+	    << std::setw(12) << "max us" << std::setw(14) << "trees/cmd"
+	    << std::setw(14) << "haversine/cmd" << std::setw(12) << "lines/cmd"
+	    << std::endl;
+	out << std::fixed << std::setprecision(1);
+	std::map<std::string, CommandSummary>::const_iterator it;
+	for (it = summaries_.begin(); it != summaries_.end(); ++it) {
+		const CommandSummary& summary = it->second;
+		double count = static_cast<double>(summary.nanoseconds.count());
+		out << std::left << std::setw(16) << it->first << std::right
+		    << std::setw(8) << summary.nanoseconds.count()
+		    << std::setw(12) << summary.nanoseconds.percentile(0.5) / 1000.0
+		    << std::setw(12) << summary.nanoseconds.percentile(0.9) / 1000.0
+		    << std::setw(12) << summary.nanoseconds.percentile(0.99) / 1000.0
+		    << std::setw(12) << summary.nanoseconds.max() / 1000.0
+		    << std::setw(14) << summary.trees_visited / count
+		    << std::setw(14) << summary.haversines / count
+		    << std::setw(12) << summary.output_lines / count << std::endl;
+	}
+	out.copyfmt(std::ios(nullptr));
+}
+
+void CommandStats::write_json(std::ostream& out) const {
+	out << "{" << std::endl << "  \"commands\": [" << std::endl;
+	std::map<std::string, CommandSummary>::const_iterator it;
+	for (it = summaries_.begin(); it != summaries_.end(); ++it) {
+		const CommandSummary& summary = it->second;
+		//	the names are the command words, which never need escaping
+		out << "    {\"command\": \"" << it->first << "\""
+		    << ", \"count\": " << summary.nanoseconds.count()
+		    << ", \"p50_ns\": " << summary.nanoseconds.percentile(0.5)
+		    << ", \"p90_ns\": " << summary.nanoseconds.percentile(0.9)
+		    << ", \"p99_ns\": " << summary.nanoseconds.percentile(0.99)
+		    << ", \"max_ns\": " << summary.nanoseconds.max()
+		    << ", \"trees_visited\": " << summary.trees_visited
+		    << ", \"haversines\": " << summary.haversines
+		    << ", \"output_lines\": " << summary.output_lines << "}";
+		std::map<std::string, CommandSummary>::const_iterator next = it;
+		if (++next != summaries_.end()) {
+			out << ",";
+		}
+		out << std::endl;
+	}
+	out << "  ]" << std::endl << "}" << std::endl;
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+int LatencyHistogram::bucket_of(long long value) {
+	if (value < kSubBuckets) {
+		return static_cast<int>(value);
+	}
+	//	kSubBuckets is 2^5, so a value whose highest bit is bit e is shifted
+	//	right by e - 5 to keep its top 5 bits below the highest one
+	int shift = 63 - __builtin_clzll(value) - 5;
+	return shift * kSubBuckets + static_cast<int>(value >> shift);
+}
+
+long long LatencyHistogram::bucket_end(int bucket) {
+	if (bucket < kSubBuckets) {
+		return bucket;
+	}
+	int shift = bucket / kSubBuckets - 1;
+	long long top = bucket - shift * kSubBuckets;
+	return ((top + 1) << shift) - 1;
+}
+
+CommandStats::LineCountingBuffer::LineCountingBuffer(
+    std::streambuf* destination) : destination_(destination), lines_(0) {
+}
+
+long long CommandStats::LineCountingBuffer::lines() const {
+	return lines_;
+}
+
+int CommandStats::LineCountingBuffer::overflow(int c) {
+	if (traits_type::eq_int_type(c, traits_type::eof())) {
+		return traits_type::not_eof(c);
+	}
+	if ('\n' == c) {
+		++lines_;
+	}
+	return destination_->sputc(traits_type::to_char_type(c));
+}
+
+std::streamsize CommandStats::LineCountingBuffer::xsputn(const char* s,
+                                                         std::streamsize n) {
+	lines_ += std::count(s, s + n, '\n');
+	return destination_->sputn(s, n);
+}
+
+int CommandStats::LineCountingBuffer::sync() {
+	return destination_->pubsync();
+}
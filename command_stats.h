@@ -0,0 +1,157 @@
+/*******************************************************************************
+  Title          : command_stats.h
+  Description    : The interface file for the LatencyHistogram and
+                   CommandStats classes
+  Purpose        : To keep the time each command takes and the work it does,
+                   for every kind of command, and summarize them at the end
+  Usage          : Call start() before each command and finish() with its name
+                   after it, then write_table() or write_json()
+  Build with     : No building
+  Modifications  :
+
+*******************************************************************************/
+
+
+#ifndef __COMMAND_STATS_H__
+#define __COMMAND_STATS_H__
+
+#include <chrono>
+#include <map>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/*******************************************************************************
+
+		The LatencyHistogram class counts values, like times in nanoseconds, in
+		buckets whose widths grow with the values, the way an HDR histogram does.
+		Values below kSubBuckets each have their own bucket. Above that, every
+		power of two is split into kSubBuckets buckets of equal width, so a
+		bucket is never wider than 1 / kSubBuckets of the values in it and any
+		percentile is known to within about 3%, while a histogram of times from
+		a nanosecond to hours needs less than two thousand buckets. The largest
+		value is also kept exactly
+
+*******************************************************************************/
+
+class LatencyHistogram {
+ public:
+	//	The number of buckets each power of two is split into
+	static const int kSubBuckets = 32;
+
+	//	Creates an empty LatencyHistogram object
+	LatencyHistogram();
+
+	//	Counts value, which should not be negative
+	void record(long long value);
+
+	//	Returns the number of values counted
+	long long count() const;
+
+	//	Returns the largest value counted, or 0 if there are none
+	long long max() const;
+
+	//	Returns the value that fraction p of the values are less than or equal
+	//	to, rounded up to the end of its bucket, or 0 if there are no values
+	long long percentile(double p) const;
+
+ protected:
+	//	Returns the bucket that value is counted in
+	static int bucket_of(long long value);
+
+	//	Returns the largest value counted in bucket
+	static long long bucket_end(int bucket);
+
+ private:
+	//	The number of values in each bucket. It grows to the largest bucket used
+	std::vector<long long> buckets_;
+
+	long long count_;
+	long long max_;
+};
+
+//	Everything known about the commands of one kind
+struct CommandSummary {
+	LatencyHistogram nanoseconds;
+	long long trees_visited;
+	long long haversines;
+	long long output_lines;
+
+	CommandSummary() : trees_visited(0), haversines(0), output_lines(0) {
+	}
+};
+
+/*******************************************************************************
+
+		The CommandStats class times each command and counts the work it does,
+		and keeps them by the name of the command, so that "list_near" commands
+		are summarized together, apart from "tree_info" commands. The work is
+		read from the WorkCounters, which it enables, and the size of each
+		command's result is the number of lines it writes to standard output,
+		which CommandStats counts by putting a LineCountingBuffer in front of
+		std::cout's buffer until it is destroyed. A program that does not make a
+		CommandStats object does not pay for any of this
+
+*******************************************************************************/
+
+class CommandStats {
+ public:
+	//	Creates a CommandStats object, enables the WorkCounters and starts
+	//	counting the lines written to std::cout
+	CommandStats();
+
+	//	Gives std::cout back its buffer
+	~CommandStats();
+
+	//	Starts timing a command
+	void start();
+
+	//	Stops timing the command that start() was called for and adds it to the
+	//	commands called name
+	void finish(const std::string& name);
+
+	//	Returns the summaries of every kind of command, by name
+	const std::map<std::string, CommandSummary>& summaries() const;
+
+	//	Outputs the count, the 50th, 90th and 99th percentile and maximum times
+	//	in microseconds, and the average work of every kind of command
+	void write_table(std::ostream& out) const;
+
+	//	Outputs the same numbers as write_table as a JSON object, with every
+	//	kind of command on its own line and the times in nanoseconds
+	void write_json(std::ostream& out) const;
+
+ private:
+	//	The LineCountingBuffer class passes everything written to it on to
+	//	another buffer and counts the newlines
+	class LineCountingBuffer : public std::streambuf {
+	 public:
+		explicit LineCountingBuffer(std::streambuf* destination);
+		long long lines() const;
+
+	 protected:
+		int overflow(int c);
+		std::streamsize xsputn(const char* s, std::streamsize n);
+		int sync();
+
+	 private:
+		std::streambuf* destination_;
+		long long lines_;
+	};
+
+	LineCountingBuffer counter_;
+
+	//	The buffer std::cout had before this CommandStats object was made
+	std::streambuf* original_;
+
+	std::map<std::string, CommandSummary> summaries_;
+
+	//	The time, work counters and line count when start() was last called
+	std::chrono::steady_clock::time_point start_time_;
+	long long start_trees_visited_;
+	long long start_haversines_;
+	long long start_lines_;
+};
+
+#endif
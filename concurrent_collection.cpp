@@ -0,0 +1,274 @@
+/*******************************************************************************
+  Title          : concurrent_collection.cpp
+  Description    : The implementation file for the ConcurrentTreeCollection 
+                   class
+  Purpose        : To answer queries about the trees of the 2015 NYC Street 
+                   Tree Census while the census is still being loaded
+  Usage          : One thread calls insert_tree for every Tree and publish() 
+                   when it is done. Any number of other threads call the 
+                   query methods at the same time
+  Build with     : g++ -c -std=c++11 -pthread concurrent_collection.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "concurrent_collection.h"
+#include "trace.h"
+#include <iostream>
+
+ConcurrentTreeCollection::ConcurrentTreeCollection(int publish_interval)
+    : trees_(), species_(new SpeciesRegistry), species_shared_(false),
+      species_by_borough_(new GroupBy(0, BY_BOROUGH)),
+      species_by_zip_(new GroupBy(0, BY_ZIP)), views_shared_(false),
+      publish_interval_(publish_interval), unpublished_(0), published_(nullptr),
+      versions_published_(0), finished_(false)
+{
+	trees_by_borough_.fill(0);
+	duplicates_by_borough_.fill(0);
+	publish();
+}
+
+ConcurrentTreeCollection::~ConcurrentTreeCollection()
+{
+	//	the EpochManager deletes the retired versions when it is destroyed
+	delete published_.load();
+}
+
+void ConcurrentTreeCollection::insert_tree(const Tree& tree) {
+	Tree new_tree(tree);
+	new_tree.set_species_id(add_species_id(tree.common_name()));
+	if (trees_.insert(new_tree)) {
+		unshare_views();
+		species_by_borough_->add(new_tree);
+		species_by_zip_->add(new_tree);
+	} else {
+		++duplicates_by_borough_[new_tree.borough()];
+		++duplicates_by_borough_[ALLBOROS];
+	}
+	++trees_by_borough_[new_tree.borough()];
+	++trees_by_borough_[ALLBOROS];
+	if (++unpublished_ >= publish_interval_) {
+		publish();
+	}
+}
+
+StreetDictionary& ConcurrentTreeCollection::streets() {
+	return streets_;
+}
+
+void ConcurrentTreeCollection::publish() {
+	const CollectionVersion* version = 
+	    new CollectionVersion(trees_.snapshot(), trees_by_borough_, 
+	                          duplicates_by_borough_, species_, 
+	                          species_by_borough_, species_by_zip_);
+	species_shared_ = true;
+	views_shared_ = true;
+	unpublished_ = 0;
+	const CollectionVersion* old_version = published_.exchange(version);
+	++versions_published_;
+	if (old_version != nullptr) {
+		epochs_.retire([old_version]() { delete old_version; });
+	}
+	epochs_.reclaim();
+}
+
+void ConcurrentTreeCollection::finish() {
+	publish();
+	finished_ = true;
+}
+
+bool ConcurrentTreeCollection::finished() const {
+	return finished_;
+}
+
+int ConcurrentTreeCollection::versions_published() const {
+	return versions_published_;
+}
+
+int ConcurrentTreeCollection::total_tree_count() const {
+	EpochGuard guard(epochs_);
+	return published_.load()->trees_by_borough[ALLBOROS];
+}
+
+void ConcurrentTreeCollection::tree_info(const std::string& partial_name)
+                                         const {
+	EpochGuard guard(epochs_);
+	const CollectionVersion* version = published_.load();
+	const std::map<std::string, int>& species_ids = version->species->species_ids;
+
+	string_list matches;
+	if (partial_name == " ") {
+		matches.push_back("");
+	} else {
+		TraceSpan span("get_matching_species");
+		matches = version->species->all_species.get_matching_species(partial_name);
+		if (matches.empty()) {
+			std::cout << "No " << partial_name << " trees were found." << std::endl;
+			std::cout << std::endl;
+			return;
+		}
+	}
+
+	std::array<double, 6> totals = {{0, 0, 0, 0, 0, 0}};
+	for (auto it = matches.begin(); it != matches.end(); ++it) {
+		int id = TreeCollection::matching_species_id(*it, species_ids);
+		if (id < 0) {
+			continue;
+		}
+		for (int b = MANHATTAN; b <= STATEN; ++b) {
+			totals[b] += version->species_by_borough->count(id, b);
+		}
+		totals[ALLBOROS] += version->species_by_borough->species_total(id);
+	}
+	TreeCollection::print_frequencies(partial_name, matches, totals,
+	                                  version->trees_by_borough);
+}
+
+void ConcurrentTreeCollection::list_all_names() const {
+	EpochGuard guard(epochs_);
+	published_.load()->species->all_species.print_all_species(std::cout);
+	std::cout << std::endl;
+}
+
+void ConcurrentTreeCollection::list_all_in_zip(int& zipcode) const {
+	EpochGuard guard(epochs_);
+	const CollectionVersion* version = published_.load();
+	TreeCollection::print_zip_counts(zipcode, *version->species_by_zip,
+	                                 version->species_by_zip->slot_of(zipcode),
+	                                 version->species->species_ids);
+}
+
+void ConcurrentTreeCollection::list_all_near(double& latitude, 
+                                             double& longitude,
+                                             double& distance) const {
+	EpochGuard guard(epochs_);
+	const CollectionVersion* version = published_.load();
+	GroupBy nearby(version->species->species_ids.size(), BY_SPECIES);
+	version->trees.group_nearby(latitude, longitude, distance, nearby);
+	TreeCollection::print_near_counts(latitude, longitude, distance, nearby,
+	                                  version->species->species_ids);
+}
+
+//	the whole batch is answered from one version, as if the commands had run 
+//	before the next one was published
+void ConcurrentTreeCollection::list_all_near_batch(
+    const std::vector<NearbyQuery>& queries) const {
+	EpochGuard guard(epochs_);
+	const CollectionVersion* version = published_.load();
+	NearbyBatch batch(queries);
+	std::vector<GroupBy> nearby(queries.size(), 
+	    GroupBy(version->species->species_ids.size(), BY_SPECIES));
+	group_nearby_batch(version->trees, batch, nearby);
+	for (unsigned int q = 0; q < queries.size(); ++q) {
+		TreeCollection::print_near_counts(queries[q].latitude, 
+		                                  queries[q].longitude,
+		                                  queries[q].distance, nearby[q],
+		                                  version->species->species_ids);
+	}
+}
+
+void ConcurrentTreeCollection::list_in_corridor(const Corridor& corridor)
+    const {
+	EpochGuard guard(epochs_);
+	const CollectionVersion* version = published_.load();
+	GroupBy found(version->species->species_ids.size(), BY_SPECIES);
+	group_in_corridor(version->trees, corridor, found);
+	TreeCollection::print_corridor_counts(corridor, found,
+	                                      version->species->species_ids);
+}
+
+void ConcurrentTreeCollection::rollup(GroupKey key) const {
+	EpochGuard guard(epochs_);
+	const CollectionVersion* version = published_.load();
+	GroupBy groups(version->species->species_ids.size(), key);
+	version->trees.group_all(groups);
+	TreeCollection::print_rollup(groups, version->species->species_ids);
+}
+
+void ConcurrentTreeCollection::print_trees(int first, int last) const {
+	EpochGuard guard(epochs_);
+	const CollectionVersion* version = published_.load();
+	int number_of_trees = version->trees.get_number_of_trees();
+	if (first < 0) {
+		first = 0;
+	}
+	if (number_of_trees < last) {
+		last = number_of_trees;
+	}
+	if (last <= first) {
+		std::cout << "No trees found from " << first << " to " << last;
+		std::cout << std::endl << std::endl;
+		return;
+	}
+	std::cout << "Trees " << first << " to " << last - 1 << " of ";
+	std::cout << number_of_trees << ":" << std::endl;
+	version->trees.print(std::cout, first, last);
+	std::cout.copyfmt(std::ios(nullptr));
+	std::cout << std::endl;
+}
+
+bool ConcurrentTreeCollection::verify() const {
+	EpochGuard guard(epochs_);
+	const CollectionVersion* version = published_.load();
+	int number_of_species = version->species->species_ids.size();
+	GroupBy by_borough(number_of_species, BY_BOROUGH);
+	GroupBy by_zip(number_of_species, BY_ZIP);
+	version->trees.group_all(by_borough);
+	version->trees.group_all(by_zip);
+	return TreeCollection::verify_views(*version->species_by_borough, by_borough,
+	                                    *version->species_by_zip, by_zip,
+	                                    version->trees_by_borough,
+	                                    version->duplicates_by_borough,
+	                                    version->species->species_ids);
+}
+
+void ConcurrentTreeCollection::lookup(int tree_id) const {
+	std::cout << "lookup " << tree_id << " is not available while streaming";
+	std::cout << std::endl << std::endl;
+}
+
+void ConcurrentTreeCollection::remove(int tree_id) {
+	std::cout << "remove " << tree_id << " is not available while streaming";
+	std::cout << std::endl << std::endl;
+}
+
+bool ConcurrentTreeCollection::reload(const std::string& file_name) {
+	std::cout << "reload " << file_name << " is not available while streaming";
+	std::cout << std::endl << std::endl;
+	return false;
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+int ConcurrentTreeCollection::add_species_id(const std::string& species_name) {
+	std::map<std::string, int>::iterator it = 
+	    species_->species_ids.find(species_name);
+	if (it != species_->species_ids.end()) {
+		return it->second;
+	}
+	//	a published version may be reading the registry, so change a copy
+	if (species_shared_) {
+		species_ = std::make_shared<SpeciesRegistry>(*species_);
+		species_shared_ = false;
+	}
+	int id = species_->species_ids.size();
+	species_->species_ids[species_name] = id;
+	species_->all_species.add_species(species_name);
+	unshare_views();
+	species_by_borough_->resize(id + 1);
+	species_by_zip_->resize(id + 1);
+	return id;
+}
+
+void ConcurrentTreeCollection::unshare_views() {
+	//	a published version may be reading the views, so change copies
+	if (views_shared_) {
+		species_by_borough_ = std::make_shared<GroupBy>(*species_by_borough_);
+		species_by_zip_ = std::make_shared<GroupBy>(*species_by_zip_);
+		views_shared_ = false;
+	}
+}
@@ -0,0 +1,173 @@
+/*******************************************************************************
+  Title          : concurrent_collection.h
+  Description    : The interface file for the ConcurrentTreeCollection class
+  Purpose        : To answer queries about the trees of the 2015 NYC Street 
+                   Tree Census while the census is still being loaded
+  Usage          : One thread calls insert_tree for every Tree and publish() 
+                   when it is done. Any number of other threads call the 
+                   query methods at the same time, and each query sees the 
+                   most recently published version of the collection
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __CONCURRENT_COLLECTION_H__
+#define __CONCURRENT_COLLECTION_H__
+
+#include "persistent_avl.h"
+#include "tree_collection.h"
+#include "tree_species.h"
+#include "group_by.h"
+#include "epoch.h"
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+
+/*******************************************************************************
+
+		The ConcurrentTreeCollection class answers the same queries as 
+		TreeCollection, with the same output, while one writer thread inserts 
+		Trees. The writer works on its own PersistentAVL, borough counts, species
+		registry and materialized views. Every publish_interval Trees, and when 
+		publish() is called, it puts copies of them into a new CollectionVersion 
+		and stores a pointer to it in one atomic pointer. Copying the 
+		PersistentAVL takes constant time because the version shares its nodes, 
+		and later inserts copy the nodes they change instead of changing them. 
+		The species registry is shared the same way and only copied when a Tree 
+		of a new species arrives. The views are shared the same way and only 
+		copied when the writer next changes them, so versions published with no 
+		change to the views in between share one copy of them. Readers never take 
+		a lock: they enter the EpochManager, load the pointer and answer the 
+		whole query from that one version, so the Trees, borough counts, species 
+		and views they see always agree with each other. The version a pointer 
+		replaces is retired to the EpochManager and deleted once no reader can 
+		still be using it. Removing Trees is not supported while loading
+
+*******************************************************************************/
+
+//	The species names and species ids a CollectionVersion uses. It is shared 
+//	by every version that has the same species
+struct SpeciesRegistry {
+	TreeSpecies all_species;
+	std::map<std::string, int> species_ids;
+};
+
+//	Everything a query needs, as it was when the version was published. It is 
+//	never changed after it is published
+struct CollectionVersion {
+	PersistentAVL trees;
+	std::array<int, 6> trees_by_borough;
+	std::array<int, 6> duplicates_by_borough;
+	std::shared_ptr<const SpeciesRegistry> species;
+	std::shared_ptr<const GroupBy> species_by_borough;
+	std::shared_ptr<const GroupBy> species_by_zip;
+
+	CollectionVersion(const PersistentAVL& some_trees,
+	                  const std::array<int, 6>& some_trees_by_borough,
+	                  const std::array<int, 6>& some_duplicates_by_borough,
+	                  const std::shared_ptr<const SpeciesRegistry>& some_species,
+	                  const std::shared_ptr<const GroupBy>& some_by_borough,
+	                  const std::shared_ptr<const GroupBy>& some_by_zip)
+	    : trees(some_trees), trees_by_borough(some_trees_by_borough),
+	      duplicates_by_borough(some_duplicates_by_borough),
+	      species(some_species), species_by_borough(some_by_borough),
+	      species_by_zip(some_by_zip) {
+	}
+};
+
+//	The default number of Trees inserted between two published versions
+const int kPublishInterval = 4096;
+
+class ConcurrentTreeCollection {
+ public:
+	//	Creates an empty ConcurrentTreeCollection object that publishes a new 
+	//	version every publish_interval Trees
+	explicit ConcurrentTreeCollection(int publish_interval = kPublishInterval);
+
+	//	Deletes every version. No reader may be using the object
+	~ConcurrentTreeCollection();
+
+	//	Adds the given tree, whose street must be in streets(). Only the writer
+	//	thread may call this method
+	void insert_tree(const Tree& tree);
+
+	//	Returns the StreetDictionary the writer thread parses the streets of 
+	//	the Trees it inserts into. Readers never look at it, they only read a
+	//	street through the Tree that points to it
+	StreetDictionary& streets();
+
+	//	Makes everything inserted so far visible to readers and deletes the old 
+	//	versions no reader is using. Only the writer thread may call this method
+	void publish();
+
+	//	Marks the collection as completely loaded and publishes it
+	void finish();
+
+	//	Returns true once finish() has been called
+	bool finished() const;
+
+	//	Returns the number of versions that have been published
+	int versions_published() const;
+
+	//	Returns the number of Trees in the published version
+	int total_tree_count() const;
+
+	//	These methods output exactly what the TreeCollection methods with the 
+	//	same names output, for the published version
+	void tree_info(const std::string& partial_name) const;
+	void list_all_names() const;
+	void list_all_in_zip(int& zipcode) const;
+	void list_all_near(double& latitude, double& longitude, double& distance)
+	                   const;
+	void list_all_near_batch(const std::vector<NearbyQuery>& queries) const;
+	void list_in_corridor(const Corridor& corridor) const;
+	void rollup(GroupKey key) const;
+	void print_trees(int first, int last) const;
+	bool verify() const;
+
+	//	Output that these commands are not available while loading
+	void lookup(int tree_id) const;
+	void remove(int tree_id);
+	bool reload(const std::string& file_name);
+
+ protected:
+	//	Returns the species id of species_name, giving it a new one if it does 
+	//	not have one yet. Copies the species registry first if a published 
+	//	version shares it
+	int add_species_id(const std::string& species_name);
+
+	//	Copies the views before the writer changes them if a published version 
+	//	shares them
+	void unshare_views();
+
+ private:
+	ConcurrentTreeCollection(const ConcurrentTreeCollection&);
+	ConcurrentTreeCollection& operator=(const ConcurrentTreeCollection&);
+
+	//	The writer's state, which readers never look at
+	StreetDictionary streets_;
+	PersistentAVL trees_;
+	std::array<int, 6> trees_by_borough_;
+	std::array<int, 6> duplicates_by_borough_;
+	std::shared_ptr<SpeciesRegistry> species_;
+	bool species_shared_;
+	std::shared_ptr<GroupBy> species_by_borough_;
+	std::shared_ptr<GroupBy> species_by_zip_;
+	bool views_shared_;
+	int publish_interval_;
+	int unpublished_;
+
+	//	The version readers use
+	std::atomic<const CollectionVersion*> published_;
+	std::atomic<int> versions_published_;
+	std::atomic<bool> finished_;
+
+	//	Deletes versions that have been replaced once readers are done with them
+	mutable EpochManager epochs_;
+};
+
+#endif
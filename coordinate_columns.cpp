@@ -0,0 +1,425 @@
+/*******************************************************************************
+  Title          : coordinate_columns.cpp
+  Description    : The implementation file for the CoordinateColumns class
+  Purpose        : To find the trees that may be near a point, or that are in
+                   a zipcode, by scanning compact integer columns of their 
+                   coordinates and zipcodes instead of visiting every tree
+  Usage          : Used by AVL_Tree next to its FrozenIndex
+  Build with     : g++ -c -std=c++11 coordinate_columns.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "coordinate_columns.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+//	The radius of the Earth in kilometers that haversine uses
+const double kEarthRadius = 6372.8;
+
+const double kPi = 3.14159265358979323846;
+
+//	How much bigger than the circle the box is made, so that rounding in the
+//	box and in haversine never leaves out a Tree that is within the distance
+const double kBoxMargin = 1.001;
+
+CoordinateColumns::CoordinateColumns() 
+    : built_(false), hilbert_order_(false), on_globe_(true) {
+}
+
+bool CoordinateColumns::built() const {
+	return built_;
+}
+
+void CoordinateColumns::build(const FrozenIndex& frozen, bool hilbert_order) {
+	clear();
+	int size = frozen.size();
+	latitudes_.reserve(size);
+	longitudes_.reserve(size);
+	zipcodes_.reserve(size);
+	double latitude, longitude;
+	for (int i = 0; i < size; ++i) {
+		const Tree& tree = frozen.row(i)->data;
+		tree.get_position(latitude, longitude);
+		latitudes_.push_back(to_fixed(latitude, kOriginLatitude));
+		longitudes_.push_back(to_fixed(longitude, kOriginLongitude));
+		zipcodes_.push_back(tree.zip());
+		if (90 < std::fabs(latitude) || 180 < std::fabs(longitude)) {
+			on_globe_ = false;
+		}
+	}
+	hilbert_order_ = hilbert_order && 0 < size;
+	if (hilbert_order_) {
+		//	scale the box around every Tree to the square of the curve
+		long long latitude_low = *std::min_element(latitudes_.begin(), 
+		                                           latitudes_.end());
+		long long longitude_low = *std::min_element(longitudes_.begin(), 
+		                                            longitudes_.end());
+		long long height = *std::max_element(latitudes_.begin(), 
+		                                     latitudes_.end()) - latitude_low;
+		long long width = *std::max_element(longitudes_.begin(), 
+		                                    longitudes_.end()) - longitude_low;
+		std::vector<std::pair<unsigned int, int> > order(size);
+		for (int i = 0; i < size; ++i) {
+			unsigned int x = 0 == width ? 0 :
+			                 (longitudes_[i] - longitude_low) * 65535 / width;
+			unsigned int y = 0 == height ? 0 :
+			                 (latitudes_[i] - latitude_low) * 65535 / height;
+			order[i] = std::make_pair(hilbert_index(x, y), i);
+		}
+		std::sort(order.begin(), order.end());
+		std::vector<int> latitudes(size), longitudes(size), zipcodes(size);
+		ranks_.resize(size);
+		for (int i = 0; i < size; ++i) {
+			int rank = order[i].second;
+			ranks_[i] = rank;
+			latitudes[i] = latitudes_[rank];
+			longitudes[i] = longitudes_[rank];
+			zipcodes[i] = zipcodes_[rank];
+		}
+		latitudes_.swap(latitudes);
+		longitudes_.swap(longitudes);
+		zipcodes_.swap(zipcodes);
+	}
+	build_blocks();
+	built_ = true;
+}
+
+bool CoordinateColumns::hilbert_order() const {
+	return hilbert_order_;
+}
+
+void CoordinateColumns::clear() {
+	std::vector<int>().swap(latitudes_);
+	std::vector<int>().swap(longitudes_);
+	std::vector<int>().swap(zipcodes_);
+	std::vector<int>().swap(ranks_);
+	std::vector<ColumnBlock>().swap(blocks_);
+	built_ = false;
+	hilbert_order_ = false;
+	on_globe_ = true;
+}
+
+long long CoordinateColumns::candidates(double latitude, double longitude, 
+                                        double distance, 
+                                        std::vector<int>& ranks) const {
+	return candidates(latitude, longitude, distance, 0, blocks_.size(), ranks);
+}
+
+long long CoordinateColumns::candidates(double latitude, double longitude, 
+                                        double distance, int first_block, 
+                                        int last_block, 
+                                        std::vector<int>& ranks) const {
+	CoordinateBox box;
+	if (!bounding_box(latitude, longitude, distance, box)) {
+		return 0;
+	}
+	last_block = std::min<int>(last_block, blocks_.size());
+	std::vector<int> rows;
+	long long rows_read = 0;
+	for (int b = first_block; b < last_block; ++b) {
+		int first = b * kColumnBlockRows;
+		int last = std::min<int>(first + kColumnBlockRows, latitudes_.size());
+		const CoordinateBox& block = blocks_[b].box;
+		if (!on_globe_) {
+			//	haversine wraps around, so a box cannot leave anything out
+			for (int i = first; i < last; ++i) {
+				rows.push_back(i);
+			}
+		} else if (block.latitude_high < box.latitude_low || 
+		           box.latitude_high < block.latitude_low ||
+		           block.longitude_high < box.longitude_low ||
+		           box.longitude_high < block.longitude_low) {
+			continue;
+		} else {
+			scan(first, last, box, rows);
+		}
+		rows_read += last - first;
+	}
+	rows_to_ranks(rows);
+	ranks.insert(ranks.end(), rows.begin(), rows.end());
+	return rows_read;
+}
+
+//	a block that meets one of the boxes is scanned with it, and a block that
+//	meets more has all of its rows added, since scanning it once for each box
+//	costs more than the checks of the extra rows. The boxes of a batch of 
+//	list_near circles nearly all meet every block when the rows are in rank
+//	order
+long long CoordinateColumns::candidates(const std::vector<CoordinateBox>& 
+                                        boxes, std::vector<int>& ranks) const {
+	if (boxes.empty()) {
+		return 0;
+	}
+	std::vector<int> rows;
+	if (!on_globe_) {
+		for (unsigned int i = 0; i < latitudes_.size(); ++i) {
+			rows.push_back(i);
+		}
+		rows_to_ranks(rows);
+		ranks.insert(ranks.end(), rows.begin(), rows.end());
+		return latitudes_.size();
+	}
+	long long rows_read = 0;
+	for (unsigned int b = 0; b < blocks_.size(); ++b) {
+		const CoordinateBox& block = blocks_[b].box;
+		int first = b * kColumnBlockRows;
+		int last = std::min<int>(first + kColumnBlockRows, latitudes_.size());
+		int boxes_met = 0;
+		const CoordinateBox* met = nullptr;
+		for (unsigned int i = 0; i < boxes.size() && boxes_met < 2; ++i) {
+			const CoordinateBox& box = boxes[i];
+			if (block.latitude_high < box.latitude_low || 
+			    box.latitude_high < block.latitude_low ||
+			    block.longitude_high < box.longitude_low ||
+			    box.longitude_high < block.longitude_low) {
+				continue;
+			}
+			met = &box;
+			++boxes_met;
+		}
+		if (1 == boxes_met) {
+			scan(first, last, *met, rows);
+		} else if (1 < boxes_met) {
+			for (int i = first; i < last; ++i) {
+				rows.push_back(i);
+			}
+		}
+		if (0 < boxes_met) {
+			rows_read += last - first;
+		}
+	}
+	rows_to_ranks(rows);
+	ranks.insert(ranks.end(), rows.begin(), rows.end());
+	return rows_read;
+}
+
+long long CoordinateColumns::in_zipcode(int zipcode, 
+                                        std::vector<int>& ranks) const {
+	return in_zipcode(zipcode, 0, blocks_.size(), ranks);
+}
+
+long long CoordinateColumns::in_zipcode(int zipcode, int first_block, 
+                                        int last_block, 
+                                        std::vector<int>& ranks) const {
+	last_block = std::min<int>(last_block, blocks_.size());
+	std::vector<int> rows;
+	long long rows_read = 0;
+	for (int b = first_block; b < last_block; ++b) {
+		if (zipcode < blocks_[b].zip_low || blocks_[b].zip_high < zipcode) {
+			continue;
+		}
+		int first = b * kColumnBlockRows;
+		int last = std::min<int>(first + kColumnBlockRows, zipcodes_.size());
+		for (int i = first; i < last; ++i) {
+			if (zipcode == zipcodes_[i]) {
+				rows.push_back(i);
+			}
+		}
+		rows_read += last - first;
+	}
+	rows_to_ranks(rows);
+	ranks.insert(ranks.end(), rows.begin(), rows.end());
+	return rows_read;
+}
+
+int CoordinateColumns::number_of_blocks() const {
+	return blocks_.size();
+}
+
+int CoordinateColumns::rank(int i) const {
+	return ranks_.empty() ? i : ranks_[i];
+}
+
+int CoordinateColumns::to_fixed(double degrees, double origin) {
+	double units = std::round((degrees - origin) * kUnitsPerDegree);
+	//	leave room for a box, and the compares of scan, to go 2 units past 
+	//	any coordinate
+	if (!(units < INT_MAX - 2)) {
+		return INT_MAX - 2;
+	} else if (!(units > INT_MIN + 2)) {
+		return INT_MIN + 2;
+	}
+	return static_cast<int>(units);
+}
+
+double CoordinateColumns::to_degrees(int fixed, double origin) {
+	return origin + fixed / kUnitsPerDegree;
+}
+
+MemoryUsage CoordinateColumns::memory_usage() const {
+	MemoryUsage usage = vector_usage(latitudes_);
+	usage += vector_usage(longitudes_);
+	usage += vector_usage(zipcodes_);
+	usage += vector_usage(ranks_);
+	usage += vector_usage(blocks_);
+	return usage;
+}
+
+bool CoordinateColumns::bounding_box(double latitude, double longitude, 
+                                     double distance, CoordinateBox& box) {
+	//	haversine is never less than 0, and comparisons with NaN are false
+	if (!(0 <= distance)) {
+		return false;
+	}
+	box.latitude_low = INT_MIN + 1;
+	box.latitude_high = INT_MAX - 1;
+	box.longitude_low = INT_MIN + 1;
+	box.longitude_high = INT_MAX - 1;
+	//	a point within distance is never more than distance / R radians of 
+	//	latitude away
+	double angle = distance / kEarthRadius * kBoxMargin;
+	double degrees = angle * 180 / kPi;
+	if (!(degrees < 180) || !(std::fabs(latitude) <= 90)) {
+		return true;
+	}
+	box.latitude_low = to_fixed(latitude - degrees, kOriginLatitude) - 1;
+	box.latitude_high = to_fixed(latitude + degrees, kOriginLatitude) + 1;
+	//	nor more than asin(sin(angle) / cos(latitude)) of longitude away, unless
+	//	the circle reaches a pole
+	double cosine = std::cos(latitude * kPi / 180);
+	if (90 <= std::fabs(latitude) + degrees || 
+	    !(std::sin(angle) < cosine)) {
+		return true;
+	}
+	double longitude_degrees = std::asin(std::sin(angle) / cosine) * 180 / kPi
+	                           * kBoxMargin;
+	//	a box that crosses the 180th meridian would leave out its other side
+	if (180 < std::fabs(longitude) + longitude_degrees) {
+		return true;
+	}
+	box.longitude_low = to_fixed(longitude - longitude_degrees, 
+	                             kOriginLongitude) - 1;
+	box.longitude_high = to_fixed(longitude + longitude_degrees, 
+	                              kOriginLongitude) + 1;
+	return true;
+}
+
+//	the box around the circles at the ends of a segment also holds the 
+//	circles around the points between them, which are no nearer a pole
+void CoordinateColumns::corridor_boxes(const Corridor& corridor, 
+                                       std::vector<CoordinateBox>& boxes) {
+	const std::vector<CorridorPoint>& points = corridor.points();
+	CoordinateBox start, end;
+	for (unsigned int i = 0; i < points.size(); ++i) {
+		if (!bounding_box(points[i].latitude, points[i].longitude, 
+		                  corridor.distance(), end)) {
+			return;
+		}
+		if (0 == i) {
+			if (1 == points.size()) {
+				boxes.push_back(end);
+			}
+		} else {
+			CoordinateBox box;
+			box.latitude_low = std::min(start.latitude_low, end.latitude_low);
+			box.latitude_high = std::max(start.latitude_high, end.latitude_high);
+			box.longitude_low = std::min(start.longitude_low, end.longitude_low);
+			box.longitude_high = std::max(start.longitude_high, 
+			                              end.longitude_high);
+			boxes.push_back(box);
+		}
+		start = end;
+	}
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+void CoordinateColumns::scan(int first, int last, const CoordinateBox& box,
+                             std::vector<int>& rows) const {
+	const int* latitudes = latitudes_.data();
+	const int* longitudes = longitudes_.data();
+	int i = first;
+#ifdef __SSE2__
+	//	SSE2 only compares for greater and less than, so the edges are moved 
+	//	out by one, which to_fixed left room for
+	const __m128i latitude_below = _mm_set1_epi32(box.latitude_low - 1);
+	const __m128i latitude_above = _mm_set1_epi32(box.latitude_high + 1);
+	const __m128i longitude_below = _mm_set1_epi32(box.longitude_low - 1);
+	const __m128i longitude_above = _mm_set1_epi32(box.longitude_high + 1);
+	for (; i + 4 <= last; i += 4) {
+		__m128i lat = _mm_loadu_si128(
+		    reinterpret_cast<const __m128i*>(latitudes + i));
+		__m128i lon = _mm_loadu_si128(
+		    reinterpret_cast<const __m128i*>(longitudes + i));
+		__m128i inside = _mm_and_si128(
+		    _mm_and_si128(_mm_cmpgt_epi32(lat, latitude_below),
+		                  _mm_cmplt_epi32(lat, latitude_above)),
+		    _mm_and_si128(_mm_cmpgt_epi32(lon, longitude_below),
+		                  _mm_cmplt_epi32(lon, longitude_above)));
+		int mask = _mm_movemask_ps(_mm_castsi128_ps(inside));
+		for (int lane = 0; mask != 0; ++lane, mask >>= 1) {
+			if (mask & 1) {
+				rows.push_back(i + lane);
+			}
+		}
+	}
+#endif
+	for (; i < last; ++i) {
+		if (box.latitude_low <= latitudes[i] && latitudes[i] <= box.latitude_high &&
+		    box.longitude_low <= longitudes[i] && 
+		    longitudes[i] <= box.longitude_high) {
+			rows.push_back(i);
+		}
+	}
+}
+
+void CoordinateColumns::rows_to_ranks(std::vector<int>& rows) const {
+	if (ranks_.empty()) {
+		return;
+	}
+	for (unsigned int i = 0; i < rows.size(); ++i) {
+		rows[i] = ranks_[rows[i]];
+	}
+	std::sort(rows.begin(), rows.end());
+}
+
+//	the iterative form of the curve, which turns each quadrant so that the 
+//	curve inside it starts next to where the curve in the last one ended
+unsigned int CoordinateColumns::hilbert_index(unsigned int x, unsigned int y) {
+	unsigned int index = 0;
+	for (unsigned int s = 1 << 15; s > 0; s >>= 1) {
+		unsigned int right = (x & s) > 0;
+		unsigned int top = (y & s) > 0;
+		index += s * s * ((3 * right) ^ top);
+		if (0 == top) {
+			if (1 == right) {
+				x = s - 1 - x;
+				y = s - 1 - y;
+			}
+			unsigned int swap = x;
+			x = y;
+			y = swap;
+		}
+	}
+	return index;
+}
+
+void CoordinateColumns::build_blocks() {
+	int size = latitudes_.size();
+	for (int first = 0; first < size; first += kColumnBlockRows) {
+		int last = std::min(first + kColumnBlockRows, size);
+		ColumnBlock block;
+		CoordinateBox& box = block.box;
+		box.latitude_low = box.latitude_high = latitudes_[first];
+		box.longitude_low = box.longitude_high = longitudes_[first];
+		block.zip_low = block.zip_high = zipcodes_[first];
+		for (int i = first + 1; i < last; ++i) {
+			box.latitude_low = std::min(box.latitude_low, latitudes_[i]);
+			box.latitude_high = std::max(box.latitude_high, latitudes_[i]);
+			box.longitude_low = std::min(box.longitude_low, longitudes_[i]);
+			box.longitude_high = std::max(box.longitude_high, longitudes_[i]);
+			block.zip_low = std::min(block.zip_low, zipcodes_[i]);
+			block.zip_high = std::max(block.zip_high, zipcodes_[i]);
+		}
+		blocks_.push_back(block);
+	}
+}
@@ -0,0 +1,187 @@
+/*******************************************************************************
+  Title          : coordinate_columns.h
+  Description    : The interface file for the CoordinateColumns class
+  Purpose        : To find the trees that may be near a point, or that are in
+                   a zipcode, by scanning compact integer columns of their 
+                   coordinates and zipcodes instead of visiting every tree
+  Usage          : Used by AVL_Tree next to its FrozenIndex
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __COORDINATE_COLUMNS_H__
+#define __COORDINATE_COLUMNS_H__
+
+#include "corridor.h"
+#include "frozen_index.h"
+#include "memory_stats.h"
+#include <vector>
+
+//	The point that fixed-point coordinates are offsets from, which is in the 
+//	middle of New York City
+const double kOriginLatitude = 40.7;
+const double kOriginLongitude = -73.95;
+
+//	The number of fixed-point units in a degree. A unit is about 1.1 cm of 
+//	latitude and 0.85 cm of longitude in New York City, and an int covers 
+//	more than the whole globe
+const double kUnitsPerDegree = 1e7;
+
+//	The number of rows in a block of the columns. A block whose box or range
+//	of zipcodes cannot hold a match is skipped without reading its rows
+const int kColumnBlockRows = 64;
+
+//	A box of fixed-point coordinates, including its edges
+struct CoordinateBox {
+	int latitude_low;
+	int latitude_high;
+	int longitude_low;
+	int longitude_high;
+};
+
+//	The box around the coordinates and the lowest and highest zipcode of the 
+//	rows of a block
+struct ColumnBlock {
+	CoordinateBox box;
+	int zip_low;
+	int zip_high;
+};
+
+/*******************************************************************************
+
+		The CoordinateColumns class stores the latitude and longitude of every 
+		Tree of a FrozenIndex as int offsets from kOriginLatitude and 
+		kOriginLongitude, and its zipcode, in three arrays. That is 8 bytes of 
+		coordinates a Tree in two contiguous arrays instead of 16 bytes inside 
+		each BinaryNode. To find the Trees within a distance of a point, 
+		candidates compares the coordinates with a box around the circle, 4 at
+		a time with SSE2 where it is available, and only the Trees inside the 
+		box need the exact haversine check, which uses the Tree's own doubles 
+		so that the results are exactly those of a full scan. 
+		
+		The rows are split into blocks of kColumnBlockRows, and a block whose 
+		box does not meet the circle's box, or whose zipcodes do not include 
+		the one searched for, is skipped. In the order of the Trees' ranks, 
+		which is by species, nearly every block spans the whole city, so the 
+		rows can instead be put in the order of a Hilbert curve through their 
+		coordinates, which keeps Trees that are close together in the same 
+		blocks. The rank of each row is then kept, to find its Tree in the 
+		FrozenIndex, and the ranks found are sorted before they are returned
+
+*******************************************************************************/
+
+class CoordinateColumns {
+ public:
+	//	Creates an empty CoordinateColumns object, which is not built
+	CoordinateColumns();
+
+	//	Returns true if build was called since the last clear
+	bool built() const;
+
+	//	Makes the columns hold the coordinates and zipcodes of the Trees of 
+	//	frozen, which must be built, in the order of their ranks, or along a 
+	//	Hilbert curve if hilbert_order is true
+	void build(const FrozenIndex& frozen, bool hilbert_order);
+
+	//	Returns true if the rows are in the order of a Hilbert curve
+	bool hilbert_order() const;
+
+	//	Removes every coordinate, so the CoordinateColumns is no longer built
+	void clear();
+
+	//	Adds to ranks, in increasing order, the ranks of the Trees that may be
+	//	within distance kilometers of (latitude, longitude). Every Tree that is
+	//	within the distance is added, but others close to it may be too
+	//	Returns the number of rows read
+	long long candidates(double latitude, double longitude, double distance,
+	                     std::vector<int>& ranks) const;
+
+	//	Does the same as the method above, but only reads the blocks from 
+	//	first_block up to but not including last_block, so that a search can be
+	//	split into pieces
+	long long candidates(double latitude, double longitude, double distance,
+	                     int first_block, int last_block, 
+	                     std::vector<int>& ranks) const;
+
+	//	Adds to ranks, in increasing order and once each, the ranks of the 
+	//	Trees that may be inside one of boxes. Every Tree inside one is added, 
+	//	but others close to them may be too. Returns the number of rows read
+	long long candidates(const std::vector<CoordinateBox>& boxes, 
+	                     std::vector<int>& ranks) const;
+
+	//	Adds to ranks, in increasing order, the ranks of the Trees in zipcode
+	//	Returns the number of rows read
+	long long in_zipcode(int zipcode, std::vector<int>& ranks) const;
+
+	//	Does the same as the method above, but only reads the blocks from 
+	//	first_block up to but not including last_block
+	long long in_zipcode(int zipcode, int first_block, int last_block, 
+	                     std::vector<int>& ranks) const;
+
+	//	Returns the number of blocks of kColumnBlockRows rows
+	int number_of_blocks() const;
+
+	//	Returns the rank of the Tree in row i
+	int rank(int i) const;
+
+	//	Returns degrees as a number of fixed-point units from origin
+	static int to_fixed(double degrees, double origin);
+
+	//	Returns fixed, a number of fixed-point units from origin, in degrees
+	static double to_degrees(int fixed, double origin);
+
+	//	Returns the memory used by the columns
+	MemoryUsage memory_usage() const;
+
+	//	Sets box to a box that holds every point within distance kilometers of
+	//	(latitude, longitude). Returns false if no point is within distance
+	static bool bounding_box(double latitude, double longitude, 
+	                         double distance, CoordinateBox& box);
+
+	//	Adds to boxes a box around each segment of corridor, or around its 
+	//	point if it has only one. Adds nothing if no point is within its 
+	//	distance
+	static void corridor_boxes(const Corridor& corridor, 
+	                           std::vector<CoordinateBox>& boxes);
+
+ protected:
+
+	//	Adds to rows the rows from first up to last whose coordinates are 
+	//	inside box
+	void scan(int first, int last, const CoordinateBox& box,
+	          std::vector<int>& rows) const;
+
+	//	Replaces each row in rows with its rank, in increasing order
+	void rows_to_ranks(std::vector<int>& rows) const;
+
+	//	Returns the position of (x, y) along a Hilbert curve through a square 
+	//	of 65536 by 65536 points
+	static unsigned int hilbert_index(unsigned int x, unsigned int y);
+
+	//	Makes the box and zipcode range of every block
+	void build_blocks();
+
+ private:
+	//	The fixed-point latitude and longitude and the zipcode of the Tree of 
+	//	each row
+	std::vector<int> latitudes_;
+	std::vector<int> longitudes_;
+	std::vector<int> zipcodes_;
+
+	//	The rank of the Tree of each row, or nothing if the rows are in the 
+	//	order of the ranks
+	std::vector<int> ranks_;
+
+	std::vector<ColumnBlock> blocks_;
+
+	bool built_;
+	bool hilbert_order_;
+
+	//	False if a coordinate is outside -90 to 90 degrees of latitude or -180
+	//	to 180 degrees of longitude, where boxes do not work
+	bool on_globe_;
+};
+
+#endif
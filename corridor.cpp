@@ -0,0 +1,77 @@
+/*******************************************************************************
+  Title          : corridor.cpp
+  Description    : The implementation file for the Corridor class
+  Purpose        : To describe the strip of land within a distance of a path,
+                   like a street, so that the trees along it can be found in
+                   one search
+  Usage          : Make a Corridor from the points of the path and the
+                   distance, and ask it whether it contains a point
+  Build with     : g++ -c -std=c++11 corridor.cpp
+  Modifications  :
+
+*******************************************************************************/
+
+#include "corridor.h"
+#include "haversine.h"
+#include <cmath>
+
+const double kPi = 3.14159265358979323846;
+
+Corridor::Corridor(const std::vector<CorridorPoint>& points, double distance)
+    : points_(points), distance_(distance) {
+}
+
+const std::vector<CorridorPoint>& Corridor::points() const {
+	return points_;
+}
+
+double Corridor::distance() const {
+	return distance_;
+}
+
+bool Corridor::contains(double latitude, double longitude) const {
+	if (1 == points_.size()) {
+		return distance_ >= segment_distance(points_[0], points_[0], latitude,
+		                                     longitude);
+	}
+	for (unsigned int i = 1; i < points_.size(); ++i) {
+		if (distance_ >= segment_distance(points_[i - 1], points_[i], latitude,
+		                                  longitude)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+double Corridor::segment_distance(const CorridorPoint& start,
+                                  const CorridorPoint& end, double latitude,
+                                  double longitude) {
+	double scale = std::cos((start.latitude + end.latitude) / 2 * kPi / 180);
+	double segment_x = (end.longitude - start.longitude) * scale;
+	double segment_y = end.latitude - start.latitude;
+	double point_x = (longitude - start.longitude) * scale;
+	double point_y = latitude - start.latitude;
+	double length_squared = segment_x * segment_x + segment_y * segment_y;
+	//	how far along the segment the closest point is, from 0 at start to 1
+	//	at end
+	double along = 0;
+	if (0 < length_squared) {
+		along = (point_x * segment_x + point_y * segment_y) / length_squared;
+	}
+	//	the ends are used as they are, so a path of one point measures exactly
+	//	what list_near does
+	if (!(0 < along)) {
+		return haversine(start.latitude, start.longitude, latitude, longitude);
+	} else if (!(along < 1)) {
+		return haversine(end.latitude, end.longitude, latitude, longitude);
+	}
+	return haversine(start.latitude + along * segment_y,
+	                 start.longitude + along * (end.longitude - start.longitude),
+	                 latitude, longitude);
+}
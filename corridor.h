@@ -0,0 +1,71 @@
+/*******************************************************************************
+  Title          : corridor.h
+  Description    : The interface file for the Corridor class
+  Purpose        : To describe the strip of land within a distance of a path,
+                   like a street, so that the trees along it can be found in
+                   one search
+  Usage          : Make a Corridor from the points of the path and the
+                   distance, and ask it whether it contains a point
+  Build with     : No building
+  Modifications  :
+
+*******************************************************************************/
+
+
+#ifndef __CORRIDOR_H__
+#define __CORRIDOR_H__
+
+#include <vector>
+
+//	A point of a path, in degrees
+struct CorridorPoint {
+	double latitude;
+	double longitude;
+};
+
+/*******************************************************************************
+
+		The Corridor class holds a path of one or more points, joined in order
+		by straight segments, and a distance in kilometers. A point is in the
+		Corridor if it is within the distance of some point of the path. The
+		closest point of a segment is found on a flat map of the segment's
+		latitudes, where a degree of longitude is shortened by the cosine of
+		the middle latitude, and the distance to it is then measured with
+		haversine. The segments are short enough for that to be exact to well
+		under a meter, and a path of one point is the circle that list_near
+		searches, with the same haversine distance. Segments are drawn between
+		the coordinates as they are given, so a path should not cross the 180th
+		meridian
+
+*******************************************************************************/
+
+class Corridor {
+ public:
+	//	Creates a Corridor of the points within distance kilometers of the path
+	//	through points
+	Corridor(const std::vector<CorridorPoint>& points, double distance);
+
+	//	Returns the points of the path, in order
+	const std::vector<CorridorPoint>& points() const;
+
+	//	Returns the distance in kilometers that the Corridor reaches from the
+	//	path
+	double distance() const;
+
+	//	Returns true if (latitude, longitude) is within distance() kilometers
+	//	of the path
+	bool contains(double latitude, double longitude) const;
+
+ protected:
+	//	Returns the distance in kilometers from (latitude, longitude) to the
+	//	closest point of the segment from start to end
+	static double segment_distance(const CorridorPoint& start,
+	                               const CorridorPoint& end, double latitude,
+	                               double longitude);
+
+ private:
+	std::vector<CorridorPoint> points_;
+	double distance_;
+};
+
+#endif
@@ -0,0 +1,99 @@
+/*******************************************************************************
+  Title          : epoch.cpp
+  Description    : The implementation file for the EpochManager and EpochGuard
+                   classes
+  Purpose        : To delete objects that readers on other threads may still 
+                   be using only after those readers are done with them
+  Usage          : Readers create an EpochGuard before loading a shared 
+                   pointer and keep it until they stop using what it points 
+                   to. The writer replaces the shared pointer and then gives 
+                   the old object to retire()
+  Build with     : g++ -c -std=c++11 epoch.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "epoch.h"
+#include <thread>
+
+EpochManager::EpochManager() : global_epoch_(1) {
+	for (int i = 0; i < kMaxReaders; ++i) {
+		reader_epochs_[i].store(0);
+	}
+}
+
+EpochManager::~EpochManager() {
+	for (unsigned int i = 0; i < retired_.size(); ++i) {
+		retired_[i].deleter();
+	}
+}
+
+//	all the atomic operations here are sequentially consistent. That is what
+//	guarantees that a reader whose slot holds an epoch greater than r loads the 
+//	pointer that replaced an object retired in epoch r, or a newer one
+int EpochManager::enter() {
+	while (true) {
+		for (int i = 0; i < kMaxReaders; ++i) {
+			unsigned long long expected = 0;
+			if (reader_epochs_[i].compare_exchange_strong(expected,
+																										global_epoch_.load())) {
+				return i;
+			}
+		}
+		std::this_thread::yield();
+	}
+}
+
+void EpochManager::exit(int slot) {
+	reader_epochs_[slot].store(0);
+}
+
+void EpochManager::retire(std::function<void()> deleter) {
+	Retired retired;
+	retired.epoch = global_epoch_.fetch_add(1);
+	retired.deleter = deleter;
+	std::lock_guard<std::mutex> lock(retired_mutex_);
+	retired_.push_back(retired);
+}
+
+int EpochManager::reclaim() {
+	//	find the oldest epoch a reader is still inside
+	unsigned long long oldest = global_epoch_.load();
+	for (int i = 0; i < kMaxReaders; ++i) {
+		unsigned long long epoch = reader_epochs_[i].load();
+		if (0 != epoch && epoch < oldest) {
+			oldest = epoch;
+		}
+	}
+	std::vector<Retired> ready;
+	{
+		std::lock_guard<std::mutex> lock(retired_mutex_);
+		std::vector<Retired> waiting;
+		for (unsigned int i = 0; i < retired_.size(); ++i) {
+			if (retired_[i].epoch < oldest) {
+				ready.push_back(retired_[i]);
+			} else {
+				waiting.push_back(retired_[i]);
+			}
+		}
+		retired_.swap(waiting);
+	}
+	//	delete outside of the lock since deleting a big version takes a while
+	for (unsigned int i = 0; i < ready.size(); ++i) {
+		ready[i].deleter();
+	}
+	return ready.size();
+}
+
+int EpochManager::pending() {
+	std::lock_guard<std::mutex> lock(retired_mutex_);
+	return retired_.size();
+}
+
+EpochGuard::EpochGuard(EpochManager& epochs) : epochs_(epochs) {
+	slot_ = epochs_.enter();
+}
+
+EpochGuard::~EpochGuard() {
+	epochs_.exit(slot_);
+}
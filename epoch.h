@@ -0,0 +1,113 @@
+/*******************************************************************************
+  Title          : epoch.h
+  Description    : The interface file for the EpochManager and EpochGuard 
+                   classes
+  Purpose        : To delete objects that readers on other threads may still 
+                   be using only after those readers are done with them
+  Usage          : Readers create an EpochGuard before loading a shared 
+                   pointer and keep it until they stop using what it points 
+                   to. The writer replaces the shared pointer and then gives 
+                   the old object to retire()
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __EPOCH_H__
+#define __EPOCH_H__
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+/*******************************************************************************
+
+		The EpochManager class implements epoch based reclamation. It keeps a 
+		global epoch number that the writer increases every time it retires an 
+		object, and a fixed number of reader slots. A reader that enters writes 
+		the current epoch into a free slot and a reader that exits sets its slot
+		back to 0. An object retired in epoch r was replaced before the epoch 
+		became r + 1, so a reader whose slot holds an epoch greater than r cannot
+		have seen it. The object is deleted once every slot is either 0 or greater
+		than r. Readers never wait and never take a lock; only retire() and 
+		reclaim() take a lock, which protects the list of retired objects. At most
+		kMaxReaders readers can be inside at the same time; more than that wait 
+		for a free slot
+
+*******************************************************************************/
+
+const int kMaxReaders = 64;
+
+class EpochManager {
+ public:
+	//	Creates an EpochManager object with no readers and nothing retired
+	EpochManager();
+
+	//	Deletes every object that is still retired. No reader may be inside
+	~EpochManager();
+
+	//	Marks the calling reader as inside and returns the slot it was given
+	int enter();
+
+	//	Marks the reader that was given slot as outside
+	void exit(int slot);
+
+	//	Takes ownership of an object that has already been replaced, so that
+	//	deleter is called once no reader can be using it
+	void retire(std::function<void()> deleter);
+
+	//	Calls the deleter of every retired object that no reader can be using
+	//	Returns the number of objects deleted
+	int reclaim();
+
+	//	Returns the number of retired objects that have not been deleted yet
+	int pending();
+
+ private:
+	//	An object waiting to be deleted and the epoch it was retired in
+	struct Retired {
+		unsigned long long epoch;
+		std::function<void()> deleter;
+	};
+
+	//	The current epoch, which starts at 1 because 0 marks an empty slot
+	std::atomic<unsigned long long> global_epoch_;
+
+	//	The epoch each reader entered in, or 0 if the slot is free
+	std::array<std::atomic<unsigned long long>, kMaxReaders> reader_epochs_;
+
+	//	Protects retired_
+	std::mutex retired_mutex_;
+
+	//	The objects that have been retired but not deleted
+	std::vector<Retired> retired_;
+};
+
+/*******************************************************************************
+
+		The EpochGuard class enters an EpochManager when it is created and exits 
+		it when it is destroyed, so a reader stays inside for exactly the scope of
+		the guard
+
+*******************************************************************************/
+
+class EpochGuard {
+ public:
+	//	Enters epochs
+	explicit EpochGuard(EpochManager& epochs);
+
+	//	Exits the EpochManager entered by the constructor
+	~EpochGuard();
+
+ private:
+	EpochGuard(const EpochGuard&);
+	EpochGuard& operator=(const EpochGuard&);
+
+	EpochManager& epochs_;
+	int slot_;
+};
+
+#endif
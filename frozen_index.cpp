@@ -0,0 +1,185 @@
+/*******************************************************************************
+  Title          : frozen_index.cpp
+  Description    : The implementation file for the FrozenIndex class
+  Purpose        : To search the Trees of an AVL_Tree that is no longer 
+                   changing without following its child pointers
+  Usage          : Used by AVL_Tree after freeze() is called, until the next
+                   insert or remove
+  Build with     : g++ -c -std=c++11 frozen_index.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "frozen_index.h"
+#include <algorithm>
+#include <climits>
+
+//	The number of keys ahead of index k that a search prefetches, 3 levels 
+//	down, which is one 64-byte cache line of keys
+const unsigned int kPrefetchDistance = 8;
+
+FrozenIndex::FrozenIndex() : built_(false) {
+}
+
+FrozenIndex::~FrozenIndex() {
+}
+
+bool FrozenIndex::built() const {
+	return built_;
+}
+
+void FrozenIndex::build(BinaryNode<Tree>* root) {
+	clear();
+	//	go through the Trees in order without recursion
+	std::vector<BinaryNode<Tree>*> path;
+	BinaryNode<Tree>* node = root;
+	while (node != nullptr || !path.empty()) {
+		while (node != nullptr) {
+			path.push_back(node);
+			node = node->left_child;
+		}
+		node = path.back();
+		path.pop_back();
+		rows_.push_back(node);
+		std::string species = node->data.common_name();
+		if (species_.empty() || species_.back() != species) {
+			species_.push_back(species);
+		}
+		node = node->right_child;
+	}
+	std::vector<unsigned long long> sorted_keys;
+	sorted_keys.reserve(rows_.size());
+	int code = -1;
+	for (unsigned int i = 0; i < rows_.size(); ++i) {
+		if (0 == i || !samename(rows_[i - 1]->data, rows_[i]->data)) {
+			++code;
+		}
+		sorted_keys.push_back(make_key(code, rows_[i]->data.id()));
+	}
+	keys_.assign(rows_.size() + 1, 0);
+	ranks_.assign(rows_.size() + 1, 0);
+	fill(sorted_keys, 1, 0);
+	built_ = true;
+}
+
+void FrozenIndex::clear() {
+	if (!built_) {
+		return;
+	}
+	//	swap with empty vectors so the memory is given back
+	std::vector<unsigned long long>().swap(keys_);
+	std::vector<int>().swap(ranks_);
+	std::vector<BinaryNode<Tree>*>().swap(rows_);
+	std::vector<std::string>().swap(species_);
+	built_ = false;
+}
+
+BinaryNode<Tree>* FrozenIndex::find(const std::string& species,
+                                    int tree_id) const {
+	bool found = false;
+	int code = species_code(species, found);
+	if (!found) {
+		return nullptr;
+	}
+	unsigned long long key = make_key(code, tree_id);
+	unsigned int k = lower_bound(key);
+	if (0 == k || keys_[k] != key) {
+		return nullptr;
+	}
+	return rows_[ranks_[k]];
+}
+
+int FrozenIndex::rank(const std::string& species, int tree_id) const {
+	bool found = false;
+	int code = species_code(species, found);
+	if (!found) {
+		//	every Tree of the species at code is greater
+		return count_less(make_key(code, INT_MIN));
+	}
+	return count_less(make_key(code, tree_id));
+}
+
+int FrozenIndex::name_rank(const std::string& species, bool or_equal) const {
+	bool found = false;
+	int code = species_code(species, found);
+	if (found && or_equal) {
+		++code;
+	}
+	return count_less(make_key(code, INT_MIN));
+}
+
+int FrozenIndex::size() const {
+	return rows_.size();
+}
+
+BinaryNode<Tree>* FrozenIndex::row(int i) const {
+	return rows_[i];
+}
+
+MemoryUsage FrozenIndex::memory_usage() const {
+	MemoryUsage usage = vector_usage(keys_);
+	usage += vector_usage(ranks_);
+	usage += vector_usage(rows_);
+	usage += vector_usage(species_);
+	for (unsigned int i = 0; i < species_.size(); ++i) {
+		usage += string_usage(species_[i]);
+	}
+	return usage;
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+unsigned long long FrozenIndex::make_key(int code, int tree_id) {
+	//	flipping the sign bit keeps negative tree_ids before positive ones
+	unsigned int id_bits = static_cast<unsigned int>(tree_id) ^ 0x80000000u;
+	return (static_cast<unsigned long long>(code) << 32) | id_bits;
+}
+
+unsigned int FrozenIndex::lower_bound(unsigned long long key) const {
+	const unsigned long long* keys = keys_.data();
+	unsigned int n = keys_.size() - 1;
+	unsigned int k = 1;
+	//	go left or right by adding the result of the comparison to the index,
+	//	so there is no branch to mispredict. The loop runs the same number of 
+	//	times for every key
+	while (k <= n) {
+		__builtin_prefetch(keys + std::min(k * kPrefetchDistance, n));
+		k = 2 * k + (keys[k] < key);
+	}
+	//	the last left turn was at the answer. Undo the right turns after it 
+	//	and that left turn. If there was no left turn, k becomes 0
+	k >>= __builtin_ffs(~k);
+	return k;
+}
+
+int FrozenIndex::count_less(unsigned long long key) const {
+	unsigned int k = lower_bound(key);
+	if (0 == k) {
+		return rows_.size();
+	}
+	return ranks_[k];
+}
+
+int FrozenIndex::species_code(const std::string& species, bool& found) const {
+	std::vector<std::string>::const_iterator it = 
+	    std::lower_bound(species_.begin(), species_.end(), species);
+	found = (it != species_.end() && *it == species);
+	return it - species_.begin();
+}
+
+int FrozenIndex::fill(const std::vector<unsigned long long>& sorted_keys,
+                      unsigned int k, int first) {
+	//	an in-order walk of the implicit tree visits its indexes in key order
+	if (keys_.size() <= k) {
+		return first;
+	}
+	first = fill(sorted_keys, 2 * k, first);
+	keys_[k] = sorted_keys[first];
+	ranks_[k] = first;
+	++first;
+	return fill(sorted_keys, 2 * k + 1, first);
+}
@@ -0,0 +1,118 @@
+/*******************************************************************************
+  Title          : frozen_index.h
+  Description    : The interface file for the FrozenIndex class
+  Purpose        : To search the Trees of an AVL_Tree that is no longer 
+                   changing without following its child pointers
+  Usage          : Used by AVL_Tree after freeze() is called, until the next
+                   insert or remove
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __FROZEN_INDEX_H__
+#define __FROZEN_INDEX_H__
+
+#include "BinaryNode.cpp"
+#include "memory_stats.h"
+#include "tree.h"
+#include <string>
+#include <vector>
+
+/*******************************************************************************
+
+		The FrozenIndex class is a copy of the keys of an AVL_Tree laid out in an
+		array in Eytzinger order: the root is at index 1 and the children of the 
+		key at index k are at 2k and 2k + 1, so no child pointers are stored and 
+		the first levels of every search share the same few cache lines. Each 
+		key is a single 64-bit integer made of the position of the Tree's 
+		spc_common among the sorted species names and the Tree's tree_id, so it 
+		is compared in one instruction and a search does not branch on the 
+		result. Next to each key is its row index, the rank of the Tree, which 
+		is the index of the Tree's BinaryNode in rows_. A FrozenIndex does not 
+		change when the AVL_Tree does, so the AVL_Tree throws it away on every 
+		insert and remove
+
+*******************************************************************************/
+
+class FrozenIndex {
+ public:
+	//	Creates an empty FrozenIndex object, which is not built
+	FrozenIndex();
+
+	//	Destroys FrozenIndex object. The BinaryNodes are not deleted
+	~FrozenIndex();
+
+	//	Returns true if build was called since the last clear
+	bool built() const;
+
+	//	Makes the FrozenIndex hold the keys of the Trees under root, which must 
+	//	be the root of an AVL_Tree
+	void build(BinaryNode<Tree>* root);
+
+	//	Removes every key, so the FrozenIndex is no longer built
+	void clear();
+
+	//	Returns the BinaryNode storing the Tree whose spc_common is species and
+	//	whose tree_id is tree_id, or nullptr if there is none
+	BinaryNode<Tree>* find(const std::string& species, int tree_id) const;
+
+	//	Returns the number of Trees less than the Tree whose spc_common is 
+	//	species and whose tree_id is tree_id
+	int rank(const std::string& species, int tree_id) const;
+
+	//	Returns the number of Trees whose spc_common is less than species, or
+	//	less than or equal to it if or_equal is true
+	int name_rank(const std::string& species, bool or_equal) const;
+
+	//	Returns the number of Trees
+	int size() const;
+
+	//	Returns the BinaryNode storing the Tree whose rank is i, which must be 
+	//	at least 0 and less than the number of Trees
+	BinaryNode<Tree>* row(int i) const;
+
+	//	Returns the memory used by the keys, the ranks, the rows and the 
+	//	species names, not counting the BinaryNodes
+	MemoryUsage memory_usage() const;
+
+ protected:
+	//	Returns the key of the Tree whose species position is code and whose 
+	//	tree_id is tree_id. Keys are in the same order as the Trees
+	static unsigned long long make_key(int code, int tree_id);
+
+	//	Returns the index in keys_ of the first key that is not less than key,
+	//	or 0 if every key is less than key
+	unsigned int lower_bound(unsigned long long key) const;
+
+	//	Returns the number of keys less than key
+	int count_less(unsigned long long key) const;
+
+	//	Returns the position of species among the sorted species names, or of 
+	//	the first name greater than it. Sets found to whether it is there
+	int species_code(const std::string& species, bool& found) const;
+
+	//	Puts sorted_keys from index first into the subtree of keys_ whose root 
+	//	is at index k, in order. Returns the index of the first key not used
+	int fill(const std::vector<unsigned long long>& sorted_keys, unsigned int k,
+	         int first);
+
+ private:
+	//	The keys in Eytzinger order. Index 0 is not used
+	std::vector<unsigned long long> keys_;
+
+	//	The row index of the key at the same index in keys_
+	std::vector<int> ranks_;
+
+	//	The BinaryNode of every Tree, in order
+	std::vector<BinaryNode<Tree>*> rows_;
+
+	//	The distinct spc_common members of the Trees, sorted
+	std::vector<std::string> species_;
+
+	//	True if build was called since the last clear
+	bool built_;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/*******************************************************************************
+  Title          : generate_census.cpp
+  Description    : Writes a census file with any number of trees in the 
+                   layout of the 2015 NYC Street Tree Census and, if asked, a 
+                   command file of queries about it
+  Purpose        : To test how the program behaves on censuses many times 
+                   larger than the real one
+  Usage          : ./generate_census [--rows N] [--seed S] [--commands FILE]
+                   [--command-count M] [--mix tree_info=30,list_near=20,...]
+                   [census_file.csv]
+                   The census is written to census_file.csv, or to standard 
+                   output if no file is given. Each line is written as it is
+                   made, so the files can be larger than memory. --mix gives 
+                   the weight of each command in the command file
+  Build with     : make generate_census
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include "census_generator.h"
+
+//	The number of trees in the real 2015 census
+const long long kCensusRows = 683788;
+
+//	The command mix used when --mix is not given
+const char* const kDefaultMix = "tree_info=30,listall_inzip=20,list_near=20,"
+                                "lookup=15,print=8,rollup=4,listall_names=2,"
+                                "verify=1";
+
+//	Reads mix, which looks like "tree_info=30,list_near=20", into weights
+//	Returns false if a name is not one of kGeneratedCommands or a weight is 
+//	not a positive number
+bool parse_mix(const std::string& mix, std::map<std::string, double>& weights)
+{
+	std::istringstream entries(mix);
+	std::string entry;
+	while (std::getline(entries, entry, ',')) {
+		std::string::size_type equals = entry.find('=');
+		if (equals == std::string::npos) {
+			return false;
+		}
+		std::string name = entry.substr(0, equals);
+		double weight = atof(entry.c_str() + equals + 1);
+		bool known = false;
+		for (int c = 0; c < kNumberOfGeneratedCommands; ++c) {
+			if (name == kGeneratedCommands[c]) {
+				known = true;
+			}
+		}
+		if (!known || weight <= 0) {
+			return false;
+		}
+		weights[name] = weight;
+	}
+	return !weights.empty();
+}
+
+int main(int argc, char* argv[]) {
+	long long number_of_rows = kCensusRows;
+	unsigned int seed = 2015;
+	long long number_of_commands = 1000;
+	std::string command_file_name;
+	std::string census_file_name;
+	std::string mix = kDefaultMix;
+	for (int i = 1; i < argc; ++i) {
+		std::string option = argv[i];
+		if ("--rows" == option && i + 1 < argc) {
+			number_of_rows = atoll(argv[++i]);
+		} else if ("--seed" == option && i + 1 < argc) {
+			seed = strtoul(argv[++i], nullptr, 10);
+		} else if ("--commands" == option && i + 1 < argc) {
+			command_file_name = argv[++i];
+		} else if ("--command-count" == option && i + 1 < argc) {
+			number_of_commands = atoll(argv[++i]);
+		} else if ("--mix" == option && i + 1 < argc) {
+			mix = argv[++i];
+		} else {
+			census_file_name = option;
+		}
+	}
+	std::map<std::string, double> weights;
+	if (number_of_rows < 1 || !parse_mix(mix, weights)) {
+		std::cerr << "Usage: " << argv[0] << " [--rows N] [--seed S] "
+		          << "[--commands FILE] [--command-count M] "
+		          << "[--mix tree_info=30,list_near=20,...] [census_file.csv]"
+		          << std::endl;
+		exit(1);
+	}
+
+	CensusGenerator generator(seed, number_of_rows);
+	std::ios::sync_with_stdio(false);
+	std::ofstream census_file;
+	if (!census_file_name.empty()) {
+		census_file.open(census_file_name);
+		if (census_file.fail()) {
+			std::cerr << "Unable to open census file: " << census_file_name 
+			          << std::endl;
+			exit(1);
+		}
+	}
+	std::ostream& census = census_file_name.empty() ? std::cout : census_file;
+	for (long long tree_id = 1; tree_id <= number_of_rows; ++tree_id) {
+		generator.write_row(census, tree_id);
+	}
+	census.flush();
+
+	if (!command_file_name.empty()) {
+		std::ofstream commands(command_file_name);
+		if (commands.fail()) {
+			std::cerr << "Unable to open command file: " << command_file_name
+			          << std::endl;
+			exit(1);
+		}
+		for (long long c = 0; c < number_of_commands; ++c) {
+			generator.write_command(commands, generator.pick_command(weights));
+		}
+	}
+	return 0;
+}
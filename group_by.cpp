@@ -0,0 +1,257 @@
+/*******************************************************************************
+  Title          : group_by.cpp
+  Description    : The implementation file for the GroupBy class
+  Purpose        : To count Tree objects by species and by an optional second 
+                   key without building a list of species names
+  Usage          : Give a GroupBy object to one of the AVL_Tree grouping 
+                   methods and then read the counts from it
+  Build with     : g++ -c -std=c++11 group_by.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "group_by.h"
+#include <algorithm>
+
+//	the largest possible zipcode is 99999
+const int kNumberOfZipcodes = 100000;
+
+GroupBy::GroupBy(int number_of_species, GroupKey key) {
+	key_ = key;
+	number_of_species_ = number_of_species;
+	first_zip_ = 0;
+	if (BY_SPECIES == key_) {
+		add_slot(0);
+	} else if (BY_BOROUGH == key_) {
+		for (int b = ALLBOROS; b <= STATEN; ++b) {
+			add_slot(b);
+		}
+	} else if (BY_HEALTH == key_) {
+		for (int h = 0; h <= 3; ++h) {
+			add_slot(h);
+		}
+	} else if (BY_DIAMETER == key_) {
+		for (int d = 0; d < kDiameterBuckets; ++d) {
+			add_slot(d * kDiameterBucket);
+		}
+	}
+}
+
+GroupBy::~GroupBy() {
+}
+
+void GroupBy::add(const Tree& tree) {
+	int slot = slot_for(tree);
+	if (slot < 0 || tree.species_id() < 0 || 
+			tree.species_id() >= number_of_species_) {
+		return;
+	}
+	++counts_[slot * number_of_species_ + tree.species_id()];
+}
+
+void GroupBy::remove(const Tree& tree) {
+	int slot = slot_for(tree);
+	if (slot < 0 || tree.species_id() < 0 || 
+			tree.species_id() >= number_of_species_) {
+		return;
+	}
+	--counts_[slot * number_of_species_ + tree.species_id()];
+}
+
+void GroupBy::clear() {
+	std::fill(counts_.begin(), counts_.end(), 0);
+}
+
+GroupKey GroupBy::key() const {
+	return key_;
+}
+
+int GroupBy::number_of_species() const {
+	return number_of_species_;
+}
+
+int GroupBy::number_of_slots() const {
+	return slot_values_.size();
+}
+
+int GroupBy::slot_value(int slot) const {
+	return slot_values_[slot];
+}
+
+int GroupBy::slot_of(int value) const {
+	if (BY_ZIP == key_) {
+		if (value < first_zip_ || 
+				first_zip_ + static_cast<int>(zip_slots_.size()) <= value) {
+			return -1;
+		}
+		return zip_slots_[value - first_zip_];
+	} else if (BY_DIAMETER == key_) {
+		if (value < 0) {
+			return -1;
+		}
+		return std::min(value / kDiameterBucket, kDiameterBuckets - 1);
+	} else if (BY_SPECIES == key_) {
+		return 0;
+	} else if (value < 0 || number_of_slots() <= value) {
+		return -1;
+	}
+	return value;
+}
+
+int GroupBy::count(int species_id, int slot) const {
+	return counts_[slot * number_of_species_ + species_id];
+}
+
+int GroupBy::species_total(int species_id) const {
+	int total = 0;
+	for (int slot = 0; slot < number_of_slots(); ++slot) {
+		total += counts_[slot * number_of_species_ + species_id];
+	}
+	return total;
+}
+
+int GroupBy::slot_total(int slot) const {
+	int total = 0;
+	for (int s = 0; s < number_of_species_; ++s) {
+		total += counts_[slot * number_of_species_ + s];
+	}
+	return total;
+}
+
+int GroupBy::total() const {
+	int total = 0;
+	for (unsigned int i = 0; i < counts_.size(); ++i) {
+		total += counts_[i];
+	}
+	return total;
+}
+
+std::vector<int> GroupBy::sorted_slots() const {
+	std::vector<int> slots(slot_values_.size());
+	for (unsigned int i = 0; i < slots.size(); ++i) {
+		slots[i] = i;
+	}
+	//	only zipcode slots are made out of order
+	if (BY_ZIP == key_) {
+		const std::vector<int>& values = slot_values_;
+		std::sort(slots.begin(), slots.end(),
+							[&values](int s1, int s2) { return values[s1] < values[s2]; });
+	}
+	return slots;
+}
+
+void GroupBy::merge(const GroupBy& other) {
+	for (int slot = 0; slot < other.number_of_slots(); ++slot) {
+		merge(other, slot);
+	}
+}
+
+void GroupBy::merge(const GroupBy& other, int other_slot) {
+	resize(other.number_of_species_);
+	int slot = slot_for(other.slot_value(other_slot));
+	if (slot < 0) {
+		return;
+	}
+	for (int s = 0; s < other.number_of_species_; ++s) {
+		counts_[slot * number_of_species_ + s] += other.count(s, other_slot);
+	}
+}
+
+void GroupBy::resize(int number_of_species) {
+	if (number_of_species <= number_of_species_) {
+		return;
+	}
+	number_of_species = std::max(number_of_species, 2 * number_of_species_);
+	std::vector<int> counts(slot_values_.size() * number_of_species, 0);
+	for (int slot = 0; slot < number_of_slots(); ++slot) {
+		std::copy(counts_.begin() + slot * number_of_species_,
+							counts_.begin() + (slot + 1) * number_of_species_,
+							counts.begin() + slot * number_of_species);
+	}
+	counts_.swap(counts);
+	number_of_species_ = number_of_species;
+}
+
+bool operator==(const GroupBy& g1, const GroupBy& g2) {
+	if (g1.key_ != g2.key_) {
+		return false;
+	}
+	int species = std::max(g1.number_of_species_, g2.number_of_species_);
+	for (int slot = 0; slot < g1.number_of_slots(); ++slot) {
+		int other_slot = g2.slot_of(g1.slot_value(slot));
+		for (int s = 0; s < species; ++s) {
+			int c1 = (s < g1.number_of_species_) ? g1.count(s, slot) : 0;
+			int c2 = (other_slot < 0 || g2.number_of_species_ <= s) ? 0 :
+							 g2.count(s, other_slot);
+			if (c1 != c2) {
+				return false;
+			}
+		}
+	}
+	//	a slot that only g2 has must be empty
+	for (int slot = 0; slot < g2.number_of_slots(); ++slot) {
+		if (g1.slot_of(g2.slot_value(slot)) < 0 && 0 != g2.slot_total(slot)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+MemoryUsage GroupBy::memory_usage() const {
+	MemoryUsage usage = vector_usage(counts_);
+	usage += vector_usage(slot_values_);
+	usage += vector_usage(zip_slots_);
+	return usage;
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+int GroupBy::slot_for(const Tree& tree) {
+	switch (key_) {
+		case BY_ZIP:
+			return slot_for(tree.zip());
+		case BY_BOROUGH:
+			return tree.borough();
+		case BY_HEALTH:
+			return tree.health_code();
+		case BY_DIAMETER:
+			return slot_of(tree.diameter());
+		default:
+			return 0;
+	}
+}
+
+int GroupBy::slot_for(int value) {
+	if (BY_ZIP != key_) {
+		return slot_of(value);
+	}
+	if (value < 0 || kNumberOfZipcodes <= value) {
+		return -1;
+	}
+	//	the table only covers the zipcodes from the smallest to the largest one
+	//	seen, so it grows at the front or the back when a zipcode is outside them
+	if (zip_slots_.empty()) {
+		first_zip_ = value;
+		zip_slots_.push_back(-1);
+	} else if (value < first_zip_) {
+		zip_slots_.insert(zip_slots_.begin(), first_zip_ - value, -1);
+		first_zip_ = value;
+	} else if (first_zip_ + static_cast<int>(zip_slots_.size()) <= value) {
+		zip_slots_.resize(value - first_zip_ + 1, -1);
+	}
+	int& slot = zip_slots_[value - first_zip_];
+	if (slot < 0) {
+		slot = add_slot(value);
+	}
+	return slot;
+}
+
+int GroupBy::add_slot(int value) {
+	slot_values_.push_back(value);
+	counts_.resize(slot_values_.size() * number_of_species_, 0);
+	return slot_values_.size() - 1;
+}
@@ -0,0 +1,151 @@
+/*******************************************************************************
+  Title          : group_by.h
+  Description    : The interface file for the GroupBy class
+  Purpose        : To count Tree objects by species and by an optional second 
+                   key without building a list of species names
+  Usage          : Give a GroupBy object to one of the AVL_Tree grouping 
+                   methods and then read the counts from it
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __GROUP_BY_H__
+#define __GROUP_BY_H__
+
+#include "memory_stats.h"
+#include "tree.h"
+#include <vector>
+
+/*******************************************************************************
+
+		The GroupBy class is an aggregation of Tree objects. Every Tree object 
+		given to it is counted in a dense array of integers that is indexed by the
+		Tree's species id and by the slot of the Tree's value for the GroupBy's 
+		key. The key is one of the values of the enumerated type GroupKey. 
+		BY_SPECIES has only one slot, so it just counts each species. BY_BOROUGH 
+		uses the values of the enumerated type Borough as slots. BY_HEALTH uses 
+		Tree::health_code() as slots. BY_DIAMETER puts diameters into buckets that 
+		are kDiameterBucket inches wide and the last bucket holds all the larger 
+		diameters. BY_ZIP gives each zipcode a slot the first time a Tree in that 
+		zipcode is counted, and finds the slot in a table that only covers the 
+		zipcodes from the smallest to the largest one counted. The array is stored 
+		one slot after another, so all the species counts of a slot are next to 
+		each other
+
+*******************************************************************************/
+
+enum GroupKey {
+		BY_SPECIES = 0,
+		BY_ZIP,
+		BY_BOROUGH,
+		BY_HEALTH,
+		BY_DIAMETER
+	};
+
+const int kDiameterBucket = 6;
+const int kDiameterBuckets = 10;
+
+class GroupBy {
+ public:
+	//	Creates a GroupBy object that counts number_of_species species by key
+	GroupBy(int number_of_species, GroupKey key);
+
+	//	Destroys GroupBy object
+	~GroupBy();
+
+	//	Counts tree in the slot of its species and its key value
+	void add(const Tree& tree);
+
+	//	Takes tree back out of the slot of its species and its key value
+	void remove(const Tree& tree);
+
+	//	Sets every count back to 0
+	void clear();
+
+	//	Returns the key the Tree objects are grouped by
+	GroupKey key() const;
+
+	//	Returns the number of species that can be counted
+	int number_of_species() const;
+
+	//	Returns the number of slots that are in use
+	int number_of_slots() const;
+
+	//	Returns the key value of slot, which is a zipcode, a Borough value, a 
+	//	health code, or the smallest diameter in a diameter bucket
+	int slot_value(int slot) const;
+
+	//	Returns the slot that holds value, or -1 if no Tree with that value 
+	//	has been counted
+	int slot_of(int value) const;
+
+	//	Returns the number of Trees of species_id counted in slot
+	int count(int species_id, int slot) const;
+
+	//	Returns the number of Trees of species_id counted in all slots
+	int species_total(int species_id) const;
+
+	//	Returns the number of Trees counted in slot
+	int slot_total(int slot) const;
+
+	//	Returns the number of Trees counted in all slots
+	int total() const;
+
+	//	Returns a list of the slots that are in use, ordered by their values
+	std::vector<int> sorted_slots() const;
+
+	//	Adds every count of other, which must have the same key, to the count 
+	//	of the same species and key value
+	void merge(const GroupBy& other);
+
+	//	Adds the counts of other's slot to the counts of the same key value
+	void merge(const GroupBy& other, int other_slot);
+
+	//	Makes room for at least number_of_species species, keeping the current 
+	//	counts. Room is made for twice as many species as before so that adding
+	//	species one at a time does not copy the counts every time
+	void resize(int number_of_species);
+
+	//	Returns the memory used by the counts and the slots
+	MemoryUsage memory_usage() const;
+
+	//	Returns true if both GroupBy objects have the same key and the same 
+	//	count for every species and key value
+	friend bool operator==(const GroupBy& g1, const GroupBy& g2);
+
+ protected:
+	//	Returns the slot of tree's value for the key. If the key is BY_ZIP and 
+	//	tree's zipcode has no slot yet, a slot is made for it
+	int slot_for(const Tree& tree);
+
+	//	Returns the slot that holds value, making one if the key is BY_ZIP and 
+	//	value has no slot yet. Returns -1 if value cannot have a slot
+	int slot_for(int value);
+
+	//	Adds a new slot for value and returns it
+	int add_slot(int value);
+
+ private:
+	//	The key the Trees are grouped by
+	GroupKey key_;
+
+	//	The number of species each slot has room for
+	int number_of_species_;
+
+	//	The counts, stored one slot after another
+	std::vector<int> counts_;
+
+	//	The key value of each slot
+	std::vector<int> slot_values_;
+
+	//	Maps a zipcode to its slot when the key is BY_ZIP. Entry i is the slot 
+	//	of zipcode first_zip_ + i, or -1 if that zipcode has no slot
+	std::vector<int> zip_slots_;
+
+	//	The smallest zipcode that has a slot
+	int first_zip_;
+};
+
+#endif
@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <math.h>
+#include "haversine.h"
  
 #define R 6372.8
 #define TO_RAD (3.1415926536 / 180)
@@ -0,0 +1,23 @@
+/*******************************************************************************
+  Title          : haversine.h
+  Description    : Declarations of the functions in haversine.cpp
+  Purpose        : To let more than one file compute distances on earth 
+                   without each one including haversine.cpp
+  Usage          : Include this file and link with haversine.o
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#ifndef __HAVERSINE_H__
+#define __HAVERSINE_H__
+
+//	Returns the distance in kilometers between the two points, whose 
+//	coordinates are in degrees
+double dist(double th1, double ph1, double th2, double ph2);
+
+//	Returns the distance in kilometers between (lat1, lon1) and (lat2, lon2)
+//	using the haversine formula. The coordinates are in degrees
+double haversine(double lat1, double lon1, double lat2, double lon2);
+
+#endif
@@ -0,0 +1,137 @@
+/*******************************************************************************
+  Title          : ingest_profile.cpp
+  Description    : The implementation file for the IngestProfile class
+  Purpose        : To find out which part of loading a census file takes the
+                   most time
+  Usage          : Call enable(), then lap() after each part of loading a row,
+                   then write_report()
+  Build with     : g++ -c -std=c++11 ingest_profile.cpp
+  Modifications  :
+
+*******************************************************************************/
+
+#include "ingest_profile.h"
+#include <iomanip>
+#include <ios>
+
+IngestProfile::IngestProfile() : enabled_(false), rows_(0) {
+	for (int p = 0; p < kNumberOfIngestPhases; ++p) {
+		durations_[p] = std::chrono::steady_clock::duration::zero();
+	}
+}
+
+void IngestProfile::enable(bool on) {
+	enabled_ = on;
+}
+
+bool IngestProfile::enabled() const {
+	return enabled_;
+}
+
+IngestProfile::time_point IngestProfile::now() const {
+	if (!enabled_) {
+		return time_point();
+	}
+	return std::chrono::steady_clock::now();
+}
+
+void IngestProfile::lap(IngestPhase phase, time_point& since) {
+	if (!enabled_) {
+		return;
+	}
+	time_point end = std::chrono::steady_clock::now();
+	durations_[phase] += end - since;
+	since = end;
+}
+
+void IngestProfile::add_rows(long long rows) {
+	rows_ += rows;
+}
+
+long long IngestProfile::rows() const {
+	return rows_;
+}
+
+double IngestProfile::seconds(IngestPhase phase) const {
+	return std::chrono::duration<double>(durations_[phase]).count();
+}
+
+void IngestProfile::write_report(std::ostream& out, const char* index_name,
+                                 const RebalanceCounters& counters,
+                                 int height) const {
+	double total = 0;
+	for (int p = 0; p < kNumberOfIngestPhases; ++p) {
+		total += seconds(static_cast<IngestPhase>(p));
+	}
+	out << "Ingest report: " << rows_ << " rows into " << index_name
+	    << std::endl;
+	out << std::left << std::setw(16) << "phase" << std::right
+	    << std::setw(12) << "seconds" << std::setw(16) << "rows/sec"
+	    << std::setw(10) << "share" << std::endl;
+	out << std::fixed;
+	for (int p = 0; p <= kNumberOfIngestPhases; ++p) {
+		//	the last line is the total of all the phases
+		double phase_seconds = total;
+		const char* name = "total";
+		if (p < kNumberOfIngestPhases) {
+			phase_seconds = seconds(static_cast<IngestPhase>(p));
+			name = phase_name(static_cast<IngestPhase>(p));
+		}
+		out << std::left << std::setw(16) << name << std::right
+		    << std::setprecision(3) << std::setw(12) << phase_seconds
+		    << std::setprecision(0) << std::setw(16);
+		if (0 < phase_seconds) {
+			out << rows_ / phase_seconds;
+		} else {
+			out << "-";
+		}
+		out << std::setprecision(1) << std::setw(9);
+		if (0 < total) {
+			out << 100 * phase_seconds / total;
+		} else {
+			out << 0.0;
+		}
+		out << "%" << std::endl;
+	}
+
+	out << "Rotations: LL " << counters.ll_rotations << ", LR "
+	    << counters.lr_rotations << ", RR " << counters.rr_rotations
+	    << ", RL " << counters.rl_rotations << std::endl;
+	long long inserts = 0, depth_total = 0;
+	for (unsigned int d = 0; d < counters.insert_depths.size(); ++d) {
+		inserts += counters.insert_depths[d];
+		depth_total += d * counters.insert_depths[d];
+	}
+	if (0 < inserts) {
+		out << "Insert depths: average " << std::setprecision(2)
+		    << static_cast<double>(depth_total) / inserts << std::endl;
+		out << std::setprecision(1);
+		for (unsigned int d = 0; d < counters.insert_depths.size(); ++d) {
+			out << std::setw(6) << d << std::setw(12)
+			    << counters.insert_depths[d] << std::setw(9)
+			    << 100.0 * counters.insert_depths[d] / inserts << "%"
+			    << std::endl;
+		}
+	}
+	out << "Final height: " << height << std::endl;
+	out.copyfmt(std::ios(nullptr));
+}
+
+const char* IngestProfile::phase_name(IngestPhase phase) {
+	switch (phase) {
+		case READ_PHASE:
+			return "file read";
+		case PARSE_PHASE:
+			return "Tree parse";
+		case INDEX_PHASE:
+			return "index insert";
+		case SPECIES_PHASE:
+			return "add_species";
+		case VIEWS_PHASE:
+			return "views";
+		case FREEZE_PHASE:
+			return "freeze";
+		default:
+			return "unknown";
+	}
+}
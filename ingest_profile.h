@@ -0,0 +1,93 @@
+/*******************************************************************************
+  Title          : ingest_profile.h
+  Description    : The interface file for the IngestProfile class
+  Purpose        : To find out which part of loading a census file takes the
+                   most time
+  Usage          : Call enable(), then lap() after each part of loading a row,
+                   then write_report()
+  Build with     : No building
+  Modifications  :
+
+*******************************************************************************/
+
+
+#ifndef __INGEST_PROFILE_H__
+#define __INGEST_PROFILE_H__
+
+#include "tree_index.h"
+#include <chrono>
+#include <ostream>
+
+//	The parts of loading a census file that are timed separately.
+//	INDEX_PHASE is inserting into the TreeIndex, SPECIES_PHASE is
+//	TreeSpecies::add_species, VIEWS_PHASE is giving the Tree its species id and
+//	counting it in the materialized views, and FREEZE_PHASE is laying out the
+//	TreeIndex for reading once every row is inserted
+enum IngestPhase {READ_PHASE, PARSE_PHASE, INDEX_PHASE, SPECIES_PHASE,
+                  VIEWS_PHASE, FREEZE_PHASE};
+
+//	The number of values of IngestPhase
+const int kNumberOfIngestPhases = 6;
+
+/*******************************************************************************
+
+		The IngestProfile class adds up the time spent in each IngestPhase of
+		loading a census file. The code being timed keeps a time point, and
+		after each phase calls lap(), which adds the time since that point to
+		the phase and moves the point to now. Until enable() is called, now()
+		and lap() do not read the clock, so a TreeCollection whose loads are not
+		profiled only pays for checking a flag a few times per row.
+		write_report() outputs the time of each phase, how many rows per second
+		that phase alone could handle, and the rotations, insert depths and
+		height of the TreeIndex the rows were loaded into
+
+*******************************************************************************/
+
+class IngestProfile {
+ public:
+	typedef std::chrono::steady_clock::time_point time_point;
+
+	//	Creates an IngestProfile object that is not enabled and has no times
+	IngestProfile();
+
+	//	Starts timing if on is true and stops timing otherwise
+	void enable(bool on);
+
+	//	Returns true if the IngestProfile object is timing
+	bool enabled() const;
+
+	//	Returns the time now if the IngestProfile object is enabled, and the
+	//	start of the clock otherwise
+	time_point now() const;
+
+	//	Adds the time from since to now to phase and sets since to now, if the
+	//	IngestProfile object is enabled
+	void lap(IngestPhase phase, time_point& since);
+
+	//	Adds rows to the number of rows loaded
+	void add_rows(long long rows);
+
+	//	Returns the number of rows loaded
+	long long rows() const;
+
+	//	Returns the seconds spent in phase
+	double seconds(IngestPhase phase) const;
+
+	//	Outputs the time and rows per second of each phase, then the rotations
+	//	and insert depths in counters and the final height of the index, which
+	//	is called index_name
+	void write_report(std::ostream& out, const char* index_name,
+	                  const RebalanceCounters& counters, int height) const;
+
+	//	Returns the name of phase in the report
+	static const char* phase_name(IngestPhase phase);
+
+ private:
+	bool enabled_;
+	long long rows_;
+
+	//	The time spent in each IngestPhase
+	std::chrono::steady_clock::duration durations_[kNumberOfIngestPhases];
+};
+
+#endif
@@ -18,9 +18,36 @@
 		   						 object that represents a database and answer specific user 
 		   						 queries pertaining to the database 
   Usage          : When running, provide two input files, the NYC Tree Census 
-		   						 file and a file with a list of commands, respectively
-  Build with     : g++ -std=c++11 -o main main.cpp tree.cpp avl.cpp 
-		  						 tree_collection.cpp tree_species.o command.o
+		   						 file and a file with a list of commands, respectively. 
+		   						 --streaming runs the commands while the census file is still 
+		   						 loading. --sharded stores and searches each borough's trees 
+		   						 on its own thread. --threads N splits the queries that visit 
+		   						 every tree between N threads. --compare runs every command 
+		   						 on both IndexBackends and reports differences. --stats and 
+		   						 --stats-json FILE report the time and work of each kind of 
+		   						 command. --ingest-report times the phases of loading. 
+		   						 --trace FILE writes a trace_event JSON trace of the run. 
+		   						 --perf reads the processor's counters in a few hot regions. 
+		   						 --memstats reports the memory each part of the collection 
+		   						 uses. --lazy-fields maps the census file and parses each 
+		   						 tree's status and address only when they are printed. 
+		   						 --hilbert lays out the coordinate columns along a Hilbert 
+		   						 curve. --batch-near answers each run of list_near commands 
+		   						 in one pass. Unknown options and options that the chosen 
+		   						 collection does not use stop the program with a usage 
+		   						 message
+  Build with     : g++ -std=c++11 -pthread -o main main.cpp tree.cpp avl.cpp 
+		  						 tree_collection.cpp group_by.cpp
+		  						 tree_id_index.cpp haversine.cpp persistent_avl.cpp 
+		  						 epoch.cpp concurrent_collection.cpp process_memory.cpp 
+		  						 reloadable_collection.cpp thread_pool.cpp 
+		  						 sharded_collection.cpp work_stealing.cpp bplus_tree.cpp 
+		  						 frozen_index.cpp tree_index.cpp backend_comparison.cpp 
+		  						 command_stats.cpp work_counters.cpp ingest_profile.cpp 
+		  						 trace.cpp perf_profiler.cpp memory_stats.cpp 
+		  						 census_file.cpp street_dictionary.cpp 
+		  						 coordinate_columns.cpp corridor.cpp nearby_batch.cpp 
+		  						 tree_species.o command.o
   Modifications  : 
  
 *******************************************************************************/
@@ -29,80 +56,526 @@
 #include <iostream>
 #include <stdlib.h>
 #include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 #include "tree.h"
 #include "command.h"
 #include "tree_collection.h"
+#include "concurrent_collection.h"
+#include "reloadable_collection.h"
+#include "sharded_collection.h"
+#include "backend_comparison.h"
+#include "command_stats.h"
+#include "memory_stats.h"
+#include "perf_profiler.h"
+#include "trace.h"
 
 
+//	Inserts every tree in tree_file into collection
+template <class Collection>
+void load_trees(std::ifstream& tree_file, Collection& collection) {
+	TraceSpan span("load census", "load");
+	collection.load(tree_file);
+}
+
+//	Inserts every record of census into collection, leaving the fields that
+//	are rarely needed in the mapped file
+void load_trees(std::shared_ptr<const CensusFile> census, 
+                ReloadableCollection& collection) {
+	TraceSpan span("load census", "load");
+	collection.load(census);
+}
+
+//	Inserts every tree in tree_file into collection and publishes the last 
+//	version once they are all inserted
+void load_trees(std::ifstream& tree_file, ConcurrentTreeCollection& collection)
+{
+	TraceSpan span("load census", "load");
+	std::string line;
+	while(tree_file.is_open()) {
+		std::getline(tree_file, line);
+		if (tree_file.eof()) {
+			break;
+		}
+		Tree new_tree(line, collection.streets());
+		collection.insert_tree(new_tree);
+	}
+	collection.finish();
+}
+
+//	Returns once every tree has been loaded into collection, including the
+//	trees of a census file that is being reloaded
+void wait_until_loaded(ReloadableCollection& collection) {
+	collection.wait_for_reload();
+}
+
+void wait_until_loaded(ShardedTreeCollection& collection) {
+}
+
+void wait_until_loaded(BackendComparison& collection) {
+}
+
+void wait_until_loaded(ConcurrentTreeCollection& collection) {
+	while (!collection.finished()) {
+		std::this_thread::yield();
+	}
+}
+
+//	The commands that run_extra_command runs
+const char* const kExtraCommands[] = {"rollup", "verify", "lookup", "remove", 
+                                      "print", "reload", "wait", "corridor"};
+
+//	Returns true if command_name is one of kExtraCommands
+bool is_extra_command(const std::string& command_name) {
+	for (const char* extra : kExtraCommands) {
+		if (command_name == extra) {
+			return true;
+		}
+	}
+	return false;
+}
+
+//	Runs the commands that the Command class does not know about. These are
+//	"rollup" followed by species, zip, borough, health or diameter, and 
+//	"verify", which checks the materialized views of the collection, and 
+//	"print" followed by two positions, which prints the trees from the first 
+//	position up to but not including the second, "lookup" or "remove" 
+//	followed by a tree_id, "reload" followed by a census file, which replaces 
+//	the trees with the ones in that file in the background, "wait", which
+//	waits until all the trees are loaded, and "corridor" followed by a 
+//	distance in kilometers and the latitude and longitude of each point of a
+//	path, which counts the trees within the distance of the path. Returns 
+//	true if line held one of these commands, which means it has been executed
+template <class Collection>
+bool run_extra_command(const std::string& line, Collection& collection) {
+	std::istringstream words(line);
+	std::string command_name, argument;
+	words >> command_name;
+	if (!is_extra_command(command_name)) {
+		return false;
+	}
+	TraceSpan span(command_name.c_str(), "command");
+	if ("rollup" == command_name) {
+		words >> argument;
+		if ("species" == argument || argument.empty()) {
+			collection.rollup(BY_SPECIES);
+		} else if ("zip" == argument) {
+			collection.rollup(BY_ZIP);
+		} else if ("borough" == argument) {
+			collection.rollup(BY_BOROUGH);
+		} else if ("health" == argument) {
+			collection.rollup(BY_HEALTH);
+		} else if ("diameter" == argument) {
+			collection.rollup(BY_DIAMETER);
+		} else {
+			std::cout << "Invalid command." << std::endl;
+			std::cout << std::endl;
+		}
+		return true;
+	} else if ("verify" == command_name) {
+		collection.verify();
+		return true;
+	} else if ("lookup" == command_name || "remove" == command_name) {
+		int tree_id = 0;
+		if (!(words >> tree_id)) {
+			std::cout << "Invalid command." << std::endl;
+			std::cout << std::endl;
+		} else if ("lookup" == command_name) {
+			collection.lookup(tree_id);
+		} else {
+			collection.remove(tree_id);
+		}
+		return true;
+	} else if ("print" == command_name) {
+		int first = 0, last = 0;
+		if (words >> first >> last) {
+			collection.print_trees(first, last);
+		} else {
+			std::cout << "Invalid command." << std::endl;
+			std::cout << std::endl;
+		}
+		return true;
+	} else if ("reload" == command_name) {
+		std::getline(words >> std::ws, argument);
+		if (argument.empty()) {
+			std::cout << "Invalid command." << std::endl;
+			std::cout << std::endl;
+		} else {
+			collection.reload(argument);
+		}
+		return true;
+	} else if ("wait" == command_name) {
+		wait_until_loaded(collection);
+		return true;
+	} else if ("corridor" == command_name) {
+		double distance = 0;
+		std::vector<CorridorPoint> points;
+		CorridorPoint point;
+		bool valid = static_cast<bool>(words >> distance);
+		while (valid && words >> point.latitude) {
+			valid = static_cast<bool>(words >> point.longitude);
+			points.push_back(point);
+		}
+		if (!valid || !words.eof() || points.empty()) {
+			std::cout << "Invalid command." << std::endl;
+			std::cout << std::endl;
+		} else {
+			collection.list_in_corridor(Corridor(points, distance));
+		}
+		return true;
+	}
+	return false;
+}
+
+//	Returns the name that the command statistics use for type
+const char* command_name(Command_type type) {
+	switch (type) {
+		case tree_info_cmmd:
+			return "tree_info";
+		case listall_names_cmmd:
+			return "listall_names";
+		case list_near_cmmd:
+			return "list_near";
+		case listall_inzip_cmmd:
+			return "listall_inzip";
+		default:
+			return "invalid";
+	}
+}
+
+//	Outputs the answers of the list_near commands in pending, in order, after
+//	finding them all in one pass over the trees of collection, and empties 
+//	pending. The batch is timed in stats as one "list_near batch" command
+template <class Collection>
+void run_near_batch(std::vector<NearbyQuery>& pending, Collection& collection,
+                    CommandStats* stats) {
+	if (pending.empty()) {
+		return;
+	}
+	if (stats != nullptr) {
+		stats->start();
+	}
+	{
+		TraceSpan span("list_near batch", "command");
+		collection.list_all_near_batch(pending);
+	}
+	if (stats != nullptr) {
+		stats->finish("list_near batch");
+	}
+	pending.clear();
+}
+
+//	Runs every command in command_file on collection, and times each one in
+//	stats unless stats is null. If batch_near is true, each run of up to 
+//	kNearbyBatchQueries list_near commands in a row is answered together by 
+//	run_near_batch when the run ends
+//	Returns 1 if a command could not be read, like the end of the file 
+//	without a trailing newline, and 0 otherwise
+template <class Collection>
+int run_commands(std::ifstream& command_file, Collection& collection,
+								 CommandStats* stats = nullptr, bool batch_near = false) {
+	std::string line;
+	Command command;
+  std::string treename;
+  int zipcode;
+  double latitude, longitude, distance;
+  bool result;
+	std::vector<NearbyQuery> pending;
+
+	while (!command_file.eof()) {
+		//	look at the next line first, and give it back to command if it is not
+		//	one of the extra commands
+		std::streampos line_start = command_file.tellg();
+		std::getline(command_file, line);
+		//	the list_near commands waiting in pending are answered before any 
+		//	other command runs, so the output stays in the order of the file
+		std::string first_word;
+		std::istringstream(line) >> first_word;
+		if ("list_near" != first_word) {
+			run_near_batch(pending, collection, stats);
+		}
+		if (stats != nullptr) {
+			stats->start();
+		}
+		if (run_extra_command(line, collection)) {
+			if (stats != nullptr) {
+				std::string extra_name;
+				std::istringstream(line) >> extra_name;
+				stats->finish(extra_name);
+			}
+			continue;
+		}
+		command_file.clear();
+		command_file.seekg(line_start);
+		if (!command.get_next(command_file)) {
+			run_near_batch(pending, collection, stats);
+			if (!command_file.eof()) {
+				std::cerr << "Could not get next command.\n";
+			}
+			return 1;
+		}
+		command.get_args(treename, zipcode, latitude, longitude, distance,
+										 result);
+		if (list_near_cmmd != command.type_of()) {
+			run_near_batch(pending, collection, stats);
+		} else if (batch_near) {
+			NearbyQuery query = {latitude, longitude, distance};
+			pending.push_back(query);
+			if (kNearbyBatchQueries == static_cast<int>(pending.size())) {
+				run_near_batch(pending, collection, stats);
+			}
+			continue;
+		}
+		TraceSpan span(command_name(command.type_of()), "command");
+
+		switch (command.type_of()) {
+			case tree_info_cmmd:
+				collection.tree_info(treename);
+				break;
+			case listall_names_cmmd:
+				collection.list_all_names();
+				break;
+			case list_near_cmmd:
+				collection.list_all_near(latitude, longitude, distance);
+				break;
+			case listall_inzip_cmmd:
+				collection.list_all_in_zip(zipcode);
+				break;
+			case bad_cmmd:
+				std::cout << "Invalid command." << std::endl;
+				std::cout << std::endl;
+				break;
+			default:
+				break;
+		}
+		if (stats != nullptr) {
+			stats->finish(command_name(command.type_of()));
+		}
+	}
+	run_near_batch(pending, collection, stats);
+	return 0;
+}
+
+//	Writes error, followed by how to run the program, to standard error and
+//	exits with status 1
+void usage_error(const std::string& error) {
+	std::cerr << "ERROR: " << error << std::endl;
+	std::cerr << "Usage: project2 [options] census_file command_file" 
+						<< std::endl;
+	std::cerr << "Options: --streaming, --sharded or --compare; --threads N; "
+						<< "--hilbert, --lazy-fields and --memstats, which are not "
+						<< "available with --streaming, --sharded or --compare; "
+						<< "--batch-near; --stats; --stats-json FILE; "
+						<< "--ingest-report; --trace FILE; --perf" << std::endl;
+	exit(1);
+}
+
 int main(int argc, char* argv[]) {
-	if(3 == argc) {
+	//	allocations are counted from the start, since a block made before 
+	//	counting and freed after would be taken off the counts
+	for (int i = 1; i < argc; ++i) {
+		if (std::string("--memstats") == argv[i]) {
+			AllocationCounter::enable();
+		}
+	}
+
+	//	options start with "--" and may come anywhere; the rest are the files
+	bool streaming = false;
+	bool sharded = false;
+	bool compare = false;
+	bool print_stats = false;
+	bool ingest_report = false;
+	std::string trace_file_name;
+	bool perf = false;
+	bool memstats = false;
+	bool lazy_fields = false;
+	bool hilbert = false;
+	bool batch_near = false;
+	std::string stats_json;
+	int threads = 1;
+	bool threads_given = false;
+	std::vector<char*> files;
+	for (int i = 1; i < argc; ++i) {
+		if (std::string("--streaming") == argv[i]) {
+			streaming = true;
+		} else if (std::string("--sharded") == argv[i]) {
+			sharded = true;
+		} else if (std::string("--compare") == argv[i]) {
+			compare = true;
+		} else if (std::string("--ingest-report") == argv[i]) {
+			ingest_report = true;
+		} else if (std::string("--trace") == argv[i]) {
+			if (i + 1 == argc) {
+				usage_error("--trace needs a file name");
+			}
+			trace_file_name = argv[++i];
+		} else if (std::string("--perf") == argv[i]) {
+			perf = true;
+		} else if (std::string("--memstats") == argv[i]) {
+			memstats = true;
+		} else if (std::string("--lazy-fields") == argv[i]) {
+			lazy_fields = true;
+		} else if (std::string("--hilbert") == argv[i]) {
+			hilbert = true;
+		} else if (std::string("--batch-near") == argv[i]) {
+			batch_near = true;
+		} else if (std::string("--stats") == argv[i]) {
+			print_stats = true;
+		} else if (std::string("--stats-json") == argv[i]) {
+			if (i + 1 == argc) {
+				usage_error("--stats-json needs a file name");
+			}
+			stats_json = argv[++i];
+		} else if (std::string("--threads") == argv[i]) {
+			if (i + 1 == argc) {
+				usage_error("--threads needs a number of threads");
+			}
+			threads = atoi(argv[++i]);
+			threads_given = true;
+		} else if (0 == std::string(argv[i]).compare(0, 2, "--")) {
+			usage_error(std::string("Unknown option: ") + argv[i]);
+		} else {
+			files.push_back(argv[i]);
+		}
+	}
+
+	//	the other collections do not take these options, so they are refused 
+	//	rather than ignored
+	if (1 < streaming + sharded + compare) {
+		usage_error("Only one of --streaming, --sharded and --compare can be "
+		            "given");
+	}
+	if ((hilbert || lazy_fields || memstats) && 
+	    (streaming || sharded || compare)) {
+		usage_error("--hilbert, --lazy-fields and --memstats cannot be used "
+		            "with --streaming, --sharded or --compare");
+	}
+	if (threads_given && (sharded || streaming)) {
+		usage_error("--threads cannot be used with --sharded or --streaming");
+	}
+
+	if(2 == files.size()) {
 		std::ifstream tree_file;
 		std::ifstream command_file;
-		tree_file.open(argv[1]);
-		command_file.open(argv[2]);
+		tree_file.open(files[0]);
+		command_file.open(files[1]);
 		if (tree_file.fail()) {
-			std::cerr << "Unable to open tree census file: " << argv[1] << std::endl;
+			std::cerr << "Unable to open tree census file: " << files[0] << std::endl;
 			exit(1);
 		}
 		if (command_file.fail()) {
-			std::cerr << "Unable to open commands file: " << argv[2] << std::endl;
+			std::cerr << "Unable to open commands file: " << files[1] << std::endl;
 			exit(1);
 		}
 
-		std::string line;
-		TreeCollection tree_collection;
+		if (!trace_file_name.empty() && !TraceLog::start(trace_file_name)) {
+			std::cerr << "Unable to open trace file: " << trace_file_name 
+								<< std::endl;
+			exit(1);
+		}
 
-		while(tree_file.is_open()) {
-			std::getline(tree_file, line);
-			if (tree_file.eof()) {
-				break;
-			}
-			Tree new_tree(line);
-			tree_collection.insert_tree(new_tree);
+		if (perf && !PerfProfiler::enable()) {
+			std::cerr << "Hardware performance counters are not available, so "
+								<< "--perf will not count anything" << std::endl;
+			perf = false;
 		}
 
-		Command command;
-    std::string treename;
-    int zipcode;
-    double latitude, longitude, distance;
-    bool result;
+		//	the statistics are only kept when they are asked for, so the commands
+		//	are not timed or counted otherwise
+		std::unique_ptr<CommandStats> stats;
+		if (print_stats || !stats_json.empty()) {
+			stats.reset(new CommandStats);
+		}
 
-		while (!command_file.eof()) {
-			if (!command.get_next(command_file)) {
-				if (!command_file.eof()) {
-					std::cerr << "Could not get next command.\n";
+		int status = 0;
+		if (streaming) {
+			//	the loader thread is the only writer; this thread only reads
+			ConcurrentTreeCollection tree_collection;
+			std::thread loader(
+			    [&tree_file, &tree_collection]() {
+			      load_trees(tree_file, tree_collection);
+			    });
+			status = run_commands(command_file, tree_collection, stats.get(),
+			                      batch_near);
+			loader.join();
+		} else if (sharded) {
+			ShardedTreeCollection tree_collection;
+			load_trees(tree_file, tree_collection);
+			status = run_commands(command_file, tree_collection, stats.get(),
+			                      batch_near);
+		} else if (compare) {
+			BackendComparison tree_collection;
+			std::unique_ptr<WorkStealingPool> pool;
+			if (1 != threads) {
+				pool.reset(new WorkStealingPool(threads));
+				tree_collection.set_traversal_pool(pool.get());
+			}
+			load_trees(tree_file, tree_collection);
+			status = run_commands(command_file, tree_collection, stats.get(),
+			                      batch_near);
+			tree_collection.report(std::cerr);
+			if (0 == status && 0 < tree_collection.mismatches()) {
+				status = 2;
+			}
+		} else {
+			ReloadableCollection tree_collection;
+			//	the pool is only made when it will be used, so the default does not
+			//	start any threads
+			std::unique_ptr<WorkStealingPool> pool;
+			if (1 != threads) {
+				pool.reset(new WorkStealingPool(threads));
+				tree_collection.set_traversal_pool(pool.get());
+			}
+			tree_collection.set_hilbert_order(hilbert);
+			tree_collection.set_lazy_fields(lazy_fields);
+			tree_collection.profile_ingest(ingest_report);
+			if (lazy_fields) {
+				std::shared_ptr<CensusFile> census = std::make_shared<CensusFile>();
+				if (!census->open(files[0])) {
+					std::cerr << "Unable to map tree census file: " << files[0] 
+										<< std::endl;
+					exit(1);
 				}
-				return 1;
+				load_trees(census, tree_collection);
+			} else {
+				load_trees(tree_file, tree_collection);
+			}
+			if (ingest_report) {
+				tree_collection.write_ingest_report(std::cerr);
 			}
-			command.get_args(treename, zipcode, latitude, longitude, distance,
-											 result);
-
-			switch (command.type_of()) {
-				case tree_info_cmmd:
-					tree_collection.tree_info(treename);
-					break;
-				case listall_names_cmmd:
-					tree_collection.list_all_names();
-					break;
-				case list_near_cmmd:
-					tree_collection.list_all_near(latitude, longitude, distance);
-					break;
-				case listall_inzip_cmmd:
-					tree_collection.list_all_in_zip(zipcode);
-					break;
-				case bad_cmmd:
-					std::cout << "Invalid command." << std::endl;
-					std::cout << std::endl;
-					break;
-				default:
-					break;
+			if (memstats) {
+				tree_collection.write_memory_report(std::cerr);
 			}
+			status = run_commands(command_file, tree_collection, stats.get(),
+			                      batch_near);
+		}
+		if (print_stats) {
+			stats->write_table(std::cerr);
+		}
+		if (!stats_json.empty()) {
+			std::ofstream json_file(stats_json);
+			if (json_file.fail()) {
+				std::cerr << "Unable to open statistics file: " << stats_json 
+									<< std::endl;
+			} else {
+				stats->write_json(json_file);
+			}
+		}
+		TraceLog::stop();
+		if (perf) {
+			PerfProfiler::write_report(std::cerr);
+		}
+		if (0 != status) {
+			return status;
 		}
 
 		tree_file.close();
 		command_file.close();
     
-	} else if (3 < argc) {
+	} else if (2 < files.size()) {
 		std::cerr << "ERROR: Too many arguments provided. ";
 		std::cerr << "You must provide one input file and one command file, ";
 		std::cerr << "respectively." << std::endl;
@@ -0,0 +1,239 @@
+/*******************************************************************************
+  Title          : memory_stats.cpp
+  Description    : The implementation file for the MemoryUsage struct and the
+                   MemoryReport and AllocationCounter classes, and the
+                   replacements of operator new and operator delete that count
+                   allocations
+  Purpose        : To find out how much memory each part of a TreeCollection
+                   uses, both the bytes its data needs and the bytes the
+                   allocator really gives it
+  Usage          : Call AllocationCounter::enable() first thing in main, then
+                   have each data structure add its usage to a MemoryReport
+                   and call MemoryReport::write()
+  Build with     : g++ -c -std=c++11 memory_stats.cpp
+  Modifications  :
+
+*******************************************************************************/
+
+#include "memory_stats.h"
+#include <cstdlib>
+#include <iomanip>
+#include <ios>
+#include <new>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+//	The bytes glibc's malloc keeps in front of every block
+const long long kChunkHeader = 8;
+
+//	The total the allocations of each thread are added to, if any
+static thread_local long long* scope_total = nullptr;
+
+MemoryUsage& MemoryUsage::operator+=(const MemoryUsage& other) {
+	blocks += other.blocks;
+	//	an unknown count stays unknown
+	logical_bytes = (logical_bytes < 0 || other.logical_bytes < 0) ? -1 :
+	                logical_bytes + other.logical_bytes;
+	requested_bytes = (requested_bytes < 0 || other.requested_bytes < 0) ? -1 :
+	                  requested_bytes + other.requested_bytes;
+	allocated_bytes += other.allocated_bytes;
+	return *this;
+}
+
+long long allocated_size(std::size_t requested) {
+	long long size = (requested + kChunkHeader + 15) / 16 * 16;
+	return size < 32 ? 32 : size;
+}
+
+//	Returns the bytes the allocator used for block, which requested bytes were
+//	asked for
+static long long block_size(const void* block, std::size_t requested) {
+#ifdef __GLIBC__
+	return malloc_usable_size(const_cast<void*>(block)) + kChunkHeader;
+#else
+	return allocated_size(requested);
+#endif
+}
+
+MemoryUsage heap_block_usage(const void* block, std::size_t requested,
+                             std::size_t logical) {
+	MemoryUsage usage;
+	if (block == nullptr || 0 == requested) {
+		return usage;
+	}
+	usage.blocks = 1;
+	usage.logical_bytes = logical;
+	usage.requested_bytes = requested;
+	usage.allocated_bytes = block_size(block, requested);
+	return usage;
+}
+
+MemoryUsage string_usage(const std::string& text) {
+	//	a short string keeps its characters inside the string object
+	const char* characters = text.data();
+	const char* object = reinterpret_cast<const char*>(&text);
+	if (object <= characters && characters < object + sizeof(text)) {
+		return MemoryUsage();
+	}
+	return heap_block_usage(characters, text.capacity() + 1, text.size());
+}
+
+void MemoryReport::add(const std::string& name, const MemoryUsage& usage) {
+	for (unsigned int i = 0; i < parts_.size(); ++i) {
+		if (parts_[i].first == name) {
+			parts_[i].second += usage;
+			return;
+		}
+	}
+	parts_.push_back(std::make_pair(name, usage));
+}
+
+const std::vector<std::pair<std::string, MemoryUsage> >& MemoryReport::parts()
+    const {
+	return parts_;
+}
+
+void MemoryReport::write(std::ostream& out) const {
+	out << std::left << std::setw(28) << "part" << std::right
+	    << std::setw(10) << "blocks" << std::setw(12) << "logical MB"
+	    << std::setw(14) << "requested MB" << std::setw(14) << "allocated MB"
+	    << std::setw(13) << "overhead MB" << std::endl;
+	out << std::fixed << std::setprecision(2);
+	MemoryUsage total;
+	for (unsigned int i = 0; i <= parts_.size(); ++i) {
+		//	the last line is the total of all the parts
+		const char* name = "total";
+		MemoryUsage usage = total;
+		if (i < parts_.size()) {
+			name = parts_[i].first.c_str();
+			usage = parts_[i].second;
+			total += usage;
+		}
+		out << std::left << std::setw(28) << name << std::right
+		    << std::setw(10) << usage.blocks;
+		long long counts[3] = {usage.logical_bytes, usage.requested_bytes,
+		                       usage.allocated_bytes};
+		int widths[3] = {12, 14, 14};
+		for (int c = 0; c < 3; ++c) {
+			if (counts[c] < 0) {
+				out << std::setw(widths[c]) << "-";
+			} else {
+				out << std::setw(widths[c]) << counts[c] / 1048576.0;
+			}
+		}
+		if (usage.logical_bytes < 0) {
+			out << std::setw(13) << "-";
+		} else {
+			out << std::setw(13)
+			    << (usage.allocated_bytes - usage.logical_bytes) / 1048576.0;
+		}
+		out << std::endl;
+	}
+	if (AllocationCounter::enabled()) {
+		out << "Heap: " << AllocationCounter::live_blocks() << " blocks, "
+		    << AllocationCounter::live_bytes() / 1048576.0 << " MB allocated, "
+		    << AllocationCounter::peak_bytes() / 1048576.0 << " MB peak, "
+		    << (AllocationCounter::live_bytes() - total.allocated_bytes) /
+		       1048576.0
+		    << " MB not in any part" << std::endl;
+	}
+	out.copyfmt(std::ios(nullptr));
+}
+
+std::atomic<bool> AllocationCounter::enabled_(false);
+std::atomic<long long> AllocationCounter::live_blocks_(0);
+std::atomic<long long> AllocationCounter::live_bytes_(0);
+std::atomic<long long> AllocationCounter::peak_bytes_(0);
+
+void AllocationCounter::enable() {
+	enabled_ = true;
+}
+
+void AllocationCounter::allocated(void* block, std::size_t requested) {
+	long long size = block_size(block, requested);
+	live_blocks_.fetch_add(1, std::memory_order_relaxed);
+	long long live = live_bytes_.fetch_add(size, std::memory_order_relaxed) +
+	                 size;
+	long long peak = peak_bytes_.load(std::memory_order_relaxed);
+	while (peak < live &&
+	       !peak_bytes_.compare_exchange_weak(peak, live,
+	                                          std::memory_order_relaxed)) {
+	}
+	if (scope_total != nullptr) {
+		*scope_total += size;
+	}
+}
+
+void AllocationCounter::freed(void* block) {
+	long long size = block_size(block, 0);
+	live_blocks_.fetch_sub(1, std::memory_order_relaxed);
+	live_bytes_.fetch_sub(size, std::memory_order_relaxed);
+	//	so that temporary blocks made inside a scope do not count
+	if (scope_total != nullptr) {
+		*scope_total -= size;
+	}
+}
+
+long long AllocationCounter::live_blocks() {
+	return live_blocks_.load(std::memory_order_relaxed);
+}
+
+long long AllocationCounter::live_bytes() {
+	return live_bytes_.load(std::memory_order_relaxed);
+}
+
+long long AllocationCounter::peak_bytes() {
+	return peak_bytes_.load(std::memory_order_relaxed);
+}
+
+long long* AllocationCounter::set_scope(long long* total) {
+	long long* outer = scope_total;
+	scope_total = total;
+	return outer;
+}
+
+AllocationScope::AllocationScope(long long& total)
+    : outer_(nullptr), active_(AllocationCounter::enabled()) {
+	if (active_) {
+		outer_ = AllocationCounter::set_scope(&total);
+	}
+}
+
+AllocationScope::~AllocationScope() {
+	if (active_) {
+		AllocationCounter::set_scope(outer_);
+	}
+}
+
+//	The replacements of the global operator new and operator delete. They use
+//	malloc and free like the ones in the standard library, and count each
+//	block while the AllocationCounter is enabled
+void* operator new(std::size_t size) {
+	void* block = malloc(0 == size ? 1 : size);
+	if (block == nullptr) {
+		throw std::bad_alloc();
+	}
+	if (AllocationCounter::enabled()) {
+		AllocationCounter::allocated(block, size);
+	}
+	return block;
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void operator delete(void* block) noexcept {
+	if (block == nullptr) {
+		return;
+	}
+	if (AllocationCounter::enabled()) {
+		AllocationCounter::freed(block);
+	}
+	free(block);
+}
+
+void operator delete[](void* block) noexcept {
+	operator delete(block);
+}
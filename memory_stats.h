@@ -0,0 +1,168 @@
+/*******************************************************************************
+  Title          : memory_stats.h
+  Description    : The interface file for the MemoryUsage struct and the
+                   MemoryReport and AllocationCounter classes
+  Purpose        : To find out how much memory each part of a TreeCollection
+                   uses, both the bytes its data needs and the bytes the
+                   allocator really gives it
+  Usage          : Call AllocationCounter::enable() first thing in main, then
+                   have each data structure add its usage to a MemoryReport
+                   and call MemoryReport::write()
+  Build with     : No building
+  Modifications  :
+
+*******************************************************************************/
+
+
+#ifndef __MEMORY_STATS_H__
+#define __MEMORY_STATS_H__
+
+#include <atomic>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*******************************************************************************
+
+		A MemoryUsage object describes some heap blocks. logical_bytes are the
+		bytes of data in them, requested_bytes are the bytes that were asked of
+		the allocator, which include room that vectors and strings keep for
+		growing, and allocated_bytes are the bytes the allocator used for them,
+		which include its bookkeeping and rounding. allocated_bytes minus
+		logical_bytes is what the layout costs beyond the data itself. A count
+		of -1 means it is not known
+
+*******************************************************************************/
+
+struct MemoryUsage {
+	long long blocks;
+	long long logical_bytes;
+	long long requested_bytes;
+	long long allocated_bytes;
+
+	MemoryUsage()
+	    : blocks(0), logical_bytes(0), requested_bytes(0), allocated_bytes(0) {
+	}
+
+	//	Adds the counts of other to these counts
+	MemoryUsage& operator+=(const MemoryUsage& other);
+};
+
+//	Returns the bytes the allocator uses for a block of requested bytes, if
+//	the block is not known. Blocks are rounded up to 16 bytes and have an
+//	8 byte header, as glibc's malloc does
+long long allocated_size(std::size_t requested);
+
+//	Returns the usage of the heap block at block, which requested bytes were
+//	asked for and which holds logical bytes of data. Returns no usage if block
+//	is null
+MemoryUsage heap_block_usage(const void* block, std::size_t requested,
+                             std::size_t logical);
+
+//	Returns the usage of the heap block of text, or no usage if text is short
+//	enough to be stored inside the string object
+MemoryUsage string_usage(const std::string& text);
+
+//	Returns the usage of the heap block of values, not counting the heap
+//	blocks that the values themselves point to
+template <class T>
+MemoryUsage vector_usage(const std::vector<T>& values) {
+	return heap_block_usage(values.data(), values.capacity() * sizeof(T),
+	                        values.size() * sizeof(T));
+}
+
+/*******************************************************************************
+
+		The MemoryReport class collects the MemoryUsage of each part of a data
+		structure under a name, in the order they are added, and writes them as
+		a table with their totals and, if the AllocationCounter was enabled, the
+		bytes on the heap that no part accounts for
+
+*******************************************************************************/
+
+class MemoryReport {
+ public:
+	//	Adds usage under name, or adds it to the usage already under name
+	void add(const std::string& name, const MemoryUsage& usage);
+
+	//	Returns the usage of every part, in the order they were first added
+	const std::vector<std::pair<std::string, MemoryUsage> >& parts() const;
+
+	//	Outputs a table of the blocks, logical, requested and allocated bytes
+	//	and the overhead of every part, and their totals
+	void write(std::ostream& out) const;
+
+ private:
+	std::vector<std::pair<std::string, MemoryUsage> > parts_;
+};
+
+/*******************************************************************************
+
+		The AllocationCounter class counts the blocks and bytes that operator
+		new hands out and operator delete takes back, which memory_stats.cpp
+		replaces. The bytes counted are the ones the allocator uses, which it
+		reports with malloc_usable_size. Nothing is counted until enable() is
+		called, and a block allocated before then and deleted after is taken
+		off the counts, so enable() should be called before anything is
+		allocated. An AllocationScope adds the bytes allocated on its thread
+		while it exists to a total, minus the bytes freed, which measures
+		structures that cannot be walked, like TreeSpecies
+
+*******************************************************************************/
+
+class AllocationCounter {
+ public:
+	//	Starts counting
+	static void enable();
+
+	//	Returns true if allocations are being counted
+	static bool enabled() {
+		return enabled_.load(std::memory_order_relaxed);
+	}
+
+	//	Counts block, of which requested bytes were asked for, as allocated
+	static void allocated(void* block, std::size_t requested);
+
+	//	Counts block as freed
+	static void freed(void* block);
+
+	//	Returns the number of blocks allocated and not yet freed
+	static long long live_blocks();
+
+	//	Returns the allocated bytes of the blocks not yet freed
+	static long long live_bytes();
+
+	//	Returns the largest value live_bytes has had
+	static long long peak_bytes();
+
+	//	Makes the allocations and frees of the calling thread also change total,
+	//	or stop doing so if total is null. Returns the total they changed before
+	static long long* set_scope(long long* total);
+
+ private:
+	static std::atomic<bool> enabled_;
+	static std::atomic<long long> live_blocks_;
+	static std::atomic<long long> live_bytes_;
+	static std::atomic<long long> peak_bytes_;
+};
+
+//	While an AllocationScope object exists, the bytes allocated on its thread
+//	are added to total and the bytes freed are taken off, if the
+//	AllocationCounter is enabled
+class AllocationScope {
+ public:
+	explicit AllocationScope(long long& total);
+	~AllocationScope();
+
+ private:
+	AllocationScope(const AllocationScope&);
+	AllocationScope& operator=(const AllocationScope&);
+
+	//	The total of the scope this one is inside of, or null
+	long long* outer_;
+	bool active_;
+};
+
+#endif
@@ -0,0 +1,239 @@
+/*******************************************************************************
+  Title          : nearby_batch.cpp
+  Description    : The implementation file for the NearbyBatch class
+  Purpose        : To answer many list_near commands with one pass over the
+                   trees instead of one pass for each command
+  Usage          : Make a NearbyBatch of the queries and give it every Tree,
+                   with a GroupBy for each query
+  Build with     : g++ -c -std=c++11 nearby_batch.cpp
+  Modifications  :
+
+*******************************************************************************/
+
+#include "nearby_batch.h"
+#include "haversine.h"
+#include <algorithm>
+#include <cmath>
+
+//	The radius of the Earth in kilometers that haversine uses
+const double kEarthRadius = 6372.8;
+
+const double kPi = 3.14159265358979323846;
+
+//	How much bigger than the circle the box is made, so that rounding in the
+//	box and in haversine never leaves out a Tree that is within the distance
+const double kBoxMargin = 1.001;
+
+//	The largest number of rows or columns of the grid
+const int kMaxGridSide = 256;
+
+//	The most cells a query's box may cover. A bigger one is compared with
+//	every Tree instead of being copied into all its cells
+const int kMaxCellsPerQuery = 256;
+
+NearbyBatch::NearbyBatch(const std::vector<NearbyQuery>& queries)
+    : queries_(queries), latitude_low_(0), latitude_high_(0),
+      longitude_low_(0), longitude_high_(0), cell_height_(1), cell_width_(1),
+      rows_(0), columns_(0), cell_starts_(1, 0) {
+	std::vector<NearbyBox> boxes;
+	for (unsigned int q = 0; q < queries_.size(); ++q) {
+		//	haversine is never less than 0, and comparisons with NaN are false
+		if (!(0 <= queries_[q].distance)) {
+			continue;
+		}
+		NearbyBox box;
+		box.query = q;
+		if (circle_box(queries_[q], box.latitude_low, box.latitude_high,
+		               box.longitude_low, box.longitude_high)) {
+			boxes.push_back(box);
+		} else {
+			everywhere_.push_back(q);
+		}
+	}
+	if (boxes.empty()) {
+		return;
+	}
+
+	//	the cells are the size of the median box, unless that makes too many
+	std::vector<double> heights, widths;
+	latitude_low_ = boxes[0].latitude_low;
+	latitude_high_ = boxes[0].latitude_high;
+	longitude_low_ = boxes[0].longitude_low;
+	longitude_high_ = boxes[0].longitude_high;
+	for (const NearbyBox& box : boxes) {
+		latitude_low_ = std::min(latitude_low_, box.latitude_low);
+		latitude_high_ = std::max(latitude_high_, box.latitude_high);
+		longitude_low_ = std::min(longitude_low_, box.longitude_low);
+		longitude_high_ = std::max(longitude_high_, box.longitude_high);
+		heights.push_back(box.latitude_high - box.latitude_low);
+		widths.push_back(box.longitude_high - box.longitude_low);
+	}
+	std::nth_element(heights.begin(), heights.begin() + heights.size() / 2,
+	                 heights.end());
+	std::nth_element(widths.begin(), widths.begin() + widths.size() / 2,
+	                 widths.end());
+	cell_height_ = std::max(heights[heights.size() / 2],
+	                        (latitude_high_ - latitude_low_) / kMaxGridSide);
+	cell_width_ = std::max(widths[widths.size() / 2],
+	                       (longitude_high_ - longitude_low_) / kMaxGridSide);
+	//	circles of distance 0 around the same point have empty boxes
+	if (!(0 < cell_height_)) {
+		cell_height_ = 1;
+	}
+	if (!(0 < cell_width_)) {
+		cell_width_ = 1;
+	}
+	rows_ = static_cast<int>(std::min<double>(kMaxGridSide,
+	    std::floor((latitude_high_ - latitude_low_) / cell_height_) + 1));
+	columns_ = static_cast<int>(std::min<double>(kMaxGridSide,
+	    std::floor((longitude_high_ - longitude_low_) / cell_width_) + 1));
+
+	//	count the queries of each cell, then place them, in the order of the
+	//	queries
+	std::vector<int> counts(rows_ * columns_ + 1, 0);
+	std::vector<NearbyBox> gridded;
+	for (const NearbyBox& box : boxes) {
+		int row_low = cell_of(box.latitude_low, latitude_low_, cell_height_,
+		                      rows_);
+		int row_high = cell_of(box.latitude_high, latitude_low_, cell_height_,
+		                       rows_);
+		int column_low = cell_of(box.longitude_low, longitude_low_,
+		                         cell_width_, columns_);
+		int column_high = cell_of(box.longitude_high, longitude_low_,
+		                          cell_width_, columns_);
+		if (kMaxCellsPerQuery <
+		    (row_high - row_low + 1) * (column_high - column_low + 1)) {
+			everywhere_.push_back(box.query);
+			continue;
+		}
+		for (int r = row_low; r <= row_high; ++r) {
+			for (int c = column_low; c <= column_high; ++c) {
+				++counts[r * columns_ + c + 1];
+			}
+		}
+		gridded.push_back(box);
+	}
+	cell_starts_.assign(counts.size(), 0);
+	for (unsigned int c = 1; c < counts.size(); ++c) {
+		cell_starts_[c] = cell_starts_[c - 1] + counts[c];
+	}
+	cell_boxes_.resize(cell_starts_.back());
+	std::vector<int> next(cell_starts_.begin(), cell_starts_.end() - 1);
+	for (const NearbyBox& box : gridded) {
+		int row_low = cell_of(box.latitude_low, latitude_low_, cell_height_,
+		                      rows_);
+		int row_high = cell_of(box.latitude_high, latitude_low_, cell_height_,
+		                       rows_);
+		int column_low = cell_of(box.longitude_low, longitude_low_,
+		                         cell_width_, columns_);
+		int column_high = cell_of(box.longitude_high, longitude_low_,
+		                          cell_width_, columns_);
+		for (int r = row_low; r <= row_high; ++r) {
+			for (int c = column_low; c <= column_high; ++c) {
+				cell_boxes_[next[r * columns_ + c]++] = box;
+			}
+		}
+	}
+	std::sort(everywhere_.begin(), everywhere_.end());
+}
+
+int NearbyBatch::size() const {
+	return queries_.size();
+}
+
+const NearbyQuery& NearbyBatch::query(int q) const {
+	return queries_[q];
+}
+
+int NearbyBatch::add(const Tree& tree, std::vector<GroupBy>& results) const {
+	double latitude, longitude;
+	tree.get_position(latitude, longitude);
+	int distances = 0;
+	//	haversine wraps around, so a Tree off the globe may be in any circle
+	if (!(std::fabs(latitude) <= 90 && std::fabs(longitude) <= 180)) {
+		for (unsigned int q = 0; q < queries_.size(); ++q) {
+			const NearbyQuery& query = queries_[q];
+			++distances;
+			if (query.distance >= haversine(query.latitude, query.longitude,
+			                                latitude, longitude)) {
+				results[q].add(tree);
+			}
+		}
+		return distances;
+	}
+	for (int q : everywhere_) {
+		const NearbyQuery& query = queries_[q];
+		++distances;
+		if (query.distance >= haversine(query.latitude, query.longitude,
+		                                latitude, longitude)) {
+			results[q].add(tree);
+		}
+	}
+	if (0 == rows_ || latitude < latitude_low_ || latitude_high_ < latitude ||
+	    longitude < longitude_low_ || longitude_high_ < longitude) {
+		return distances;
+	}
+	int cell = cell_of(latitude, latitude_low_, cell_height_, rows_) *
+	           columns_ +
+	           cell_of(longitude, longitude_low_, cell_width_, columns_);
+	for (int i = cell_starts_[cell]; i < cell_starts_[cell + 1]; ++i) {
+		const NearbyBox& box = cell_boxes_[i];
+		if (latitude < box.latitude_low || box.latitude_high < latitude ||
+		    longitude < box.longitude_low || box.longitude_high < longitude) {
+			continue;
+		}
+		int q = box.query;
+		const NearbyQuery& query = queries_[q];
+		++distances;
+		if (query.distance >= haversine(query.latitude, query.longitude,
+		                                latitude, longitude)) {
+			results[q].add(tree);
+		}
+	}
+	return distances;
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+bool NearbyBatch::circle_box(const NearbyQuery& query, double& latitude_low,
+                             double& latitude_high, double& longitude_low,
+                             double& longitude_high) {
+	if (!(std::fabs(query.latitude) <= 90) ||
+	    !(std::fabs(query.longitude) <= 180)) {
+		return false;
+	}
+	//	a point within distance is never more than distance / R radians of
+	//	latitude away, nor more than asin(sin(angle) / cos(latitude)) of
+	//	longitude away, unless the circle reaches a pole
+	double angle = query.distance / kEarthRadius * kBoxMargin;
+	double degrees = angle * 180 / kPi;
+	double cosine = std::cos(query.latitude * kPi / 180);
+	if (!(std::fabs(query.latitude) + degrees < 90) ||
+	    !(std::sin(angle) < cosine)) {
+		return false;
+	}
+	double longitude_degrees = std::asin(std::sin(angle) / cosine) * 180 / kPi
+	                           * kBoxMargin;
+	//	a box that crosses the 180th meridian would leave out its other side
+	if (180 < std::fabs(query.longitude) + longitude_degrees) {
+		return false;
+	}
+	latitude_low = query.latitude - degrees;
+	latitude_high = query.latitude + degrees;
+	longitude_low = query.longitude - longitude_degrees;
+	longitude_high = query.longitude + longitude_degrees;
+	return true;
+}
+
+int NearbyBatch::cell_of(double coordinate, double low, double size,
+                         int cells) {
+	double cell = std::floor((coordinate - low) / size);
+	if (!(0 < cell)) {
+		return 0;
+	}
+	return cell < cells - 1 ? static_cast<int>(cell) : cells - 1;
+}
@@ -0,0 +1,109 @@
+/*******************************************************************************
+  Title          : nearby_batch.h
+  Description    : The interface file for the NearbyBatch class
+  Purpose        : To answer many list_near commands with one pass over the
+                   trees instead of one pass for each command
+  Usage          : Make a NearbyBatch of the queries and give it every Tree,
+                   with a GroupBy for each query
+  Build with     : No building
+  Modifications  :
+
+*******************************************************************************/
+
+
+#ifndef __NEARBY_BATCH_H__
+#define __NEARBY_BATCH_H__
+
+#include "group_by.h"
+#include "tree.h"
+#include <vector>
+
+//	The largest number of list_near commands that are answered together
+const int kNearbyBatchQueries = 4096;
+
+//	A list_near command: the Trees within distance kilometers of (latitude,
+//	longitude)
+struct NearbyQuery {
+	double latitude;
+	double longitude;
+	double distance;
+};
+
+//	The box in degrees around the circle of a query in the grid of a 
+//	NearbyBatch, including its edges
+struct NearbyBox {
+	int query;
+	double latitude_low;
+	double latitude_high;
+	double longitude_low;
+	double longitude_high;
+};
+
+/*******************************************************************************
+
+		The NearbyBatch class indexes the circles of a batch of NearbyQuery
+		objects so that each Tree is only compared with the circles it may be
+		in. The box around each circle is put in every cell it covers of a grid
+		over all the boxes, whose cells are about as big as the box of a usual
+		query. A Tree is compared, with the same haversine test as list_near,
+		with the queries in its cell whose boxes hold it and with the few queries
+		whose boxes are too big for the grid or cannot be drawn, like circles that
+		reach a pole or the 180th meridian. Queries whose distance is negative or
+		not a number never hold a Tree and are left out. So a pass over N Trees
+		does about N lookups plus a test for each Tree in or near each circle,
+		instead of a test for every Tree and every query
+
+*******************************************************************************/
+
+class NearbyBatch {
+ public:
+	//	Creates a NearbyBatch of queries, which keep their order
+	explicit NearbyBatch(const std::vector<NearbyQuery>& queries);
+
+	//	Returns the number of queries
+	int size() const;
+
+	//	Returns query q, counting from 0 in the order they were given
+	const NearbyQuery& query(int q) const;
+
+	//	Counts tree in results[q] for every query q that holds it. results has
+	//	a GroupBy for each query. Returns the number of distances computed
+	int add(const Tree& tree, std::vector<GroupBy>& results) const;
+
+ protected:
+	//	Sets the edges of the box in degrees that holds every point within
+	//	query's distance. Returns false if no such box can be drawn
+	static bool circle_box(const NearbyQuery& query, double& latitude_low,
+	                       double& latitude_high, double& longitude_low,
+	                       double& longitude_high);
+
+	//	Returns the row or column of the grid of coordinate, whose lowest
+	//	value is low and whose cells are size degrees wide, kept inside the
+	//	cells count of them
+	static int cell_of(double coordinate, double low, double size, int cells);
+
+ private:
+	std::vector<NearbyQuery> queries_;
+
+	//	The queries that every Tree is compared with
+	std::vector<int> everywhere_;
+
+	//	The edges and cell sizes in degrees and the number of rows and columns
+	//	of the grid
+	double latitude_low_;
+	double latitude_high_;
+	double longitude_low_;
+	double longitude_high_;
+	double cell_height_;
+	double cell_width_;
+	int rows_;
+	int columns_;
+
+	//	The boxes of the queries of cell c are cell_boxes_[cell_starts_[c]] up 
+	//	to but not including cell_boxes_[cell_starts_[c + 1]]. Cells are 
+	//	numbered row by row
+	std::vector<int> cell_starts_;
+	std::vector<NearbyBox> cell_boxes_;
+};
+
+#endif
@@ -0,0 +1,208 @@
+/*******************************************************************************
+  Title          : perf_profiler.cpp
+  Description    : The implementation file for the PerfProfiler and PerfRegion
+                   classes
+  Purpose        : To count the processor cycles, instructions, last level
+                   cache misses and branch misses of the hot parts of the
+                   program, like descending the AVL_Tree, with the processor's
+                   hardware counters
+  Usage          : Call PerfProfiler::enable(), put a PerfRegion object in each
+                   block to measure, and call PerfProfiler::write_report()
+  Build with     : g++ -c -std=c++11 perf_profiler.cpp
+  Modifications  :
+
+*******************************************************************************/
+
+#include "perf_profiler.h"
+#include <cstring>
+#include <iomanip>
+#include <ios>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+std::atomic<bool> PerfProfiler::enabled_(false);
+std::mutex PerfProfiler::mutex_;
+std::map<std::string, PerfTotals> PerfProfiler::totals_;
+
+//	The counters one thread opened. leader is -1 if they could not be opened,
+//	and ids are the kernel's ids of the events in the group, or 0 for the
+//	events that could not be opened
+struct ThreadCounters {
+	bool opened;
+	int leader;
+	unsigned long long ids[kNumberOfPerfEvents];
+};
+
+static thread_local ThreadCounters thread_counters_state = {false, -1, {0}};
+
+bool PerfProfiler::enable() {
+	if (thread_counters() < 0) {
+		return false;
+	}
+	enabled_ = true;
+	return true;
+}
+
+bool PerfProfiler::read(long long* counts) {
+#ifdef __linux__
+	int leader = thread_counters();
+	if (leader < 0) {
+		return false;
+	}
+	//	the layout of a read of a group with PERF_FORMAT_GROUP | PERF_FORMAT_ID
+	struct {
+		unsigned long long number;
+		struct {
+			unsigned long long value;
+			unsigned long long id;
+		} values[kNumberOfPerfEvents];
+	} group;
+	if (::read(leader, &group, sizeof(group)) <= 0) {
+		return false;
+	}
+	for (int e = 0; e < kNumberOfPerfEvents; ++e) {
+		counts[e] = -1;
+		for (unsigned int v = 0; v < group.number && v < kNumberOfPerfEvents;
+		     ++v) {
+			if (0 != thread_counters_state.ids[e] &&
+			    group.values[v].id == thread_counters_state.ids[e]) {
+				counts[e] = group.values[v].value;
+			}
+		}
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+void PerfProfiler::add(const char* name, const long long* start,
+                       const long long* end) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	PerfTotals& totals = totals_[name];
+	++totals.calls;
+	for (int e = 0; e < kNumberOfPerfEvents; ++e) {
+		if (start[e] < 0 || end[e] < 0) {
+			totals.counts[e] = -1;
+		} else if (0 <= totals.counts[e]) {
+			totals.counts[e] += end[e] - start[e];
+		}
+	}
+}
+
+void PerfProfiler::write_report(std::ostream& out) {
+	std::lock_guard<std::mutex> lock(mutex_);
+	out << std::left << std::setw(24) << "region" << std::right
+	    << std::setw(10) << "calls";
+	for (int e = 0; e < kNumberOfPerfEvents; ++e) {
+		out << std::setw(15) << event_name(static_cast<PerfEvent>(e));
+	}
+	out << std::setw(8) << "IPC" << std::setw(12) << "LLC/kinst"
+	    << std::setw(12) << "br/kinst" << std::endl;
+	out << std::fixed << std::setprecision(2);
+	std::map<std::string, PerfTotals>::const_iterator it;
+	for (it = totals_.begin(); it != totals_.end(); ++it) {
+		const PerfTotals& totals = it->second;
+		out << std::left << std::setw(24) << it->first << std::right
+		    << std::setw(10) << totals.calls;
+		for (int e = 0; e < kNumberOfPerfEvents; ++e) {
+			if (totals.counts[e] < 0) {
+				out << std::setw(15) << "-";
+			} else {
+				out << std::setw(15) << totals.counts[e];
+			}
+		}
+		long long cycles = totals.counts[CYCLES_EVENT];
+		long long instructions = totals.counts[INSTRUCTIONS_EVENT];
+		if (0 < cycles && 0 <= instructions) {
+			out << std::setw(8) << static_cast<double>(instructions) / cycles;
+		} else {
+			out << std::setw(8) << "-";
+		}
+		for (int e = CACHE_MISSES_EVENT; e <= BRANCH_MISSES_EVENT; ++e) {
+			if (0 < instructions && 0 <= totals.counts[e]) {
+				out << std::setw(12) << 1000.0 * totals.counts[e] / instructions;
+			} else {
+				out << std::setw(12) << "-";
+			}
+		}
+		out << std::endl;
+	}
+	out.copyfmt(std::ios(nullptr));
+}
+
+const char* PerfProfiler::event_name(PerfEvent event) {
+	switch (event) {
+		case CYCLES_EVENT:
+			return "cycles";
+		case INSTRUCTIONS_EVENT:
+			return "instructions";
+		case CACHE_MISSES_EVENT:
+			return "LLC misses";
+		case BRANCH_MISSES_EVENT:
+			return "branch misses";
+		default:
+			return "unknown";
+	}
+}
+
+PerfRegion::PerfRegion(const char* name)
+    : name_(name), active_(PerfProfiler::enabled()) {
+	if (active_) {
+		active_ = PerfProfiler::read(start_);
+	}
+}
+
+PerfRegion::~PerfRegion() {
+	long long end[kNumberOfPerfEvents];
+	if (active_ && PerfProfiler::read(end)) {
+		PerfProfiler::add(name_, start_, end);
+	}
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+int PerfProfiler::thread_counters() {
+	ThreadCounters& state = thread_counters_state;
+	if (state.opened) {
+		return state.leader;
+	}
+	state.opened = true;
+#ifdef __linux__
+	const unsigned long long configs[kNumberOfPerfEvents] = {
+		PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+	for (int e = 0; e < kNumberOfPerfEvents; ++e) {
+		perf_event_attr attributes;
+		memset(&attributes, 0, sizeof(attributes));
+		attributes.size = sizeof(attributes);
+		attributes.type = PERF_TYPE_HARDWARE;
+		attributes.config = configs[e];
+		attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+		attributes.exclude_kernel = 1;
+		attributes.exclude_hv = 1;
+		//	the first event that opens leads the group, so one read gets them all
+		int fd = syscall(__NR_perf_event_open, &attributes, 0, -1, state.leader,
+		                 0);
+		if (fd < 0) {
+			continue;
+		}
+		if (state.leader < 0) {
+			state.leader = fd;
+		}
+		unsigned long long id = 0;
+		if (0 == ioctl(fd, PERF_EVENT_IOC_ID, &id)) {
+			state.ids[e] = id;
+		}
+	}
+#endif
+	return state.leader;
+}
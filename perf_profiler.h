@@ -0,0 +1,127 @@
+/*******************************************************************************
+  Title          : perf_profiler.h
+  Description    : The interface file for the PerfProfiler and PerfRegion
+                   classes
+  Purpose        : To count the processor cycles, instructions, last level
+                   cache misses and branch misses of the hot parts of the
+                   program, like descending the AVL_Tree, with the processor's
+                   hardware counters
+  Usage          : Call PerfProfiler::enable(), put a PerfRegion object in each
+                   block to measure, and call PerfProfiler::write_report()
+  Build with     : No building
+  Modifications  :
+
+*******************************************************************************/
+
+
+#ifndef __PERF_PROFILER_H__
+#define __PERF_PROFILER_H__
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+//	The hardware events that PerfProfiler counts
+enum PerfEvent {CYCLES_EVENT, INSTRUCTIONS_EVENT, CACHE_MISSES_EVENT,
+                BRANCH_MISSES_EVENT};
+
+//	The number of values of PerfEvent
+const int kNumberOfPerfEvents = 4;
+
+//	The counts of one region. A count is -1 if its event could not be opened
+struct PerfTotals {
+	long long calls;
+	long long counts[kNumberOfPerfEvents];
+
+	PerfTotals() : calls(0) {
+		for (int e = 0; e < kNumberOfPerfEvents; ++e) {
+			counts[e] = 0;
+		}
+	}
+};
+
+/*******************************************************************************
+
+		The PerfProfiler class opens the Linux perf_event_open counters for
+		cycles, instructions, last level cache misses and branch misses, counting
+		only the user mode code of the thread that opened them, and adds up what
+		they count inside each PerfRegion by the region's name. Each thread that
+		starts a region opens its own counters the first time. Reading the
+		counters is a system call, so a region costs about a microsecond and
+		should only be put around work that takes longer than that, or the
+		report should be read as a comparison between layouts rather than as
+		exact costs. Counts of regions inside other regions are also part of the
+		outer region's counts. If the kernel does not allow the counters, which
+		is usual in containers or when perf_event_paranoid is high, enable()
+		returns false and every region does nothing
+
+*******************************************************************************/
+
+class PerfProfiler {
+ public:
+	//	Starts counting in every PerfRegion. Returns false if the counters
+	//	cannot be opened, in which case nothing is counted
+	static bool enable();
+
+	//	Returns true if the PerfRegions are counting
+	static bool enabled() {
+		return enabled_.load(std::memory_order_relaxed);
+	}
+
+	//	Reads the counters of the calling thread into counts, which has
+	//	kNumberOfPerfEvents entries. Returns false if they could not be read
+	static bool read(long long* counts);
+
+	//	Adds the difference between end and start to the region called name
+	static void add(const char* name, const long long* start,
+	                const long long* end);
+
+	//	Outputs a table of the calls, counts, instructions per cycle and misses
+	//	per thousand instructions of every region
+	static void write_report(std::ostream& out);
+
+	//	Returns the name of event in the report
+	static const char* event_name(PerfEvent event);
+
+ protected:
+	//	Opens the counters of the calling thread if it has not opened them yet
+	//	Returns the file descriptor of the group leader, or -1 if the counters
+	//	cannot be opened
+	static int thread_counters();
+
+ private:
+	static std::atomic<bool> enabled_;
+	static std::mutex mutex_;
+	static std::map<std::string, PerfTotals> totals_;
+};
+
+/*******************************************************************************
+
+		A PerfRegion object counts from when it is made until it is destroyed,
+		and adds the counts to the region called name in the PerfProfiler, if
+		the PerfProfiler is enabled. Otherwise it only checks one flag
+
+*******************************************************************************/
+
+class PerfRegion {
+ public:
+	//	Starts counting the region called name
+	explicit PerfRegion(const char* name);
+
+	//	Stops counting and adds the counts to the region
+	~PerfRegion();
+
+ private:
+	PerfRegion(const PerfRegion&);
+	PerfRegion& operator=(const PerfRegion&);
+
+	const char* name_;
+
+	//	True if the counters were read when the region started
+	bool active_;
+	long long start_[kNumberOfPerfEvents];
+};
+
+#endif
@@ -0,0 +1,515 @@
+/*******************************************************************************
+  Title          : persistent_avl.cpp
+  Description    : The implementation file for the PersistentAVL class
+  Purpose        : To store the trees of the 2015 NYC Street Tree Census in an
+                   AVL tree whose old versions stay readable after it changes
+  Usage          : Use snapshot() to get a copy of the tree that will not
+                   change while the original keeps having trees inserted and
+                   removed
+  Build with     : g++ -c -std=c++11 persistent_avl.cpp
+  Modifications  :
+
+*******************************************************************************/
+
+#include "persistent_avl.h"
+#include "avl.h"
+#include "haversine.h"
+#include "work_counters.h"
+#include <algorithm>
+#include <cctype>
+
+PersistentAVL::PersistentAVL() {
+	root_ = nullptr;
+}
+
+PersistentAVL::PersistentAVL(const PersistentAVL& tree) {
+	root_ = tree.root_;
+	acquire(root_);
+}
+
+PersistentAVL::~PersistentAVL() {
+	release(root_);
+}
+
+PersistentAVL& PersistentAVL::operator=(const PersistentAVL& tree) {
+	//	acquire first so that assigning a PersistentAVL to itself is safe
+	acquire(tree.root_);
+	release(root_);
+	root_ = tree.root_;
+	return *this;
+}
+
+PersistentAVL PersistentAVL::snapshot() const {
+	return PersistentAVL(*this);
+}
+
+bool PersistentAVL::empty() const {
+	return root_ == nullptr;
+}
+
+int PersistentAVL::get_number_of_trees() const {
+	return size(root_);
+}
+
+int PersistentAVL::height() const {
+	return height(root_);
+}
+
+const Tree& PersistentAVL::find(const Tree& x) const {
+	const PersistentNode* node = root_;
+	while (node != nullptr) {
+		if (x < node->data) {
+			node = node->left_child;
+		} else if (node->data < x) {
+			node = node->right_child;
+		} else {
+			return node->data;
+		}
+	}
+	return kNotFound.data;
+}
+
+int PersistentAVL::rank(const Tree& x) const {
+	int count = 0;
+	const PersistentNode* node = root_;
+	while (node != nullptr) {
+		if (node->data < x) {
+			count += size(node->left_child) + 1;
+			node = node->right_child;
+		} else {
+			node = node->left_child;
+		}
+	}
+	return count;
+}
+
+const Tree& PersistentAVL::select(int i) const {
+	if (i < 0 || get_number_of_trees() <= i) {
+		return kNotFound.data;
+	}
+	const PersistentNode* node = root_;
+	while (node != nullptr) {
+		int left_size = size(node->left_child);
+		if (i < left_size) {
+			node = node->left_child;
+		} else if (i == left_size) {
+			return node->data;
+		} else {
+			i -= left_size + 1;
+			node = node->right_child;
+		}
+	}
+	return kNotFound.data;
+}
+
+std::list<Tree> PersistentAVL::findallmatches(const Tree& x) const {
+	std::list<Tree> match_list;
+	std::string spc = stored_name(x.common_name());
+	if (0 == count_name(spc)) {
+		return match_list;
+	}
+	Tree z(0, 0, "", "", spc, 0, "", "", 0, 0);
+	findallmatches(z, root_, match_list);
+	return match_list;
+}
+
+int PersistentAVL::count_species(const std::string& name_of_species) const {
+	return count_name(stored_name(name_of_species));
+}
+
+std::list<std::string> PersistentAVL::all_in_zipcode(const int& zip) const {
+	std::list<std::string> match_list;
+	//	check if zip is a possible zipcode
+	if (99999 < zip) {
+		return match_list;
+	}
+	WorkCounters::add_trees_visited(size(root_));
+	all_in_zipcode(zip, root_, match_list);
+	return match_list;
+}
+
+std::list<std::string> PersistentAVL::all_nearby(const double& latitude,
+																								 const double& longitude,
+																								 const double& distance) const {
+	std::list<std::string> match_list;
+	WorkCounters::add_trees_visited(size(root_));
+	WorkCounters::add_haversines(size(root_));
+	all_nearby(latitude, longitude, distance, root_, match_list);
+	return match_list;
+}
+
+void PersistentAVL::group_all(GroupBy& groups) const {
+	WorkCounters::add_trees_visited(size(root_));
+	group_all(root_, groups);
+}
+
+void PersistentAVL::group_in_zipcode(const int& zip, GroupBy& groups) const {
+	if (99999 < zip) {
+		return;
+	}
+	WorkCounters::add_trees_visited(size(root_));
+	group_in_zipcode(zip, root_, groups);
+}
+
+void PersistentAVL::group_nearby(const double& latitude,
+																 const double& longitude,
+																 const double& distance,
+																 GroupBy& groups) const {
+	WorkCounters::add_trees_visited(size(root_));
+	WorkCounters::add_haversines(size(root_));
+	group_nearby(latitude, longitude, distance, root_, groups);
+}
+
+long long PersistentAVL::for_each_in_box(const std::vector<CoordinateBox>& 
+                                         boxes, const TreeVisitor& visit) 
+                                         const {
+	for_each(visit, root_);
+	return size(root_);
+}
+
+void PersistentAVL::print(std::ostream& out) const {
+	print(out, root_);
+}
+
+void PersistentAVL::print(std::ostream& out, int first, int last) const {
+	print(out, root_, 0, first, last);
+}
+
+void PersistentAVL::clear() {
+	release(root_);
+	root_ = nullptr;
+}
+
+bool PersistentAVL::insert(const Tree& x) {
+	const PersistentNode* new_root = insert(x, root_);
+	if (new_root == nullptr) {
+		return false;
+	}
+	release(root_);
+	root_ = new_root;
+	return true;
+}
+
+bool PersistentAVL::remove(const Tree& x) {
+	bool removed = false;
+	const PersistentNode* new_root = remove(x, root_, removed);
+	if (!removed) {
+		return false;
+	}
+	release(root_);
+	root_ = new_root;
+	return true;
+}
+
+const PersistentNode* PersistentAVL::root() const {
+	return root_;
+}
+
+void PersistentAVL::acquire(const PersistentNode* node) {
+	if (node != nullptr) {
+		node->references.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+void PersistentAVL::release(const PersistentNode* node) {
+	if (node == nullptr) {
+		return;
+	}
+	if (1 == node->references.fetch_sub(1, std::memory_order_acq_rel)) {
+		release(node->left_child);
+		release(node->right_child);
+		delete node;
+	}
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+int PersistentAVL::height(const PersistentNode* node) {
+	if (node == nullptr) {
+		return -1;
+	}
+	return node->height;
+}
+
+int PersistentAVL::size(const PersistentNode* node) {
+	if (node == nullptr) {
+		return 0;
+	}
+	return node->size;
+}
+
+const PersistentNode* PersistentAVL::make_node(const Tree& data,
+																							 const PersistentNode* left,
+																							 const PersistentNode* right) {
+	acquire(left);
+	acquire(right);
+	return new PersistentNode(data, left, right,
+														std::max(height(left), height(right)) + 1,
+														size(left) + size(right) + 1);
+}
+
+//	every rotation builds the rotated nodes again instead of relinking them,
+//	since the old nodes may still be part of another version
+const PersistentNode* PersistentAVL::balance(const Tree& data,
+																						 const PersistentNode* left,
+																						 const PersistentNode* right) {
+	const PersistentNode* new_left;
+	const PersistentNode* new_right;
+	const PersistentNode* new_root;
+	if (height(left) - height(right) == 2) {
+		if (height(left->left_child) >= height(left->right_child)) {
+			//	LL rotation
+			new_right = make_node(data, left->right_child, right);
+			new_root = make_node(left->data, left->left_child, new_right);
+			release(new_right);
+		} else {
+			//	LR rotation
+			const PersistentNode* middle = left->right_child;
+			new_left = make_node(left->data, left->left_child, middle->left_child);
+			new_right = make_node(data, middle->right_child, right);
+			new_root = make_node(middle->data, new_left, new_right);
+			release(new_left);
+			release(new_right);
+		}
+		return new_root;
+	} else if (height(right) - height(left) == 2) {
+		if (height(right->right_child) >= height(right->left_child)) {
+			//	RR rotation
+			new_left = make_node(data, left, right->left_child);
+			new_root = make_node(right->data, new_left, right->right_child);
+			release(new_left);
+		} else {
+			//	RL rotation
+			const PersistentNode* middle = right->left_child;
+			new_left = make_node(data, left, middle->left_child);
+			new_right = make_node(right->data, middle->right_child,
+														right->right_child);
+			new_root = make_node(middle->data, new_left, new_right);
+			release(new_left);
+			release(new_right);
+		}
+		return new_root;
+	}
+	return make_node(data, left, right);
+}
+
+const PersistentNode* PersistentAVL::insert(const Tree& x,
+																						const PersistentNode* node) {
+	if (node == nullptr) {
+		return make_node(x, nullptr, nullptr);
+	}
+	const PersistentNode* child;
+	const PersistentNode* new_node;
+	if (x < node->data) {
+		child = insert(x, node->left_child);
+		if (child == nullptr) {
+			return nullptr;
+		}
+		new_node = balance(node->data, child, node->right_child);
+	} else if (node->data < x) {
+		child = insert(x, node->right_child);
+		if (child == nullptr) {
+			return nullptr;
+		}
+		new_node = balance(node->data, node->left_child, child);
+	} else {
+		return nullptr;
+	}
+	release(child);
+	return new_node;
+}
+
+const PersistentNode* PersistentAVL::remove(const Tree& x,
+																						const PersistentNode* node,
+																						bool& removed) {
+	if (node == nullptr) {
+		removed = false;
+		return nullptr;
+	}
+	const PersistentNode* child;
+	const PersistentNode* new_node;
+	if (x < node->data) {
+		child = remove(x, node->left_child, removed);
+		if (!removed) {
+			return nullptr;
+		}
+		new_node = balance(node->data, child, node->right_child);
+	} else if (node->data < x) {
+		child = remove(x, node->right_child, removed);
+		if (!removed) {
+			return nullptr;
+		}
+		new_node = balance(node->data, node->left_child, child);
+	} else {
+		removed = true;
+		if (node->left_child == nullptr) {
+			acquire(node->right_child);
+			return node->right_child;
+		} else if (node->right_child == nullptr) {
+			acquire(node->left_child);
+			return node->left_child;
+		}
+		//	replace x with its inorder successor, which is removed from the right
+		//	subtree
+		const PersistentNode* successor = node->right_child;
+		while (successor->left_child != nullptr) {
+			successor = successor->left_child;
+		}
+		bool successor_removed;
+		child = remove(successor->data, node->right_child, successor_removed);
+		new_node = balance(successor->data, node->left_child, child);
+	}
+	release(child);
+	return new_node;
+}
+
+int PersistentAVL::name_rank(const Tree& z, bool or_equal) const {
+	int count = 0;
+	const PersistentNode* node = root_;
+	while (node != nullptr) {
+		if (islessname(node->data, z) || (or_equal && samename(node->data, z))) {
+			count += size(node->left_child) + 1;
+			node = node->right_child;
+		} else {
+			node = node->left_child;
+		}
+	}
+	return count;
+}
+
+int PersistentAVL::count_name(const std::string& species) const {
+	Tree z(0, 0, "", "", species, 0, "", "", 0, 0);
+	return name_rank(z, true) - name_rank(z, false);
+}
+
+std::string PersistentAVL::stored_name(const std::string& species_name) const {
+	std::string spc = species_name;
+	for (char& c : spc) {
+		if (isupper(c)) {
+			c = tolower(c);
+		}
+	}
+	if (0 == count_name(spc) && !spc.empty()) {
+		//	the same change as AVL_Tree::change_case
+		if (islower(spc[0])) {
+			spc[0] = toupper(spc[0]);
+		} else if (ispunct(spc[0]) && 1 < spc.size()) {
+			spc[1] = toupper(spc[1]);
+		}
+	}
+	return spc;
+}
+
+void PersistentAVL::findallmatches(const Tree& z, const PersistentNode* node,
+																	 std::list<Tree>& match_list) const {
+	if (node == nullptr) {
+		return;
+	} else if (islessname(node->data, z)) {
+		findallmatches(z, node->right_child, match_list);
+	} else if (islessname(z, node->data)) {
+		findallmatches(z, node->left_child, match_list);
+	} else {
+		findallmatches(z, node->left_child, match_list);
+		match_list.push_back(node->data);
+		findallmatches(z, node->right_child, match_list);
+	}
+}
+
+void PersistentAVL::all_in_zipcode(const int& zip, const PersistentNode* node,
+																	 std::list<std::string>& match_list) const {
+	if (node == nullptr) {
+		return;
+	}
+	all_in_zipcode(zip, node->left_child, match_list);
+	if (zip == node->data.zip()) {
+		match_list.push_back(node->data.common_name());
+	}
+	all_in_zipcode(zip, node->right_child, match_list);
+}
+
+void PersistentAVL::all_nearby(const double& latitude, const double& longitude,
+															 const double& distance,
+															 const PersistentNode* node,
+															 std::list<std::string>& match_list) const {
+	if (node == nullptr) {
+		return;
+	}
+	all_nearby(latitude, longitude, distance, node->left_child, match_list);
+	double tree_lat, tree_lon;
+	node->data.get_position(tree_lat, tree_lon);
+	if (distance >= haversine(latitude, longitude, tree_lat, tree_lon)) {
+		match_list.push_back(node->data.common_name());
+	}
+	all_nearby(latitude, longitude, distance, node->right_child, match_list);
+}
+
+void PersistentAVL::group_all(const PersistentNode* node, GroupBy& groups)
+		const {
+	while (node != nullptr) {
+		group_all(node->left_child, groups);
+		groups.add(node->data);
+		node = node->right_child;
+	}
+}
+
+void PersistentAVL::group_in_zipcode(const int& zip, const PersistentNode* node,
+																		 GroupBy& groups) const {
+	while (node != nullptr) {
+		group_in_zipcode(zip, node->left_child, groups);
+		if (zip == node->data.zip()) {
+			groups.add(node->data);
+		}
+		node = node->right_child;
+	}
+}
+
+void PersistentAVL::group_nearby(const double& latitude,
+																 const double& longitude,
+																 const double& distance,
+																 const PersistentNode* node,
+																 GroupBy& groups) const {
+	double tree_lat, tree_lon;
+	while (node != nullptr) {
+		group_nearby(latitude, longitude, distance, node->left_child, groups);
+		node->data.get_position(tree_lat, tree_lon);
+		if (distance >= haversine(latitude, longitude, tree_lat, tree_lon)) {
+			groups.add(node->data);
+		}
+		node = node->right_child;
+	}
+}
+
+void PersistentAVL::for_each(const TreeVisitor& visit, 
+                             const PersistentNode* node) const {
+	while (node != nullptr) {
+		for_each(visit, node->left_child);
+		visit(node->data);
+		node = node->right_child;
+	}
+}
+
+void PersistentAVL::print(std::ostream& out, const PersistentNode* node) const {
+	if (node == nullptr) {
+		return;
+	}
+	print(out, node->left_child);
+	out << node->data;
+	print(out, node->right_child);
+}
+
+void PersistentAVL::print(std::ostream& out, const PersistentNode* node,
+													int offset, int first, int last) const {
+	if (node == nullptr || last <= offset || offset + node->size <= first) {
+		return;
+	}
+	int node_rank = offset + size(node->left_child);
+	print(out, node->left_child, offset, first, last);
+	if (first <= node_rank && node_rank < last) {
+		out << node->data;
+	}
+	print(out, node->right_child, node_rank + 1, first, last);
+}
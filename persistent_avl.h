@@ -0,0 +1,242 @@
+/*******************************************************************************
+  Title          : persistent_avl.h
+  Description    : The interface file for the PersistentAVL class
+  Purpose        : To store the trees of the 2015 NYC Street Tree Census in an
+                   AVL tree whose old versions stay readable after it changes
+  Usage          : Use snapshot() to get a copy of the tree that will not
+                   change while the original keeps having trees inserted and
+                   removed
+  Build with     : No building
+  Modifications  :
+
+*******************************************************************************/
+
+
+#ifndef __PERSISTENT_AVL_H__
+#define __PERSISTENT_AVL_H__
+
+#include "tree.h"
+#include "group_by.h"
+#include "tree_index.h"
+#include <atomic>
+#include <list>
+#include <ostream>
+
+/*******************************************************************************
+
+		The PersistentNode struct is a node of a PersistentAVL. Once it is made it
+		never changes, so any number of PersistentAVL objects can share it. The
+		references member counts how many parents and PersistentAVL objects point
+		to it and the PersistentNode is deleted when the count drops to 0. The
+		count is atomic so that PersistentAVL objects on different threads can
+		share nodes
+
+*******************************************************************************/
+
+struct PersistentNode {
+	const Tree data;
+	const PersistentNode* const left_child;
+	const PersistentNode* const right_child;
+	const int height;
+	const int size;
+	mutable std::atomic<int> references;
+
+	PersistentNode(const Tree& some_data, const PersistentNode* left_node,
+								 const PersistentNode* right_node, int node_height,
+								 int node_size)
+			: data(some_data), left_child(left_node), right_child(right_node),
+				height(node_height), size(node_size), references(1) {
+	}
+};
+
+/*******************************************************************************
+
+		The PersistentAVL class stores Tree objects in the same order as AVL_Tree,
+		using the spc_common member as the primary key and the tree_id as the
+		secondary key, and answers the same queries. The difference is that its
+		nodes are never changed. Inserting or removing a Tree makes new copies of
+		only the nodes on the path from the root to the Tree, O(log n) of them,
+		and the new path points to the untouched subtrees of the old version.
+		Copying a PersistentAVL, or calling snapshot(), only copies the root
+		pointer and adds a reference to it, so it takes constant time, and the
+		copy keeps seeing exactly the Trees that were stored when it was made.
+		Nodes that no version points to any more are deleted when the last
+		reference to them is released
+
+*******************************************************************************/
+
+class PersistentAVL {
+ public:
+	//	Default constructor for PersistentAVL object
+	PersistentAVL();
+
+	//	Makes this PersistentAVL object share all the nodes of tree
+	//	This takes constant time
+	PersistentAVL(const PersistentAVL& tree);
+
+	//	Releases the nodes of this PersistentAVL object
+	~PersistentAVL();
+
+	//	Makes this PersistentAVL object share all the nodes of tree and returns it
+	PersistentAVL& operator=(const PersistentAVL& tree);
+
+	//	Returns a PersistentAVL object that will keep storing the Tree objects
+	//	stored now, no matter what is inserted into or removed from this one
+	PersistentAVL snapshot() const;
+
+	//	Returns true if PersistentAVL object contains no trees
+	bool empty() const;
+
+	//	Returns the number of Tree objects in PersistentAVL object
+	int get_number_of_trees() const;
+
+	//	Returns the height of the PersistentAVL
+	int height() const;
+
+	//	Returns the stored Tree object that is equal to x if x is found.
+	//	Otherwise, returns the Tree object stored in kNotFound
+	const Tree& find(const Tree& x) const;
+
+	//	Returns the number of Tree objects that are less than x
+	int rank(const Tree& x) const;
+
+	//	Returns the Tree object whose rank is i, counting from 0
+	//	If i is out of range, returns the Tree object stored in kNotFound
+	const Tree& select(int i) const;
+
+	//	Returns a list of Tree objects whose spc_common member is equal to
+	//	x's spc_common member, using the same rules as AVL_Tree::findallmatches
+	std::list<Tree> findallmatches(const Tree& x) const;
+
+	//	Returns the number of Tree objects whose spc_common member equals
+	//	name_of_species, using the same rules as AVL_Tree::count_species
+	int count_species(const std::string& name_of_species) const;
+
+	//	Returns a list of the spc_common members of all the Tree objects found in
+	//	the given zipcode, in order. The returned list will contain duplicates
+	std::list<std::string> all_in_zipcode(const int& zip) const;
+
+	//	Returns a list of the spc_common members of all the Tree objects found
+	//	within the given distance of the given latitude and longitude
+	//	coordinates in kilometers, in order
+	std::list<std::string> all_nearby(const double& latitude,
+																		const double& longitude,
+																		const double& distance) const;
+
+	//	Counts every Tree object in groups
+	void group_all(GroupBy& groups) const;
+
+	//	Counts the Tree objects found in the given zipcode in groups
+	void group_in_zipcode(const int& zip, GroupBy& groups) const;
+
+	//	Counts the Tree objects found within the given distance of the given
+	//	coordinates in groups
+	void group_nearby(const double& latitude, const double& longitude,
+										const double& distance, GroupBy& groups) const;
+
+	//	Calls visit with every Tree object, as TreeIndex::for_each_in_box may,
+	//	so that group_nearby_batch and group_in_corridor work on a 
+	//	PersistentAVL. Returns the number of Trees read
+	long long for_each_in_box(const std::vector<CoordinateBox>& boxes,
+	                          const TreeVisitor& visit) const;
+
+	//	Prints all the Tree objects in the PersistentAVL object
+	void print(std::ostream& out) const;
+
+	//	Prints the Tree objects whose ranks are from first up to but not 
+	//	including last
+	void print(std::ostream& out, int first, int last) const;
+
+	//	Removes all Tree objects from this PersistentAVL object. Snapshots keep
+	//	their Tree objects
+	void clear();
+
+	//	Adds the Tree object x to the PersistentAVL object
+	//	Returns false if a Tree object equal to x was already stored
+	bool insert(const Tree& x);
+
+	//	Removes the Tree object x from the PersistentAVL object
+	//	Returns false if no Tree object equal to x was stored
+	bool remove(const Tree& x);
+
+	//	Returns the root node so that a reader can walk this version directly
+	const PersistentNode* root() const;
+
+	//	Adds a reference to node, if it is not null
+	static void acquire(const PersistentNode* node);
+
+	//	Removes a reference to node, deleting it and releasing its children if
+	//	it was the last one
+	static void release(const PersistentNode* node);
+
+ protected:
+	//	Returns the height of node, which is -1 if node is null
+	static int height(const PersistentNode* node);
+
+	//	Returns the number of Tree objects under node
+	static int size(const PersistentNode* node);
+
+	//	Returns a new node holding data with the given children. The new node
+	//	takes a reference to each child, and the caller owns the reference to
+	//	the new node
+	static const PersistentNode* make_node(const Tree& data,
+																				 const PersistentNode* left,
+																				 const PersistentNode* right);
+
+	//	Returns a new node holding data with the given children, rotated like
+	//	AVL_Tree's LL, LR, RR and RL rotations if the heights of the children
+	//	differ by 2. Only new nodes are made; left and right are not changed
+	static const PersistentNode* balance(const Tree& data,
+																			 const PersistentNode* left,
+																			 const PersistentNode* right);
+
+	//	Returns the root of a new version of the subtree whose root is node that
+	//	also contains x, or null if x was already there
+	static const PersistentNode* insert(const Tree& x,
+																			const PersistentNode* node);
+
+	//	Returns the root of a new version of the subtree whose root is node
+	//	without x and sets removed to true, or sets removed to false if x was
+	//	not there. The new version may be empty, in which case it is null
+	static const PersistentNode* remove(const Tree& x, const PersistentNode* node,
+																			bool& removed);
+
+	//	Returns the number of Tree objects whose spc_common member is less than
+	//	z's, or less than or equal to it if or_equal is true
+	int name_rank(const Tree& z, bool or_equal) const;
+
+	//	Returns the number of Tree objects whose spc_common is exactly species
+	int count_name(const std::string& species) const;
+
+	//	Returns the spc_common that the stored Trees use for species_name, which
+	//	is species_name in lowercase or with its first letter capitalized
+	std::string stored_name(const std::string& species_name) const;
+
+	//	Adds every Tree under node whose spc_common equals z's to match_list
+	void findallmatches(const Tree& z, const PersistentNode* node,
+											std::list<Tree>& match_list) const;
+
+	//	The recursive versions of the queries above, starting at node
+	void all_in_zipcode(const int& zip, const PersistentNode* node,
+											std::list<std::string>& match_list) const;
+	void all_nearby(const double& latitude, const double& longitude,
+									const double& distance, const PersistentNode* node,
+									std::list<std::string>& match_list) const;
+	void group_all(const PersistentNode* node, GroupBy& groups) const;
+	void group_in_zipcode(const int& zip, const PersistentNode* node,
+												GroupBy& groups) const;
+	void group_nearby(const double& latitude, const double& longitude,
+										const double& distance, const PersistentNode* node,
+										GroupBy& groups) const;
+	void for_each(const TreeVisitor& visit, const PersistentNode* node) const;
+	void print(std::ostream& out, const PersistentNode* node) const;
+	void print(std::ostream& out, const PersistentNode* node, int offset,
+						 int first, int last) const;
+
+ private:
+	//	Pointer to the root of this version. This PersistentAVL object owns one
+	//	reference to it
+	const PersistentNode* root_;
+};
+
+#endif
@@ -0,0 +1,48 @@
+/*******************************************************************************
+  Title          : process_memory.cpp
+  Description    : The implementation file for the functions that measure how
+                   much memory the program is using
+  Purpose        : To report how much memory loading and reloading the tree 
+                   census takes
+  Usage          : Call reset_peak_resident_kilobytes() before the work to 
+                   measure and peak_resident_kilobytes() after it
+  Build with     : g++ -c -std=c++11 process_memory.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "process_memory.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+
+//	Returns the number of kilobytes on the line of /proc/self/status that 
+//	starts with field, such as "VmRSS:"
+static long status_kilobytes(const std::string& field) {
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while (std::getline(status, line)) {
+		if (0 == line.compare(0, field.size(), field)) {
+			std::istringstream words(line.substr(field.size()));
+			long kilobytes = -1;
+			words >> kilobytes;
+			return kilobytes;
+		}
+	}
+	return -1;
+}
+
+long resident_kilobytes() {
+	return status_kilobytes("VmRSS:");
+}
+
+long peak_resident_kilobytes() {
+	return status_kilobytes("VmHWM:");
+}
+
+bool reset_peak_resident_kilobytes() {
+	//	writing 5 to clear_refs resets VmHWM to VmRSS
+	std::ofstream clear_refs("/proc/self/clear_refs");
+	clear_refs << "5" << std::endl;
+	return clear_refs.good();
+}
@@ -0,0 +1,33 @@
+/*******************************************************************************
+  Title          : process_memory.h
+  Description    : The interface file for the functions that measure how much
+                   memory the program is using
+  Purpose        : To report how much memory loading and reloading the tree 
+                   census takes
+  Usage          : Call reset_peak_resident_kilobytes() before the work to 
+                   measure and peak_resident_kilobytes() after it
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __PROCESS_MEMORY_H__
+#define __PROCESS_MEMORY_H__
+
+//	These functions read /proc/self, so they only work on Linux. Every one of
+//	them returns -1, or false, if the information is not available
+
+//	Returns the number of kilobytes of the program's memory that are in RAM now
+long resident_kilobytes();
+
+//	Returns the largest number of kilobytes of the program's memory that have 
+//	been in RAM at the same time since the program started or since the last 
+//	call to reset_peak_resident_kilobytes()
+long peak_resident_kilobytes();
+
+//	Starts measuring peak_resident_kilobytes() again from the current amount
+//	Returns false if the kernel does not allow it
+bool reset_peak_resident_kilobytes();
+
+#endif
@@ -0,0 +1,214 @@
+/*******************************************************************************
+  Title          : reloadable_collection.cpp
+  Description    : The implementation file for the ReloadableCollection class
+  Purpose        : To replace the tree census the program answers queries 
+                   about with a newer census file without restarting it
+  Usage          : Call load() with the first census file and reload() with a
+                   newer one
+  Build with     : g++ -c -std=c++11 -pthread reloadable_collection.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "reloadable_collection.h"
+#include "process_memory.h"
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+ReloadableCollection::ReloadableCollection()
+    : collection_(std::make_shared<TreeCollection>()), reloading_(false),
+      traversal_pool_(nullptr), profile_ingest_(false),
+      hilbert_order_(false), lazy_fields_(false)
+{
+}
+
+ReloadableCollection::~ReloadableCollection()
+{
+	wait_for_reload();
+}
+
+int ReloadableCollection::load(std::istream& tree_file) {
+	return current()->load(tree_file);
+}
+
+int ReloadableCollection::load(std::shared_ptr<const CensusFile> census) {
+	return current()->load(census);
+}
+
+bool ReloadableCollection::reload(const std::string& file_name) {
+	std::lock_guard<std::mutex> lock(reloader_mutex_);
+	if (reloading_) {
+		std::cout << "A reload is already running" << std::endl << std::endl;
+		return false;
+	}
+	std::shared_ptr<std::ifstream> tree_file;
+	std::shared_ptr<CensusFile> census;
+	if (lazy_fields_) {
+		census = std::make_shared<CensusFile>();
+		if (!census->open(file_name)) {
+			std::cout << "Unable to map tree census file: " << file_name;
+			std::cout << std::endl << std::endl;
+			return false;
+		}
+	} else {
+		tree_file = std::make_shared<std::ifstream>(file_name.c_str());
+		if (tree_file->fail()) {
+			std::cout << "Unable to open tree census file: " << file_name;
+			std::cout << std::endl << std::endl;
+			return false;
+		}
+	}
+	if (reloader_.joinable()) {
+		reloader_.join();
+	}
+	reloading_ = true;
+	reloader_ = std::thread(&ReloadableCollection::build, this, tree_file, 
+	                        census, file_name);
+	std::cout << "Reloading trees from " << file_name << std::endl << std::endl;
+	return true;
+}
+
+void ReloadableCollection::set_traversal_pool(WorkStealingPool* pool) {
+	traversal_pool_ = pool;
+	current()->set_traversal_pool(pool);
+}
+
+void ReloadableCollection::set_hilbert_order(bool on) {
+	hilbert_order_ = on;
+	current()->set_hilbert_order(on);
+}
+
+void ReloadableCollection::set_lazy_fields(bool on) {
+	lazy_fields_ = on;
+}
+
+void ReloadableCollection::profile_ingest(bool on) {
+	profile_ingest_ = on;
+	current()->profile_ingest(on);
+}
+
+void ReloadableCollection::write_ingest_report(std::ostream& out) const {
+	current()->write_ingest_report(out);
+}
+
+void ReloadableCollection::write_memory_report(std::ostream& out) const {
+	current()->write_memory_report(out);
+}
+
+bool ReloadableCollection::reloading() const {
+	return reloading_;
+}
+
+void ReloadableCollection::wait_for_reload() {
+	std::lock_guard<std::mutex> lock(reloader_mutex_);
+	if (reloader_.joinable()) {
+		reloader_.join();
+	}
+}
+
+void ReloadableCollection::tree_info(const std::string& partial_name) const {
+	current()->tree_info(partial_name);
+}
+
+void ReloadableCollection::list_all_names() const {
+	current()->list_all_names();
+}
+
+void ReloadableCollection::list_all_in_zip(int& zipcode) const {
+	current()->list_all_in_zip(zipcode);
+}
+
+void ReloadableCollection::list_all_near(double& latitude, double& longitude,
+                                         double& distance) const {
+	current()->list_all_near(latitude, longitude, distance);
+}
+
+void ReloadableCollection::list_all_near_batch(
+    const std::vector<NearbyQuery>& queries) const {
+	current()->list_all_near_batch(queries);
+}
+
+void ReloadableCollection::list_in_corridor(const Corridor& corridor) const {
+	current()->list_in_corridor(corridor);
+}
+
+void ReloadableCollection::rollup(GroupKey key) const {
+	current()->rollup(key);
+}
+
+void ReloadableCollection::lookup(int tree_id) const {
+	current()->lookup(tree_id);
+}
+
+void ReloadableCollection::remove(int tree_id) {
+	current()->remove(tree_id);
+}
+
+void ReloadableCollection::print_trees(int first, int last) const {
+	current()->print_trees(first, last);
+}
+
+bool ReloadableCollection::verify() const {
+	return current()->verify();
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+std::shared_ptr<TreeCollection> ReloadableCollection::current() const {
+	return std::atomic_load(&collection_);
+}
+
+void ReloadableCollection::build(std::shared_ptr<std::istream> tree_file,
+                                 std::shared_ptr<const CensusFile> census,
+                                 std::string file_name) {
+	std::chrono::steady_clock::time_point start = 
+	    std::chrono::steady_clock::now();
+	long before = resident_kilobytes();
+	bool peak_known = reset_peak_resident_kilobytes();
+
+	std::shared_ptr<TreeCollection> fresh = std::make_shared<TreeCollection>();
+	fresh->set_traversal_pool(traversal_pool_);
+	fresh->set_hilbert_order(hilbert_order_);
+	fresh->profile_ingest(profile_ingest_);
+	int number_of_trees = 0;
+	if (census) {
+		number_of_trees = fresh->load(census);
+	} else {
+		number_of_trees = fresh->load(*tree_file);
+	}
+	std::shared_ptr<TreeCollection> old = std::atomic_exchange(&collection_,
+	                                                           fresh);
+	std::chrono::duration<double> seconds = 
+	    std::chrono::steady_clock::now() - start;
+	//	both collections are in memory until old is released, unless a query 
+	//	is still using old, in which case that query releases it
+	long peak = peak_resident_kilobytes();
+	old.reset();
+	long after = resident_kilobytes();
+
+	//	write the report at once so it does not get mixed into other output
+	std::ostringstream report;
+	report << std::fixed << std::setprecision(3);
+	report << "Reloaded " << number_of_trees << " trees from " << file_name;
+	report << " in " << seconds.count() << " seconds" << std::endl;
+	report << std::setprecision(1);
+	report << "Resident memory: " << before / 1024.0 << " MB before, ";
+	if (peak_known && 0 <= peak) {
+		report << peak / 1024.0 << " MB peak during reload, ";
+	} else {
+		report << "peak during reload not available, ";
+	}
+	report << after / 1024.0 << " MB after" << std::endl;
+	if (profile_ingest_) {
+		fresh->write_ingest_report(report);
+	}
+	std::cerr << report.str();
+	reloading_ = false;
+}
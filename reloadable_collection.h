@@ -0,0 +1,152 @@
+/*******************************************************************************
+  Title          : reloadable_collection.h
+  Description    : The interface file for the ReloadableCollection class
+  Purpose        : To replace the tree census the program answers queries 
+                   about with a newer census file without restarting it
+  Usage          : Call load() with the first census file and reload() with a
+                   newer one. Queries keep being answered from the old census
+                   until the new one has been completely loaded
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __RELOADABLE_COLLECTION_H__
+#define __RELOADABLE_COLLECTION_H__
+
+#include "tree_collection.h"
+#include <atomic>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/*******************************************************************************
+
+		The ReloadableCollection class answers the same queries as TreeCollection
+		and can swap in a TreeCollection built from a new census file while it 
+		keeps answering them. reload() builds the new TreeCollection on a 
+		background thread with TreeCollection::load, from the mapped census file
+		if set_lazy_fields(true) was called, and with the same Hilbert order and
+		traversal pool as the current one. Once the new collection is
+		complete, one atomic store of a std::shared_ptr makes every later query 
+		use it. Each query holds its own std::shared_ptr to the collection it 
+		started with, so a query that is running during the swap finishes 
+		against the old collection, and the old collection is deleted when the 
+		last such query ends. When the swap happens, the time the reload took and
+		the memory used are written to std::cerr. The peak memory covers the 
+		whole reload, including the time when both collections were in memory, 
+		and is reported as not available if the kernel does not let it be reset.
+		Trees removed from the old collection are not removed from the new one
+
+*******************************************************************************/
+
+class ReloadableCollection {
+ public:
+	//	Creates a ReloadableCollection object with an empty TreeCollection
+	ReloadableCollection();
+
+	//	Waits for a reload that is still running
+	~ReloadableCollection();
+
+	//	Inserts the trees in tree_file into the current TreeCollection
+	//	Returns the number of Trees inserted
+	int load(std::istream& tree_file);
+
+	//	Inserts the records of census into the current TreeCollection, which 
+	//	parses their status and address only when they are needed. Returns the
+	//	number of Trees inserted
+	int load(std::shared_ptr<const CensusFile> census);
+
+	//	Starts building a new TreeCollection from the census file file_name in 
+	//	the background and outputs whether it started. Returns false if the file
+	//	cannot be opened or another reload is still running
+	bool reload(const std::string& file_name);
+
+	//	Calls TreeCollection::set_traversal_pool(pool) on the current 
+	//	TreeCollection and on every TreeCollection that is reloaded
+	void set_traversal_pool(WorkStealingPool* pool);
+
+	//	Calls TreeCollection::set_hilbert_order(on) on the current 
+	//	TreeCollection and on every TreeCollection that is reloaded
+	void set_hilbert_order(bool on);
+
+	//	Makes every reload map its census file into memory and load it with 
+	//	TreeCollection::load(std::shared_ptr<const CensusFile>) if on is true
+	void set_lazy_fields(bool on);
+
+	//	Calls TreeCollection::profile_ingest(on) on the current TreeCollection 
+	//	and on every TreeCollection that is reloaded. The ingest report of a 
+	//	reload is written with its time and memory
+	void profile_ingest(bool on);
+
+	//	Calls TreeCollection::write_ingest_report on the current TreeCollection
+	void write_ingest_report(std::ostream& out) const;
+
+	//	Calls TreeCollection::write_memory_report on the current TreeCollection
+	void write_memory_report(std::ostream& out) const;
+
+	//	Returns true while a reload is running
+	bool reloading() const;
+
+	//	Returns once no reload is running
+	void wait_for_reload();
+
+	//	These methods call the TreeCollection methods with the same names on the
+	//	current TreeCollection
+	void tree_info(const std::string& partial_name) const;
+	void list_all_names() const;
+	void list_all_in_zip(int& zipcode) const;
+	void list_all_near(double& latitude, double& longitude, double& distance)
+	                   const;
+	void list_all_near_batch(const std::vector<NearbyQuery>& queries) const;
+	void list_in_corridor(const Corridor& corridor) const;
+	void rollup(GroupKey key) const;
+	void lookup(int tree_id) const;
+	void remove(int tree_id);
+	void print_trees(int first, int last) const;
+	bool verify() const;
+
+ protected:
+	//	Returns the TreeCollection that queries use now
+	std::shared_ptr<TreeCollection> current() const;
+
+	//	Builds a TreeCollection from census, or from tree_file if census is 
+	//	null, both of which are file_name, swaps it in and reports how long it 
+	//	took and how much memory it used. This is run on the background thread
+	void build(std::shared_ptr<std::istream> tree_file,
+	           std::shared_ptr<const CensusFile> census, std::string file_name);
+
+ private:
+	ReloadableCollection(const ReloadableCollection&);
+	ReloadableCollection& operator=(const ReloadableCollection&);
+
+	//	The TreeCollection queries use. It is only read and written with 
+	//	std::atomic_load and std::atomic_store
+	std::shared_ptr<TreeCollection> collection_;
+
+	//	The thread that runs build(), if a reload has been started
+	std::thread reloader_;
+
+	//	True from the time reload() starts a thread until it is done
+	std::atomic<bool> reloading_;
+
+	//	Makes sure only one thread starts or waits for reloader_ at a time
+	std::mutex reloader_mutex_;
+
+	//	The pool given to every TreeCollection, or null
+	std::atomic<WorkStealingPool*> traversal_pool_;
+
+	//	Whether every TreeCollection times the phases of its load
+	std::atomic<bool> profile_ingest_;
+
+	//	Whether every TreeCollection lays its coordinates along a Hilbert curve
+	std::atomic<bool> hilbert_order_;
+
+	//	Whether every reload maps its census file instead of reading its lines
+	std::atomic<bool> lazy_fields_;
+};
+
+#endif
@@ -0,0 +1,637 @@
+/*******************************************************************************
+  Title          : sharded_collection.cpp
+  Description    : The implementation file for the ShardedTreeCollection class
+  Purpose        : To store the trees of the 2015 NYC Street Tree Census in one
+                   AVL_Tree per borough so that loading and queries can use 
+                   several processors
+  Usage          : Call load() with the census file, then use the same query 
+                   methods as TreeCollection
+  Build with     : g++ -c -std=c++11 -pthread sharded_collection.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "sharded_collection.h"
+#include "haversine.h"
+#include "process_memory.h"
+#include "trace.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+//	the number of kilometers in a degree of latitude is about 111.2 for the 
+//	radius haversine uses. Using a smaller number makes the boxes a bit larger
+//	than they need to be, which is safe
+const double kKilometersPerDegree = 110.0;
+const double kPi = 3.14159265358979323846;
+
+//	the largest possible zipcode is 99999
+const int kShardZipcodes = 100000;
+
+bool TreeShard::may_be_near(double latitude, double longitude,
+                            double distance) const {
+	if (!has_bounds || distance < 0) {
+		return false;
+	}
+	double latitude_reach = distance / kKilometersPerDegree;
+	double farthest_latitude = std::max(std::fabs(min_latitude - latitude_reach),
+	                                    std::fabs(max_latitude + latitude_reach));
+	if (89.0 <= farthest_latitude) {
+		return true;
+	}
+	//	a degree of longitude is shortest at the latitude farthest from the 
+	//	equator, so that gives the widest reach
+	double longitude_reach = distance / 
+	    (kKilometersPerDegree * std::cos(farthest_latitude * kPi / 180.0));
+	return min_latitude - latitude_reach <= latitude && 
+	       latitude <= max_latitude + latitude_reach &&
+	       min_longitude - longitude_reach <= longitude &&
+	       longitude <= max_longitude + longitude_reach;
+}
+
+bool TreeShard::may_be_near(const Corridor& corridor) const {
+	const std::vector<CorridorPoint>& points = corridor.points();
+	for (unsigned int i = 0; i < points.size(); ++i) {
+		//	a path of one point is a segment from the point to itself
+		const CorridorPoint& start = points[0 < i ? i - 1 : 0];
+		const CorridorPoint& end = points[i];
+		//	every point of the segment is within half its length of its middle
+		double latitude = (start.latitude + end.latitude) / 2;
+		double longitude = (start.longitude + end.longitude) / 2;
+		double half = std::max(
+		    haversine(latitude, longitude, start.latitude, start.longitude),
+		    haversine(latitude, longitude, end.latitude, end.longitude));
+		if (may_be_near(latitude, longitude, corridor.distance() + half)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+ShardedTreeCollection::ShardedTreeCollection(int number_of_threads)
+    : zip_shards_(kShardZipcodes, 0), pool_(number_of_threads)
+{
+	for (int p = 0; p < pool_.size(); ++p) {
+		parse_streets_.push_back(
+		    std::unique_ptr<StreetDictionary>(new StreetDictionary));
+	}
+}
+
+ShardedTreeCollection::~ShardedTreeCollection()
+{
+}
+
+int ShardedTreeCollection::load(std::istream& tree_file) {
+	int number_of_lines = 0;
+	std::vector<std::string> lines;
+	std::string line;
+	bool done = false;
+	TraceSpan load_span("load", "load");
+	while (!done) {
+		lines.clear();
+		{
+			TraceSpan read_span("read block", "load");
+			while (lines.size() < static_cast<unsigned int>(kShardLoadBlock)) {
+				if (!std::getline(tree_file, line) || tree_file.eof()) {
+					done = true;
+					break;
+				}
+				lines.push_back(line);
+			}
+		}
+
+		//	parse the block in as many pieces as there are threads
+		std::vector<Tree> parsed(lines.size());
+		int pieces = parse_streets_.size();
+		std::vector<std::function<void()> > parse_tasks;
+		for (int p = 0; p < pieces; ++p) {
+			int first = lines.size() * p / pieces;
+			int last = lines.size() * (p + 1) / pieces;
+			StreetDictionary* streets = parse_streets_[p].get();
+			parse_tasks.push_back([&lines, &parsed, first, last, streets]() {
+				TraceSpan parse_span("parse chunk", "load");
+				for (int i = first; i < last; ++i) {
+					parsed[i] = Tree(lines[i], *streets);
+				}
+			});
+		}
+		pool_.run_all(parse_tasks);
+
+		//	species ids and duplicates depend on the order of the file
+		std::array<std::vector<Tree>, 5> routed;
+		for (unsigned int i = 0; i < parsed.size(); ++i) {
+			if (prepare(parsed[i])) {
+				routed[shard_of(parsed[i].borough())].push_back(parsed[i]);
+			}
+		}
+		for_each_shard(all_shards(), [this, &routed](int shard) {
+			TraceSpan insert_span("insert into shard", "load");
+			insert_into_shard(shard, routed[shard]);
+		});
+		number_of_lines += lines.size();
+	}
+	for_each_shard(all_shards(), [this](int shard) {
+		TraceSpan freeze_span("freeze index", "load");
+		shards_[shard].trees.freeze();
+	});
+	return number_of_lines;
+}
+
+int ShardedTreeCollection::total_tree_count() const {
+	int total = 0;
+	for (int s = 0; s < 5; ++s) {
+		total += shards_[s].rows;
+	}
+	return total;
+}
+
+int ShardedTreeCollection::count_of_trees_in_boro(const std::string& boro_name)
+                                                  const {
+	std::string boro = boro_name;
+	for (char& c : boro) {
+		if (isupper(c)) {
+			c = tolower(c);
+		}
+	}
+
+	if ("manhattan" == boro) {
+		return shards_[shard_of(MANHATTAN)].rows;
+	} else if ("bronx" == boro) {
+		return shards_[shard_of(BRONX)].rows;
+	} else if ("brooklyn" == boro) {
+		return shards_[shard_of(BROOKLYN)].rows;
+	} else if ("queens" == boro) {
+		return shards_[shard_of(QUEENS)].rows;
+	} else if ("staten island" == boro) {
+		return shards_[shard_of(STATEN)].rows;
+	} 
+	return 0;
+}
+
+void ShardedTreeCollection::tree_info(const std::string& partial_name) const {
+	string_list matches;
+	if (partial_name == " ") {
+		matches.push_back("");
+	} else {
+		TraceSpan span("get_matching_species");
+		matches = all_species_.get_matching_species(partial_name);
+		if (matches.empty()) {
+			std::cout << "No " << partial_name << " trees were found." << std::endl;
+			std::cout << std::endl;
+			return;
+		}
+	}
+	std::vector<int> ids;
+	for (auto it = matches.begin(); it != matches.end(); ++it) {
+		int id = TreeCollection::matching_species_id(*it, species_ids_);
+		if (0 <= id) {
+			ids.push_back(id);
+		}
+	}
+
+	//	each shard only writes its own borough's counts
+	std::array<double, 6> in_borough = {{0, 0, 0, 0, 0, 0}};
+	std::array<double, 6> in_shard = {{0, 0, 0, 0, 0, 0}};
+	for_each_shard(all_shards(), [this, &ids, &in_borough, &in_shard](int s) {
+		int b = s + MANHATTAN;
+		for (unsigned int i = 0; i < ids.size(); ++i) {
+			in_borough[b] += shards_[s].species_by_borough.count(ids[i], b);
+			in_shard[b] += shards_[s].species_by_borough.species_total(ids[i]);
+		}
+	});
+
+	std::array<double, 6> totals = in_borough;
+	std::array<int, 6> trees_by_borough = {{0, 0, 0, 0, 0, 0}};
+	for (int s = 0; s < 5; ++s) {
+		totals[ALLBOROS] += in_shard[s + MANHATTAN];
+		trees_by_borough[s + MANHATTAN] = shards_[s].rows;
+		trees_by_borough[ALLBOROS] += shards_[s].rows;
+	}
+	TreeCollection::print_frequencies(partial_name, matches, totals,
+	                                  trees_by_borough);
+}
+
+void ShardedTreeCollection::list_all_names() const {
+	all_species_.print_all_species(std::cout);
+	std::cout << std::endl;
+}
+
+void ShardedTreeCollection::list_all_in_zip(int& zipcode) const {
+	std::vector<int> shards;
+	if (0 <= zipcode && zipcode < kShardZipcodes) {
+		for (int s = 0; s < 5; ++s) {
+			if (zip_shards_[zipcode] & (1 << s)) {
+				shards.push_back(s);
+			}
+		}
+	}
+	if (shards.empty()) {
+		GroupBy none(species_ids_.size(), BY_SPECIES);
+		TreeCollection::print_zip_counts(zipcode, none, -1, species_ids_);
+		return;
+	}
+	//	the view counts are looked up directly, so there is nothing worth 
+	//	running on the ThreadPool
+	const GroupBy& first = shards_[shards[0]].species_by_zip;
+	if (1 == shards.size()) {
+		TreeCollection::print_zip_counts(zipcode, first, first.slot_of(zipcode),
+		                                 species_ids_);
+		return;
+	}
+	GroupBy merged(species_ids_.size(), BY_ZIP);
+	for (unsigned int i = 0; i < shards.size(); ++i) {
+		const GroupBy& view = shards_[shards[i]].species_by_zip;
+		merged.merge(view, view.slot_of(zipcode));
+	}
+	TreeCollection::print_zip_counts(zipcode, merged, merged.slot_of(zipcode),
+	                                 species_ids_);
+}
+
+void ShardedTreeCollection::list_all_near(double& latitude, double& longitude,
+                                          double& distance) const {
+	std::vector<int> shards;
+	for (int s = 0; s < 5; ++s) {
+		if (shards_[s].may_be_near(latitude, longitude, distance)) {
+			shards.push_back(s);
+		}
+	}
+	std::vector<GroupBy> nearby(5, GroupBy(species_ids_.size(), BY_SPECIES));
+	double lat = latitude, lon = longitude, dist = distance;
+	for_each_shard(shards, [this, &nearby, lat, lon, dist](int s) {
+		shards_[s].trees.group_nearby(lat, lon, dist, nearby[s]);
+	});
+	GroupBy merged(species_ids_.size(), BY_SPECIES);
+	for (unsigned int i = 0; i < shards.size(); ++i) {
+		merged.merge(nearby[shards[i]]);
+	}
+	TreeCollection::print_near_counts(latitude, longitude, distance, merged,
+	                                  species_ids_);
+}
+
+void ShardedTreeCollection::list_all_near_batch(
+    const std::vector<NearbyQuery>& queries) const {
+	//	each shard only answers the queries whose circle reaches its box
+	std::vector<std::vector<int> > asked(5);
+	std::vector<int> shards;
+	for (int s = 0; s < 5; ++s) {
+		for (unsigned int q = 0; q < queries.size(); ++q) {
+			if (shards_[s].may_be_near(queries[q].latitude, queries[q].longitude,
+			                           queries[q].distance)) {
+				asked[s].push_back(q);
+			}
+		}
+		if (!asked[s].empty()) {
+			shards.push_back(s);
+		}
+	}
+	std::vector<std::vector<GroupBy> > nearby(5);
+	for_each_shard(shards, [this, &queries, &asked, &nearby](int s) {
+		std::vector<NearbyQuery> shard_queries;
+		for (unsigned int i = 0; i < asked[s].size(); ++i) {
+			shard_queries.push_back(queries[asked[s][i]]);
+		}
+		NearbyBatch batch(shard_queries);
+		nearby[s].assign(shard_queries.size(), 
+		                 GroupBy(species_ids_.size(), BY_SPECIES));
+		group_nearby_batch(shards_[s].trees, batch, nearby[s]);
+	});
+	std::vector<GroupBy> merged(queries.size(), 
+	                            GroupBy(species_ids_.size(), BY_SPECIES));
+	for (unsigned int i = 0; i < shards.size(); ++i) {
+		int s = shards[i];
+		for (unsigned int j = 0; j < asked[s].size(); ++j) {
+			merged[asked[s][j]].merge(nearby[s][j]);
+		}
+	}
+	for (unsigned int q = 0; q < queries.size(); ++q) {
+		TreeCollection::print_near_counts(queries[q].latitude, 
+		                                  queries[q].longitude,
+		                                  queries[q].distance, merged[q],
+		                                  species_ids_);
+	}
+}
+
+void ShardedTreeCollection::list_in_corridor(const Corridor& corridor) const {
+	std::vector<int> shards;
+	for (int s = 0; s < 5; ++s) {
+		if (shards_[s].may_be_near(corridor)) {
+			shards.push_back(s);
+		}
+	}
+	std::vector<GroupBy> found(5, GroupBy(species_ids_.size(), BY_SPECIES));
+	for_each_shard(shards, [this, &found, &corridor](int s) {
+		group_in_corridor(shards_[s].trees, corridor, found[s]);
+	});
+	GroupBy merged(species_ids_.size(), BY_SPECIES);
+	for (unsigned int i = 0; i < shards.size(); ++i) {
+		merged.merge(found[shards[i]]);
+	}
+	TreeCollection::print_corridor_counts(corridor, merged, species_ids_);
+}
+
+void ShardedTreeCollection::rollup(GroupKey key) const {
+	std::vector<GroupBy> groups(5, GroupBy(species_ids_.size(), key));
+	for_each_shard(all_shards(), [this, &groups](int s) {
+		shards_[s].trees.group_all(groups[s]);
+	});
+	GroupBy merged(species_ids_.size(), key);
+	for (int s = 0; s < 5; ++s) {
+		merged.merge(groups[s]);
+	}
+	TreeCollection::print_rollup(merged, species_ids_);
+}
+
+void ShardedTreeCollection::lookup(int tree_id) const {
+	for (int s = 0; s < 5; ++s) {
+		const Tree& stored = shards_[s].trees.find_by_id(tree_id);
+		if (!(stored == kNotFound.data)) {
+			std::cout << "Tree " << tree_id << ":" << std::endl;
+			std::cout << stored;
+			std::cout.copyfmt(std::ios(nullptr));
+			std::cout << std::endl;
+			return;
+		}
+	}
+	std::cout << "No tree found with id: " << tree_id << std::endl;
+	std::cout << std::endl;
+}
+
+void ShardedTreeCollection::remove(int tree_id) {
+	for (int s = 0; s < 5; ++s) {
+		TreeShard& shard = shards_[s];
+		const Tree& stored = shard.trees.find_by_id(tree_id);
+		if (stored == kNotFound.data) {
+			continue;
+		}
+		//	copy the stored Tree since removing it from the shard destroys it
+		Tree old_tree(stored);
+		shard.trees.remove(old_tree);
+		shard.species_by_borough.remove(old_tree);
+		shard.species_by_zip.remove(old_tree);
+		--shard.rows;
+		stored_keys_.erase((static_cast<long long>(old_tree.species_id()) << 32) |
+		                   static_cast<unsigned int>(old_tree.id()));
+		std::vector<int> species_totals(species_ids_.size(), 0);
+		for (int t = 0; t < 5; ++t) {
+			const GroupBy& by_borough = shards_[t].species_by_borough;
+			//	a shard's views have room for fewer species than species_ids_ 
+			//	when no later block reached the shard, and for more when resize 
+			//	doubled them, so only the ids both have room for are counted
+			for (unsigned int id = 0; id < species_totals.size(); ++id) {
+				if (static_cast<int>(id) < by_borough.number_of_species()) {
+					species_totals[id] += by_borough.species_total(id);
+				}
+			}
+		}
+		if (0 == species_totals[old_tree.species_id()]) {
+			all_species_ = TreeCollection::species_with_trees(species_ids_,
+			                                                  species_totals);
+		}
+		std::cout << "Removed tree " << tree_id << std::endl;
+		std::cout << std::endl;
+		return;
+	}
+	std::cout << "No tree found with id: " << tree_id << std::endl;
+	std::cout << std::endl;
+}
+
+void ShardedTreeCollection::print_trees(int first, int last) const {
+	int number_of_trees = 0;
+	for (int s = 0; s < 5; ++s) {
+		number_of_trees += shards_[s].trees.get_number_of_trees();
+	}
+	if (first < 0) {
+		first = 0;
+	}
+	if (number_of_trees < last) {
+		last = number_of_trees;
+	}
+	if (last <= first) {
+		std::cout << "No trees found from " << first << " to " << last;
+		std::cout << std::endl << std::endl;
+		return;
+	}
+	std::cout << "Trees " << first << " to " << last - 1 << " of ";
+	std::cout << number_of_trees << ":" << std::endl;
+
+	//	find the shard and position of the Tree whose rank in all the shards is
+	//	first, then merge the shards from there
+	std::array<int, 5> next = {{0, 0, 0, 0, 0}};
+	for (int s = 0; s < 5; ++s) {
+		int low = 0, high = shards_[s].trees.get_number_of_trees();
+		while (low < high) {
+			int middle = low + (high - low) / 2;
+			if (rank(shards_[s].trees.select(middle)) < first) {
+				low = middle + 1;
+			} else {
+				high = middle;
+			}
+		}
+		if (low < shards_[s].trees.get_number_of_trees() &&
+		    rank(shards_[s].trees.select(low)) == first) {
+			const Tree& start = shards_[s].trees.select(low);
+			for (int t = 0; t < 5; ++t) {
+				next[t] = shards_[t].trees.rank(start);
+			}
+			break;
+		}
+	}
+	for (int i = first; i < last; ++i) {
+		int smallest = -1;
+		for (int s = 0; s < 5; ++s) {
+			if (next[s] < shards_[s].trees.get_number_of_trees() &&
+			    (smallest < 0 || shards_[s].trees.select(next[s]) < 
+			                     shards_[smallest].trees.select(next[smallest]))) {
+				smallest = s;
+			}
+		}
+		std::cout << shards_[smallest].trees.select(next[smallest]);
+		++next[smallest];
+	}
+	std::cout.copyfmt(std::ios(nullptr));
+	std::cout << std::endl;
+}
+
+bool ShardedTreeCollection::verify() const {
+	int number_of_species = species_ids_.size();
+	std::vector<GroupBy> by_borough(5, GroupBy(number_of_species, BY_BOROUGH));
+	std::vector<GroupBy> by_zip(5, GroupBy(number_of_species, BY_ZIP));
+	for_each_shard(all_shards(), [this, &by_borough, &by_zip](int s) {
+		shards_[s].trees.group_all(by_borough[s]);
+		shards_[s].trees.group_all(by_zip[s]);
+	});
+	GroupBy species_by_borough(number_of_species, BY_BOROUGH);
+	GroupBy species_by_zip(number_of_species, BY_ZIP);
+	GroupBy recomputed_by_borough(number_of_species, BY_BOROUGH);
+	GroupBy recomputed_by_zip(number_of_species, BY_ZIP);
+	std::array<int, 6> rows_by_borough, duplicates_by_borough;
+	rows_by_borough.fill(0);
+	duplicates_by_borough.fill(0);
+	for (int s = 0; s < 5; ++s) {
+		species_by_borough.merge(shards_[s].species_by_borough);
+		species_by_zip.merge(shards_[s].species_by_zip);
+		recomputed_by_borough.merge(by_borough[s]);
+		recomputed_by_zip.merge(by_zip[s]);
+		rows_by_borough[s + MANHATTAN] = shards_[s].rows;
+		rows_by_borough[ALLBOROS] += shards_[s].rows;
+		duplicates_by_borough[s + MANHATTAN] = shards_[s].duplicates;
+		duplicates_by_borough[ALLBOROS] += shards_[s].duplicates;
+	}
+	return TreeCollection::verify_views(species_by_borough, 
+	                                    recomputed_by_borough, species_by_zip,
+	                                    recomputed_by_zip, rows_by_borough,
+	                                    duplicates_by_borough, species_ids_);
+}
+
+bool ShardedTreeCollection::reload(const std::string& file_name) {
+	std::ifstream tree_file(file_name.c_str());
+	if (tree_file.fail()) {
+		std::cout << "Unable to open tree census file: " << file_name;
+		std::cout << std::endl << std::endl;
+		return false;
+	}
+	std::cout << "Reloading trees from " << file_name << std::endl << std::endl;
+	std::chrono::steady_clock::time_point start = 
+	    std::chrono::steady_clock::now();
+	long before = resident_kilobytes();
+	bool peak_known = reset_peak_resident_kilobytes();
+	clear();
+	int number_of_trees = load(tree_file);
+	std::chrono::duration<double> seconds = 
+	    std::chrono::steady_clock::now() - start;
+	long peak = peak_resident_kilobytes();
+	long after = resident_kilobytes();
+
+	std::ostringstream report;
+	report << std::fixed << std::setprecision(3);
+	report << "Reloaded " << number_of_trees << " trees from " << file_name;
+	report << " in " << seconds.count() << " seconds" << std::endl;
+	report << std::setprecision(1);
+	report << "Resident memory: " << before / 1024.0 << " MB before, ";
+	if (peak_known && 0 <= peak) {
+		report << peak / 1024.0 << " MB peak during reload, ";
+	} else {
+		report << "peak during reload not available, ";
+	}
+	report << after / 1024.0 << " MB after" << std::endl;
+	std::cerr << report.str();
+	return true;
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+int ShardedTreeCollection::shard_of(Borough borough) {
+	if (ALLBOROS == borough) {
+		return STATEN - MANHATTAN;
+	}
+	return borough - MANHATTAN;
+}
+
+bool ShardedTreeCollection::prepare(Tree& tree) {
+	const std::string& species_name = tree.common_name();
+	std::map<std::string, int>::iterator it = species_ids_.find(species_name);
+	int id = 0;
+	if (it == species_ids_.end()) {
+		id = species_ids_.size();
+		species_ids_[species_name] = id;
+		all_species_.add_species(species_name);
+	} else {
+		id = it->second;
+	}
+	tree.set_species_id(id);
+
+	int shard = shard_of(tree.borough());
+	++shards_[shard].rows;
+	long long key = (static_cast<long long>(id) << 32) | 
+	                static_cast<unsigned int>(tree.id());
+	if (!stored_keys_.insert(key).second) {
+		++shards_[shard].duplicates;
+		return false;
+	}
+	if (0 <= tree.zip() && tree.zip() < kShardZipcodes) {
+		zip_shards_[tree.zip()] |= 1 << shard;
+	}
+	return true;
+}
+
+void ShardedTreeCollection::insert_into_shard(int shard,
+                                              const std::vector<Tree>& trees) {
+	TreeShard& s = shards_[shard];
+	s.species_by_borough.resize(species_ids_.size());
+	s.species_by_zip.resize(species_ids_.size());
+	for (unsigned int i = 0; i < trees.size(); ++i) {
+		if (!s.trees.insert(trees[i])) {
+			continue;
+		}
+		s.species_by_borough.add(trees[i]);
+		s.species_by_zip.add(trees[i]);
+		double latitude = 0, longitude = 0;
+		trees[i].get_position(latitude, longitude);
+		if (!s.has_bounds) {
+			s.min_latitude = s.max_latitude = latitude;
+			s.min_longitude = s.max_longitude = longitude;
+			s.has_bounds = true;
+		} else {
+			s.min_latitude = std::min(s.min_latitude, latitude);
+			s.max_latitude = std::max(s.max_latitude, latitude);
+			s.min_longitude = std::min(s.min_longitude, longitude);
+			s.max_longitude = std::max(s.max_longitude, longitude);
+		}
+	}
+}
+
+int ShardedTreeCollection::rank(const Tree& x) const {
+	int total = 0;
+	for (int s = 0; s < 5; ++s) {
+		total += shards_[s].trees.rank(x);
+	}
+	return total;
+}
+
+void ShardedTreeCollection::for_each_shard(const std::vector<int>& shards,
+                                           std::function<void(int)> task)
+                                           const {
+	std::vector<std::function<void()> > tasks;
+	for (unsigned int i = 0; i < shards.size(); ++i) {
+		int shard = shards[i];
+		tasks.push_back([task, shard]() { task(shard); });
+	}
+	pool_.run_all(tasks);
+}
+
+std::vector<int> ShardedTreeCollection::all_shards() {
+	std::vector<int> shards;
+	for (int s = 0; s < 5; ++s) {
+		shards.push_back(s);
+	}
+	return shards;
+}
+
+void ShardedTreeCollection::clear() {
+	for (int s = 0; s < 5; ++s) {
+		TreeShard& shard = shards_[s];
+		shard.trees.clear();
+		shard.species_by_borough = GroupBy(0, BY_BOROUGH);
+		shard.species_by_zip = GroupBy(0, BY_ZIP);
+		shard.rows = 0;
+		shard.duplicates = 0;
+		shard.has_bounds = false;
+	}
+	all_species_ = TreeSpecies();
+	species_ids_.clear();
+	stored_keys_.clear();
+	std::fill(zip_shards_.begin(), zip_shards_.end(), 0);
+	//	the Trees that point into the old dictionaries are gone
+	for (unsigned int p = 0; p < parse_streets_.size(); ++p) {
+		parse_streets_[p].reset(new StreetDictionary);
+	}
+}
@@ -0,0 +1,191 @@
+/*******************************************************************************
+  Title          : sharded_collection.h
+  Description    : The interface file for the ShardedTreeCollection class
+  Purpose        : To store the trees of the 2015 NYC Street Tree Census in one
+                   AVL_Tree per borough so that loading and queries can use 
+                   several processors
+  Usage          : Call load() with the census file, then use the same query 
+                   methods as TreeCollection
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __SHARDED_COLLECTION_H__
+#define __SHARDED_COLLECTION_H__
+
+#include "avl.h"
+#include "tree_collection.h"
+#include "tree_species.h"
+#include "group_by.h"
+#include "thread_pool.h"
+#include <array>
+#include <istream>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*******************************************************************************
+
+		The TreeShard struct holds the Trees of one borough: an AVL_Tree, the 
+		materialized views for those Trees, the number of rows given to the shard
+		and how many of them were duplicates that were not stored, and the 
+		smallest box of latitudes and longitudes that contains all of 
+		its Trees
+
+*******************************************************************************/
+
+struct TreeShard {
+	AVL_Tree trees;
+	GroupBy species_by_borough;
+	GroupBy species_by_zip;
+	int rows;
+	int duplicates;
+	bool has_bounds;
+	double min_latitude, max_latitude, min_longitude, max_longitude;
+
+	TreeShard() : species_by_borough(0, BY_BOROUGH), species_by_zip(0, BY_ZIP),
+	              rows(0), duplicates(0), has_bounds(false), min_latitude(0),
+	              max_latitude(0), min_longitude(0), max_longitude(0) {
+	}
+
+	//	Returns true if a Tree within distance kilometers of the given 
+	//	coordinates could be in the shard's bounding box. It may return true 
+	//	for a circle that only comes close to the box, but never returns false 
+	//	for a circle that reaches it
+	bool may_be_near(double latitude, double longitude, double distance) const;
+
+	//	Returns true if a Tree in corridor could be in the shard's bounding box,
+	//	by testing a circle around each segment of its path that reaches 
+	//	corridor.distance() past the segment
+	bool may_be_near(const Corridor& corridor) const;
+};
+
+/*******************************************************************************
+
+		The ShardedTreeCollection class answers the same queries as 
+		TreeCollection with the same output, but stores the Trees of each borough
+		in a separate TreeShard. Loading reads the census file in blocks. The 
+		lines of a block are parsed on the ThreadPool, then each Tree is given 
+		its species id, checked for a duplicate and counted in file order, and 
+		then the five shards insert their Trees of the block at the same time. A 
+		Tree with the same spc_common and tree_id as one that is already stored 
+		is not stored again, even if it is in a different borough, so the shards
+		hold exactly the Trees that TreeCollection would. Queries that need every
+		shard run one task per shard on the ThreadPool and merge the results: 
+		tree_info adds up the counts of each shard, list_near and each query of
+		a batch of them only search the shards whose bounding box the circle 
+		reaches, corridor only the ones a circle around a segment of its path 
+		reaches, and listall_inzip only looks at the shards that have Trees in 
+		the zipcode, which is almost always one. count_of_trees_in_boro only 
+		looks at the borough's own shard.
+		Trees with no borough are stored in the Staten Island shard, the borough 
+		TreeCollection::convert_to_tree_borough picks for names it does not 
+		recognize
+
+*******************************************************************************/
+
+//	The number of lines loaded at a time
+const int kShardLoadBlock = 65536;
+
+class ShardedTreeCollection {
+ public:
+	//	Creates an empty ShardedTreeCollection object whose ThreadPool has 
+	//	number_of_threads threads, or one for each processor if it is 0
+	explicit ShardedTreeCollection(int number_of_threads = 0);
+
+	//	Destroys ShardedTreeCollection object
+	~ShardedTreeCollection();
+
+	//	Inserts a Tree for every line of tree_file, with the same rules as 
+	//	TreeCollection::load, and freezes the AVL_Tree of every shard. Returns
+	//	the number of Trees inserted
+	int load(std::istream& tree_file);
+
+	//	Returns the total number of rows given to the collection
+	int total_tree_count() const;
+
+	//	Returns the number of trees in boro_name. Returns 0 if boro_name is not 
+	//	a New York borough. This method is case insensitive
+	int count_of_trees_in_boro(const std::string& boro_name) const;
+
+	//	These methods output exactly what the TreeCollection methods with the 
+	//	same names output
+	void tree_info(const std::string& partial_name) const;
+	void list_all_names() const;
+	void list_all_in_zip(int& zipcode) const;
+	void list_all_near(double& latitude, double& longitude, double& distance)
+	                   const;
+	void list_all_near_batch(const std::vector<NearbyQuery>& queries) const;
+	void list_in_corridor(const Corridor& corridor) const;
+	void rollup(GroupKey key) const;
+	void lookup(int tree_id) const;
+	void remove(int tree_id);
+	void print_trees(int first, int last) const;
+	bool verify() const;
+
+	//	Replaces the Trees with the ones in the census file file_name and 
+	//	outputs whether it started. Commands are run on the calling thread, so 
+	//	the new file is loaded right away and the old Trees are freed first. 
+	//	The time the reload took and the memory used are written to std::cerr
+	//	Returns false if the file cannot be opened
+	bool reload(const std::string& file_name);
+
+ protected:
+	//	Returns the shard that stores Trees of borough
+	static int shard_of(Borough borough);
+
+	//	Gives tree its species id, counts it and returns true if it is not a 
+	//	duplicate of a Tree that is already stored
+	bool prepare(Tree& tree);
+
+	//	Inserts trees into shard, which the caller must be the only one using
+	void insert_into_shard(int shard, const std::vector<Tree>& trees);
+
+	//	Returns the number of stored Trees, in all shards, that are less than x
+	int rank(const Tree& x) const;
+
+	//	Runs task once for each shard in shards, each on the ThreadPool
+	void for_each_shard(const std::vector<int>& shards, 
+	                    std::function<void(int)> task) const;
+
+	//	Returns a list of all the shards
+	static std::vector<int> all_shards();
+
+	//	Takes every Tree, species and street out of the collection
+	void clear();
+
+ private:
+	ShardedTreeCollection(const ShardedTreeCollection&);
+	ShardedTreeCollection& operator=(const ShardedTreeCollection&);
+
+	//	A StreetDictionary for each piece a block is parsed in, so that the 
+	//	pieces add the streets of their Trees at the same time without a lock.
+	//	A street may be in more than one of them
+	std::vector<std::unique_ptr<StreetDictionary> > parse_streets_;
+
+	//	The shards of Manhattan, the Bronx, Brooklyn, Queens and Staten Island,
+	//	in the order of the Borough values
+	std::array<TreeShard, 5> shards_;
+
+	//	The species of all the shards. Species ids are given out in file order,
+	//	so they are the same as the ones TreeCollection would give
+	TreeSpecies all_species_;
+	std::map<std::string, int> species_ids_;
+
+	//	The spc_common and tree_id of every stored Tree, used to find duplicates
+	//	across shards. The species id is in the upper 32 bits
+	std::unordered_set<long long> stored_keys_;
+
+	//	For each zipcode, a bit for each shard that has Trees in it
+	std::vector<unsigned char> zip_shards_;
+
+	//	Runs the work of the shards. It is mutable because queries that do not 
+	//	change the collection still give it tasks
+	mutable ThreadPool pool_;
+};
+
+#endif
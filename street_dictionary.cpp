@@ -0,0 +1,50 @@
+/*******************************************************************************
+  Title          : street_dictionary.cpp
+  Description    : The implementation file for the StreetDictionary class
+  Purpose        : To store each street name of the tree census once, so that
+                   a Tree only keeps the house number of its address and a 
+                   pointer to its street
+  Usage          : Call intern() with a street name to get the dictionary's
+                   copy of it, which stays valid until the dictionary is 
+                   destroyed
+  Build with     : g++ -c -std=c++11 street_dictionary.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "street_dictionary.h"
+
+StreetDictionary::StreetDictionary() {
+}
+
+const std::string* StreetDictionary::intern(const std::string& name) {
+	return &*streets_.insert(name).first;
+}
+
+int StreetDictionary::size() const {
+	return streets_.size();
+}
+
+MemoryUsage StreetDictionary::memory_usage() const {
+	//	the nodes of the hash table cannot be reached, so their size is 
+	//	estimated from the link and the cached hash that each one has around 
+	//	its name
+	MemoryUsage usage;
+	std::unordered_set<std::string>::const_iterator it;
+	for (it = streets_.begin(); it != streets_.end(); ++it) {
+		MemoryUsage node;
+		node.blocks = 1;
+		node.logical_bytes = sizeof(*it);
+		node.requested_bytes = 16 + sizeof(*it);
+		node.allocated_bytes = allocated_size(node.requested_bytes);
+		usage += node;
+		usage += string_usage(*it);
+	}
+	MemoryUsage buckets;
+	buckets.blocks = 1;
+	buckets.logical_bytes = streets_.bucket_count() * sizeof(void*);
+	buckets.requested_bytes = buckets.logical_bytes;
+	buckets.allocated_bytes = allocated_size(buckets.requested_bytes);
+	usage += buckets;
+	return usage;
+}
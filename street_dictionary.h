@@ -0,0 +1,63 @@
+/*******************************************************************************
+  Title          : street_dictionary.h
+  Description    : The interface file for the StreetDictionary class
+  Purpose        : To store each street name of the tree census once, so that
+                   a Tree only keeps the house number of its address and a 
+                   pointer to its street
+  Usage          : Call intern() with a street name to get the dictionary's
+                   copy of it, which stays valid until the dictionary is 
+                   destroyed
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __STREET_DICTIONARY_H__
+#define __STREET_DICTIONARY_H__
+
+#include "memory_stats.h"
+#include <string>
+#include <unordered_set>
+
+/*******************************************************************************
+
+		The StreetDictionary class keeps one copy of every different street 
+		name it is given. Addresses in the census repeat a few thousand street 
+		names, like "WEST 50 STREET", over hundreds of thousands of trees, so a
+		Tree keeps its house number and a pointer to the dictionary's copy of 
+		its street instead of the whole address. The copies are nodes of a hash
+		set, which never move once they are added, so reading a street through 
+		its pointer does not look at the dictionary at all and needs no lock, 
+		even while another thread is adding streets. A pointer also works for 
+		the several dictionaries the parse tasks of --sharded fill, where an 
+		index would also have to say which dictionary it is in. Each collection
+		has its own dictionaries, which are destroyed with it, and only one 
+		thread at a time adds to a dictionary: the loading thread, or each parse
+		task its own one
+
+*******************************************************************************/
+
+class StreetDictionary {
+ public:
+	//	Creates an empty StreetDictionary object
+	StreetDictionary();
+
+	//	Returns the dictionary's copy of the street called name, adding one if 
+	//	it does not have it yet. Only one thread at a time may call it
+	const std::string* intern(const std::string& name);
+
+	//	Returns the number of streets in the dictionary
+	int size() const;
+
+	//	Returns the memory used by the names and the table of their nodes
+	MemoryUsage memory_usage() const;
+
+ private:
+	StreetDictionary(const StreetDictionary&);
+	StreetDictionary& operator=(const StreetDictionary&);
+
+	std::unordered_set<std::string> streets_;
+};
+
+#endif
@@ -0,0 +1,90 @@
+/*******************************************************************************
+  Title          : thread_pool.cpp
+  Description    : The implementation file for the ThreadPool class
+  Purpose        : To run pieces of work on a fixed set of threads instead of 
+                   starting a thread for every piece
+  Usage          : Give run_all() a list of tasks that do not depend on each 
+                   other. It returns once every one of them has run
+  Build with     : g++ -c -std=c++11 -pthread thread_pool.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int number_of_threads) : stopping_(false) {
+	if (number_of_threads <= 0) {
+		number_of_threads = std::thread::hardware_concurrency();
+	}
+	if (number_of_threads <= 0) {
+		number_of_threads = 1;
+	}
+	for (int i = 0; i < number_of_threads; ++i) {
+		workers_.push_back(std::thread(&ThreadPool::work, this));
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(tasks_mutex_);
+		stopping_ = true;
+	}
+	task_ready_.notify_all();
+	for (unsigned int i = 0; i < workers_.size(); ++i) {
+		workers_[i].join();
+	}
+}
+
+int ThreadPool::size() const {
+	return workers_.size();
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> task) {
+	std::packaged_task<void()> packaged(task);
+	std::future<void> done = packaged.get_future();
+	{
+		std::lock_guard<std::mutex> lock(tasks_mutex_);
+		tasks_.push(std::move(packaged));
+	}
+	task_ready_.notify_one();
+	return done;
+}
+
+void ThreadPool::run_all(const std::vector<std::function<void()> >& tasks) {
+	std::vector<std::future<void> > done;
+	for (unsigned int i = 0; i < tasks.size(); ++i) {
+		done.push_back(submit(tasks[i]));
+	}
+	//	wait for all of them before an exception can leave this method, since 
+	//	the tasks may use the caller's variables
+	for (unsigned int i = 0; i < done.size(); ++i) {
+		done[i].wait();
+	}
+	for (unsigned int i = 0; i < done.size(); ++i) {
+		done[i].get();
+	}
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+void ThreadPool::work() {
+	while (true) {
+		std::packaged_task<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(tasks_mutex_);
+			task_ready_.wait(lock, [this]() { 
+				return stopping_ || !tasks_.empty(); 
+			});
+			if (tasks_.empty()) {
+				return;
+			}
+			task = std::move(tasks_.front());
+			tasks_.pop();
+		}
+		task();
+	}
+}
@@ -0,0 +1,70 @@
+/*******************************************************************************
+  Title          : thread_pool.h
+  Description    : The interface file for the ThreadPool class
+  Purpose        : To run pieces of work on a fixed set of threads instead of 
+                   starting a thread for every piece
+  Usage          : Give run_all() a list of tasks that do not depend on each 
+                   other. It returns once every one of them has run
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/*******************************************************************************
+
+		The ThreadPool class starts its threads when it is created and keeps them 
+		until it is destroyed. Tasks are kept in one queue in the order they were
+		submitted and each thread takes the oldest task when it is free. A task 
+		must not wait for another task of the same ThreadPool, since every thread 
+		may be busy waiting. An exception thrown by a task is thrown again by 
+		get() on its std::future, or by run_all()
+
+*******************************************************************************/
+
+class ThreadPool {
+ public:
+	//	Starts number_of_threads threads, or one thread for each processor if 
+	//	number_of_threads is 0
+	explicit ThreadPool(int number_of_threads = 0);
+
+	//	Runs the tasks that are still queued and stops the threads
+	~ThreadPool();
+
+	//	Returns the number of threads
+	int size() const;
+
+	//	Queues task and returns a std::future that is ready when it has run
+	std::future<void> submit(std::function<void()> task);
+
+	//	Queues every task in tasks and returns once all of them have run
+	void run_all(const std::vector<std::function<void()> >& tasks);
+
+ protected:
+	//	What each thread runs: takes tasks off the queue until the ThreadPool is
+	//	being destroyed and the queue is empty
+	void work();
+
+ private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	std::vector<std::thread> workers_;
+	std::queue<std::packaged_task<void()> > tasks_;
+	std::mutex tasks_mutex_;
+	std::condition_variable task_ready_;
+	bool stopping_;
+};
+
+#endif
@@ -0,0 +1,145 @@
+/*******************************************************************************
+  Title          : trace.cpp
+  Description    : The implementation file for the TraceLog and TraceSpan
+                   classes
+  Purpose        : To record when each part of loading the census and running
+                   the commands started and ended, on which thread, in a file
+                   that Chrome's about:tracing and Perfetto can show
+  Usage          : Call TraceLog::start() with a file name, put a TraceSpan
+                   object in each block to record, and call TraceLog::stop()
+                   to write the file
+  Build with     : g++ -c -std=c++11 trace.cpp
+  Modifications  :
+
+*******************************************************************************/
+
+#include "trace.h"
+#include <fstream>
+#include <iomanip>
+#include <ios>
+#include <iostream>
+
+std::atomic<bool> TraceLog::enabled_(false);
+std::mutex TraceLog::mutex_;
+std::vector<TraceEvent> TraceLog::events_;
+std::string TraceLog::file_name_;
+std::chrono::steady_clock::time_point TraceLog::origin_;
+
+bool TraceLog::start(const std::string& file_name) {
+	//	make sure the file can be written before any work is traced
+	std::ofstream trace_file(file_name.c_str());
+	if (trace_file.fail()) {
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(mutex_);
+	file_name_ = file_name;
+	events_.clear();
+	origin_ = std::chrono::steady_clock::now();
+	enabled_ = true;
+	return true;
+}
+
+void TraceLog::stop() {
+	std::vector<TraceEvent> events;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!enabled_) {
+			return;
+		}
+		enabled_ = false;
+		events.swap(events_);
+	}
+	std::ofstream trace_file(file_name_.c_str());
+	if (trace_file.fail()) {
+		std::cerr << "Unable to open trace file: " << file_name_ << std::endl;
+		return;
+	}
+	write(trace_file, events);
+}
+
+void TraceLog::add(const char* name, const char* category,
+                   std::chrono::steady_clock::time_point start,
+                   std::chrono::steady_clock::time_point end) {
+	TraceEvent event;
+	event.name = name;
+	event.category = category;
+	event.thread = thread_number();
+	std::lock_guard<std::mutex> lock(mutex_);
+	if (!enabled_) {
+		return;
+	}
+	event.start_nanoseconds =
+	    std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin_)
+	    .count();
+	event.nanoseconds =
+	    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+	    .count();
+	events_.push_back(event);
+}
+
+void TraceLog::write(std::ostream& out, const std::vector<TraceEvent>& events)
+{
+	out << "{\"traceEvents\": [" << std::endl;
+	out << std::fixed << std::setprecision(3);
+	for (unsigned int i = 0; i < events.size(); ++i) {
+		const TraceEvent& event = events[i];
+		out << "  {\"name\": \"";
+		for (char c : event.name) {
+			if ('"' == c || '\\' == c) {
+				out << '\\' << c;
+			} else if (static_cast<unsigned char>(c) < 0x20) {
+				out << ' ';
+			} else {
+				out << c;
+			}
+		}
+		out << "\", \"cat\": \"" << event.category << "\", \"ph\": \"X\""
+		    << ", \"ts\": " << event.start_nanoseconds / 1000.0
+		    << ", \"dur\": " << event.nanoseconds / 1000.0
+		    << ", \"pid\": 1, \"tid\": " << event.thread << "}";
+		if (i + 1 < events.size()) {
+			out << ",";
+		}
+		out << std::endl;
+	}
+	out << "], \"displayTimeUnit\": \"ms\"}" << std::endl;
+	out.copyfmt(std::ios(nullptr));
+}
+
+TraceSpan::TraceSpan(const char* name, const char* category)
+    : name_(name), category_(category), active_(TraceLog::enabled()) {
+	if (active_) {
+		start_ = std::chrono::steady_clock::now();
+	}
+}
+
+TraceSpan::~TraceSpan() {
+	if (active_) {
+		TraceLog::add(name_, category_, start_,
+		              std::chrono::steady_clock::now());
+	}
+}
+
+void TraceSpan::restart() {
+	if (active_) {
+		std::chrono::steady_clock::time_point end =
+		    std::chrono::steady_clock::now();
+		TraceLog::add(name_, category_, start_, end);
+		start_ = end;
+	}
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+int TraceLog::thread_number() {
+	static std::atomic<int> next_thread(1);
+	static thread_local int thread = 0;
+	if (0 == thread) {
+		thread = next_thread++;
+	}
+	return thread;
+}
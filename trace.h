@@ -0,0 +1,119 @@
+/*******************************************************************************
+  Title          : trace.h
+  Description    : The interface file for the TraceLog and TraceSpan classes
+  Purpose        : To record when each part of loading the census and running
+                   the commands started and ended, on which thread, in a file
+                   that Chrome's about:tracing and Perfetto can show
+  Usage          : Call TraceLog::start() with a file name, put a TraceSpan
+                   object in each block to record, and call TraceLog::stop()
+                   to write the file
+  Build with     : No building
+  Modifications  :
+
+*******************************************************************************/
+
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//	One span of time on one thread
+struct TraceEvent {
+	std::string name;
+	const char* category;
+	int thread;
+	long long start_nanoseconds;
+	long long nanoseconds;
+};
+
+/*******************************************************************************
+
+		The TraceLog class keeps the spans that TraceSpan objects record and
+		writes them to a file in the trace_event JSON format, as complete ("X")
+		events with times in microseconds since start() was called. Spans that
+		are inside each other on the same thread are shown nested. Tracing is
+		always compiled in but nothing is recorded until start() is called, and
+		until then a TraceSpan only checks one flag when it is made and one when
+		it is destroyed. The spans are kept in memory and only written by stop(),
+		so recording one costs a clock read and a short locked push_back
+
+*******************************************************************************/
+
+class TraceLog {
+ public:
+	//	Starts recording spans, which stop() will write to file_name
+	//	Returns false if file_name cannot be opened, in which case nothing is
+	//	recorded
+	static bool start(const std::string& file_name);
+
+	//	Returns true if spans are being recorded
+	static bool enabled() {
+		return enabled_.load(std::memory_order_relaxed);
+	}
+
+	//	Stops recording and writes every span recorded to the file given to
+	//	start(). Does nothing if start() was not called
+	static void stop();
+
+	//	Records a span called name in category that started at start and ended
+	//	at end on the calling thread
+	static void add(const char* name, const char* category,
+	                std::chrono::steady_clock::time_point start,
+	                std::chrono::steady_clock::time_point end);
+
+	//	Outputs events in the trace_event JSON format
+	static void write(std::ostream& out, const std::vector<TraceEvent>& events);
+
+ protected:
+	//	Returns a small number for the calling thread, which is the same every
+	//	time that thread calls it
+	static int thread_number();
+
+ private:
+	static std::atomic<bool> enabled_;
+	static std::mutex mutex_;
+	static std::vector<TraceEvent> events_;
+	static std::string file_name_;
+	static std::chrono::steady_clock::time_point origin_;
+};
+
+/*******************************************************************************
+
+		A TraceSpan object records the time from when it is made until it is
+		destroyed as a span in the TraceLog, if the TraceLog was started by
+		then. name has to stay valid until the TraceSpan is destroyed. restart()
+		ends the current span and starts another one with the same name, which
+		splits a long loop into one span per chunk
+
+*******************************************************************************/
+
+class TraceSpan {
+ public:
+	//	Starts a span called name in category
+	explicit TraceSpan(const char* name, const char* category = "query");
+
+	//	Ends the span
+	~TraceSpan();
+
+	//	Ends the span and starts another one with the same name
+	void restart();
+
+ private:
+	TraceSpan(const TraceSpan&);
+	TraceSpan& operator=(const TraceSpan&);
+
+	const char* name_;
+	const char* category_;
+
+	//	True if the TraceLog was recording when the span started
+	bool active_;
+	std::chrono::steady_clock::time_point start_;
+};
+
+#endif
@@ -16,98 +16,126 @@
 #include <sstream>
 #include <iostream>
 #include "tree.h"
+#include "census_file.h"
+#include "street_dictionary.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
 #include <string>
 
 Tree::Tree() {
-	spc_common_ = "";
+	spc_common_ = species_name("");
 	tree_id_ = 0;
 	tree_dbh_ = 0;
-	status_ = "";
-	health_ = "";
-	address_ = "";
-	boroname_ = "";
+	status_ = NO_STATUS;
+	health_ = NO_HEALTH;
+	house_number_ = -1;
+	street_ = nullptr;
+	borough_ = ALLBOROS;
 	zipcode_ = 0;
 	latitude_ = 0;
 	longitude_ = 0;
+	species_id_ = -1;
+	record_ = nullptr;
 }
 
 Tree::Tree(const std::string& treedata) {
-	std::string data;
+	parse_line(treedata, nullptr);
+}
+
+Tree::Tree(const std::string& treedata, StreetDictionary& streets) {
+	parse_line(treedata, &streets);
+}
+
+Tree::Tree(int id, int diam, std::string status, std::string health,
+           std::string spc, int zip, std::string addr, std::string boro, 
+           double latitude, double longitude, StreetDictionary* streets) {
+	spc_common_ = species_name(spc);
+	tree_id_ = id;
+	tree_dbh_ = diam;
+	status_ = status_of(status);
+	health_ = health_of(health);
+	set_address(addr, streets);
+	borough_ = borough_of(boro);
+	zipcode_ = zip;
+	latitude_ = latitude;
+	longitude_ = longitude;
+	species_id_ = -1;
+	record_ = nullptr;
+}
+
+//	Reads the same columns as Tree(const std::string&), straight from the 
+//	mapped record, but copies only the ones kept in memory. strtol and strtod 
+//	stop at the comma or newline after the number, so no field is copied
+Tree::Tree(const CensusFile& census, long offset, long end_offset) {
+	tree_id_ = 0;
+	tree_dbh_ = 0;
+	zipcode_ = 0;
+	status_ = NO_STATUS;
+	house_number_ = -1;
+	street_ = nullptr;
+	latitude_ = 0;
+	longitude_ = 0;
+	species_id_ = -1;
+	record_ = census.data() + offset;
+	const char* field = record_;
+	const char* end = census.data() + end_offset;
 	int count = 1;
-	std::istringstream line(treedata);
-	std::stringstream convert;
-	//	Extract the specific information we need from specific columns/spots in
-	//	the treedata string using stringstream to convert the string data
-	while ((std::getline(line, data, ',')) && (40 > count)) {
+	while (field < end && 40 > count) {
+		const char* comma = static_cast<const char*>(
+		    memchr(field, ',', end - field));
+		if (comma == nullptr) {
+			comma = end;
+		}
 		if (1 == count) {
-			convert << data << " ";
-			convert >> tree_id_;
+			tree_id_ = strtol(field, nullptr, 10);
 		} else if (4 == count) {
-			convert << data << " ";
-			convert >> tree_dbh_;
-		} else if (7 == count) {
-			status_ = data;
+			tree_dbh_ = strtol(field, nullptr, 10);
 		} else if (8 == count) {
-			health_ = data;
+			health_ = health_of(std::string(field, comma));
 		} else if (10 == count) {
-			spc_common_ = data;
+			spc_common_ = species_name(std::string(field, comma));
 		} else if (25 == count) {
-			if (isdigit(data[0])) {
-				address_ = data;
-			} else {
-				//	The column right before the address column may have more than one
-				//	piece of data separated by commas. We need to skip over this data to
-				//	get the address. The address always begins with a number so we will 
-				//	read until we get data that begins with a number, which will be the 
-				//	address
-				while (!isdigit(data[0])) {
-					std::getline(line, data, ',');
+			//	skip the pieces of the column before the address, which may have
+			//	commas, up to the address, which always begins with a number
+			while (comma < end && !isdigit(*field)) {
+				field = comma + 1;
+				comma = static_cast<const char*>(memchr(field, ',', end - field));
+				if (comma == nullptr) {
+					comma = end;
 				}
-				address_ = data;
 			}
 		} else if (26 == count) {
-			convert << data << " ";
-			convert >> zipcode_;
+			zipcode_ = strtol(field, nullptr, 10);
 		} else if (30 == count) {
-			boroname_ = data;
+			borough_ = borough_of(std::string(field, comma));
 		} else if (38 == count) {
-			convert << data << " ";
-			convert >> latitude_;
+			latitude_ = strtod(field, nullptr);
 		} else if (39 == count) {
-			convert << data;
-			convert >> longitude_;
+			longitude_ = strtod(field, nullptr);
 		}
-		convert.str(std::string());	//	clear the stringstream
+		field = comma + 1;
 		++count;
 	}
 }
 
-Tree::Tree(int id, int diam, std::string status, std::string health,
-           std::string spc, int zip, std::string addr, std::string boro, 
-           double latitude, double longitude) {
-	spc_common_ = spc;
-	tree_id_ = id;
-	tree_dbh_ = diam;
-	status_ = status;
-	health_ = health;
-	address_ = addr;
-	boroname_ = boro;
-	zipcode_ = zip;
-	latitude_ = latitude;
-	longitude_ = longitude;
-}
-
 Tree::Tree(const Tree& other_tree) {
 	spc_common_ = other_tree.spc_common_;
 	tree_id_ = other_tree.tree_id_;
 	tree_dbh_ = other_tree.tree_dbh_;
 	status_ = other_tree.status_;
 	health_ = other_tree.health_;
-	address_ = other_tree.address_;
-	boroname_ = other_tree.boroname_;
+	house_number_ = other_tree.house_number_;
+	street_ = other_tree.street_;
+	borough_ = other_tree.borough_;
 	zipcode_ = other_tree.zipcode_;
 	latitude_ = other_tree.latitude_;
 	longitude_ = other_tree.longitude_;
+	species_id_ = other_tree.species_id_;
+	record_ = other_tree.record_;
 }
 
 Tree::~Tree() {
@@ -121,25 +149,30 @@ bool operator==(const Tree& t1, const Tree& t2) {
 	}
 }
 
+//	Equal names are the same interned string, so only different ones are 
+//	compared character by character
 bool operator<(const Tree& t1, const Tree& t2) {
-	if (t1.spc_common_ < t2.spc_common_) {
-		return true;
-	} else if (t1.spc_common_ == t2.spc_common_) {
-		if (t1.tree_id_ < t2.tree_id_) {
-			return true;
-		}
+	if (t1.spc_common_ == t2.spc_common_) {
+		return t1.tree_id_ < t2.tree_id_;
 	}
-	return false;
+	return *t1.spc_common_ < *t2.spc_common_;
 }
 
 std::ostream& operator<<(std::ostream& os, const Tree& t) {
-	os << t.spc_common_ << ", ";
+	std::string status, address;
+	if (t.record_ != nullptr) {
+		t.parse_record(status, address);
+	} else {
+		status = Tree::status_text(t.status_);
+		address = t.nearest_address();
+	}
+	os << *t.spc_common_ << ", ";
 	os << t.tree_id_ << ", ";
 	os << t.tree_dbh_ << ", "; 
-	os << t.status_ << ", ";
-	os << t.health_ << ", ";
-	os << t.address_ << ", ";
-	os << t.boroname_ << ", ";
+	os << status << ", ";
+	os << Tree::health_text(t.health_) << ", ";
+	os << address << ", ";
+	os << t.borough_name() << ", ";
 	os << std::setfill('0') << std::setw(5) << t.zipcode_ << ", ";
 	os << std::setprecision(10) << t.latitude_ << ", ";
 	os << std::setprecision(10) << t.longitude_ << std::endl;
@@ -155,7 +188,8 @@ bool samename(const Tree& t1, const Tree& t2) {
 }
 
 bool islessname(const Tree& t1, const Tree& t2) {
-	if (t1.spc_common_ < t2.spc_common_) {
+	if (t1.spc_common_ != t2.spc_common_ && 
+			*t1.spc_common_ < *t2.spc_common_) {
 		return true;
 	} else {
 		return false;
@@ -168,11 +202,14 @@ Tree& Tree::operator=(const Tree& other_tree) {
 	tree_dbh_ = other_tree.tree_dbh_;
 	status_ = other_tree.status_;
 	health_ = other_tree.health_;
-	address_ = other_tree.address_;
-	boroname_ = other_tree.boroname_;
+	house_number_ = other_tree.house_number_;
+	street_ = other_tree.street_;
+	borough_ = other_tree.borough_;
 	zipcode_ = other_tree.zipcode_;
 	latitude_ = other_tree.latitude_;
 	longitude_ = other_tree.longitude_;
+	species_id_ = other_tree.species_id_;
+	record_ = other_tree.record_;
 	return *this;
 }
 
@@ -184,16 +221,48 @@ bool Tree::operator!=(const Tree& other_tree) {
 	return false;
 }
 
-std::string Tree::common_name() const {
-	return spc_common_;
+const std::string& Tree::common_name() const {
+	return *spc_common_;
 }
 
 std::string Tree::borough_name() const {
-	return boroname_;
+	static const char* const names[] = {"", "Manhattan", "Bronx", "Brooklyn", 
+	                                    "Queens", "Staten Island"};
+	return names[borough_];
 }
 
 std::string Tree::nearest_address() const {
-	return address_;
+	if (record_ != nullptr) {
+		std::string status, address;
+		parse_record(status, address);
+		return address;
+	}
+	if (street_ == nullptr) {
+		return "";
+	} else if (house_number_ < 0) {
+		return *street_;
+	}
+	return std::to_string(house_number_) + " " + *street_;
+}
+
+Borough Tree::borough() const {
+	return borough_;
+}
+
+int Tree::health_code() const {
+	return health_;
+}
+
+int Tree::species_id() const {
+	return species_id_;
+}
+
+void Tree::set_species_id(int id) {
+	species_id_ = id;
+}
+
+int Tree::id() const {
+	return tree_id_;
 }
 
 int Tree::diameter() const {
@@ -208,3 +277,224 @@ void Tree::get_position(double& latitude, double& longitude) const {
 	latitude = latitude_;
 	longitude = longitude_;
 }
+
+MemoryUsage Tree::species_names_usage() {
+	std::lock_guard<std::mutex> lock(species_names_mutex());
+	return species_names().memory_usage();
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+void Tree::parse_line(const std::string& treedata, 
+                      StreetDictionary* streets) {
+	species_id_ = -1;
+	status_ = NO_STATUS;
+	house_number_ = -1;
+	street_ = nullptr;
+	record_ = nullptr;
+	std::string data;
+	int count = 1;
+	std::istringstream line(treedata);
+	std::stringstream convert;
+	//	Extract the specific information we need from specific columns/spots in
+	//	the treedata string using stringstream to convert the string data
+	while ((std::getline(line, data, ',')) && (40 > count)) {
+		if (1 == count) {
+			convert << data << " ";
+			convert >> tree_id_;
+		} else if (4 == count) {
+			convert << data << " ";
+			convert >> tree_dbh_;
+		} else if (7 == count) {
+			status_ = status_of(data);
+		} else if (8 == count) {
+			health_ = health_of(data);
+		} else if (10 == count) {
+			spc_common_ = species_name(data);
+		} else if (25 == count) {
+			if (isdigit(data[0])) {
+				set_address(data, streets);
+			} else {
+				//	The column right before the address column may have more than one
+				//	piece of data separated by commas. We need to skip over this data to
+				//	get the address. The address always begins with a number so we will 
+				//	read until we get data that begins with a number, which will be the 
+				//	address
+				while (!isdigit(data[0])) {
+					std::getline(line, data, ',');
+				}
+				set_address(data, streets);
+			}
+		} else if (26 == count) {
+			convert << data << " ";
+			convert >> zipcode_;
+		} else if (30 == count) {
+			borough_ = borough_of(data);
+		} else if (38 == count) {
+			convert << data << " ";
+			convert >> latitude_;
+		} else if (39 == count) {
+			convert << data;
+			convert >> longitude_;
+		}
+		convert.str(std::string());	//	clear the stringstream
+		++count;
+	}
+}
+
+void Tree::parse_record(std::string& status, std::string& address) const {
+	const char* field = record_;
+	const char* comma = column_end(field);
+	for (int count = 1; count < 25; ++count) {
+		if (7 == count) {
+			status.assign(field, comma);
+		}
+		if ('\n' == *comma) {
+			return;
+		}
+		field = comma + 1;
+		comma = column_end(field);
+	}
+	//	skip the pieces of the column before the address, which may have
+	//	commas, up to the address, which always begins with a number
+	while ('\n' != *comma && !isdigit(*field)) {
+		field = comma + 1;
+		comma = column_end(field);
+	}
+	address.assign(field, comma);
+}
+
+const char* Tree::column_end(const char* field) {
+	while (',' != *field && '\n' != *field) {
+		++field;
+	}
+	return field;
+}
+
+void Tree::set_address(const std::string& address, 
+                       StreetDictionary* streets) {
+	std::string::size_type space = address.find(' ');
+	std::string::size_type length = std::min(space, address.size());
+	//	a plain number has only digits, no leading zero and fits in an int
+	bool plain = 0 < length && length < 10 && (1 == length || '0' != address[0]);
+	for (std::string::size_type i = 0; plain && i < length; ++i) {
+		plain = isdigit(address[i]);
+	}
+	if (plain && space != std::string::npos && space + 1 < address.size()) {
+		house_number_ = atoi(address.c_str());
+		street_ = intern(address.substr(space + 1), streets);
+	} else {
+		house_number_ = -1;
+		street_ = intern(address, streets);
+	}
+}
+
+const std::string* Tree::intern(const std::string& text, 
+                                StreetDictionary* streets) {
+	if (text.empty()) {
+		return nullptr;
+	}
+	if (streets != nullptr) {
+		return streets->intern(text);
+	}
+	//	Trees made without a StreetDictionary share this one, which any thread
+	//	may add to, so adding takes a lock
+	static StreetDictionary shared_streets;
+	static std::mutex shared_streets_mutex;
+	std::lock_guard<std::mutex> lock(shared_streets_mutex);
+	return shared_streets.intern(text);
+}
+
+TreeStatus Tree::status_of(const std::string& status) {
+	if ("Alive" == status) {
+		return ALIVE;
+	} else if ("Dead" == status) {
+		return DEAD;
+	} else if ("Stump" == status) {
+		return STUMP;
+	}
+	return NO_STATUS;
+}
+
+const char* Tree::status_text(TreeStatus status) {
+	switch (status) {
+		case ALIVE:
+			return "Alive";
+		case DEAD:
+			return "Dead";
+		case STUMP:
+			return "Stump";
+		default:
+			return "";
+	}
+}
+
+//	uses the same process of elimination as 
+//	TreeCollection::convert_to_tree_borough
+Borough Tree::borough_of(const std::string& boroname) {
+	if (boroname.empty()) {
+		return ALLBOROS;
+	} else if ('M' == boroname.front()) {
+		return MANHATTAN;
+	} else if ('x' == boroname.back()) {
+		return BRONX;
+	} else if ('B' == boroname.front()) {
+		return BROOKLYN;
+	} else if ('Q' == boroname.front()) {
+		return QUEENS;
+	}
+	return STATEN;
+}
+
+TreeHealth Tree::health_of(const std::string& health) {
+	if (health.empty()) {
+		return NO_HEALTH;
+	} else if ('G' == health[0]) {
+		return GOOD;
+	} else if ('F' == health[0]) {
+		return FAIR;
+	}
+	return POOR;
+}
+
+const char* Tree::health_text(TreeHealth health) {
+	switch (health) {
+		case GOOD:
+			return "Good";
+		case FAIR:
+			return "Fair";
+		case POOR:
+			return "Poor";
+		default:
+			return "";
+	}
+}
+
+//	Each thread keeps the names it has looked up, so the lock is only taken 
+//	the first time a thread sees a species
+const std::string* Tree::species_name(const std::string& name) {
+	thread_local std::unordered_map<std::string, const std::string*> seen;
+	std::unordered_map<std::string, const std::string*>::iterator it = 
+	    seen.find(name);
+	if (it != seen.end()) {
+		return it->second;
+	}
+	std::lock_guard<std::mutex> lock(species_names_mutex());
+	const std::string* interned = species_names().intern(name);
+	seen[name] = interned;
+	return interned;
+}
+
+StreetDictionary& Tree::species_names() {
+	static StreetDictionary names;
+	return names;
+}
+
+std::mutex& Tree::species_names_mutex() {
+	static std::mutex mutex;
+	return mutex;
+}
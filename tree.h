@@ -16,15 +16,62 @@
 #ifndef __TREE_H__
 #define __TREE_H__
 
+#include "memory_stats.h"
+#include <mutex>
 #include <string>
 
+class CensusFile;
+class StreetDictionary;
+
+//	Borough is used to represent each of the five boroughs of New York City as
+//	a small integer instead of a string. ALLBOROS represents all 5 boroughs
+enum Borough {
+		ALLBOROS = 0,
+		MANHATTAN,
+		BRONX,
+		BROOKLYN,
+		QUEENS,
+		STATEN
+	};
+
+//	TreeStatus is used to represent the living status of a tree as a small 
+//	integer instead of a string. NO_STATUS stands for an empty status
+enum TreeStatus {
+		NO_STATUS = 0,
+		ALIVE,
+		DEAD,
+		STUMP
+	};
+
+//	TreeHealth is used to represent the health of a tree as a small integer 
+//	instead of a string. NO_HEALTH stands for an empty health
+enum TreeHealth {
+		NO_HEALTH = 0,
+		GOOD,
+		FAIR,
+		POOR
+	};
+
 /*******************************************************************************
 
 		The Tree class stores information about a single tree in the New York City 
 		area from the 2015 Street Tree Census. Its private member variables all
 		store a piece of data from the 2015 NYC Street Tree Census. It doesn't
 		store all the data of a tree found in the Tree Census file and it also
-		orders the data differently
+		orders the data differently. The fields that queries search and count 
+		by are stored in the Tree, and all of them have a fixed size: the 
+		health is stored as a TreeHealth and the borough as a Borough, whose 
+		names are only looked up when the Tree is printed, and the common name 
+		is a pointer to the one copy of that name that all Trees share. The 
+		status, which is only printed, is stored as a TreeStatus. The address is stored as its house number, an integer, 
+		and a pointer to its street in the StreetDictionary of the collection 
+		that parsed the Tree, which must outlive the Tree and its copies. An 
+		address whose house number is not a plain number is kept whole in the 
+		StreetDictionary instead. A Tree made without a StreetDictionary uses 
+		one that is shared by all such Trees. A Tree made from a record of a 
+		CensusFile leaves its status and address empty and instead points to its
+		record, and parses the status and address columns from it only when they
+		are printed or asked for
 
 *******************************************************************************/
 
@@ -36,10 +83,20 @@ class Tree {
 	//	Creates Tree object from the data in the string treedata
 	Tree(const std::string& treedata);
 
-	//	Creates Tree object
+	//	Creates Tree object from the data in the string treedata, adding the 
+	//	street of its address to streets
+	Tree(const std::string& treedata, StreetDictionary& streets);
+
+	//	Creates Tree object from the record at offset in census, whose newline 
+	//	is at end, without parsing the status and the address. census must 
+	//	outlive the Tree object and its copies
+	Tree(const CensusFile& census, long offset, long end);
+
+	//	Creates Tree object. The street of addr is added to streets, or to the 
+	//	shared StreetDictionary if streets is null
 	Tree(int id, int diam, std::string status, std::string health, 
 			 std::string spc, int zip, std::string addr, std::string boro, 
-			 double latitude, double longitude);
+			 double latitude, double longitude, StreetDictionary* streets = nullptr);
 
 	//	Creates a Tree object that is an exact copy of other_tree
 	Tree(const Tree& other_tree);
@@ -75,15 +132,34 @@ class Tree {
 	//	and the same tree_id_ member value 
 	bool operator!=(const Tree& other_tree);
 
-	//	Returns spc_common_, which is the common name of the tree
-	std::string common_name() const;
+	//	Returns the common name of the tree that spc_common_ points to
+	const std::string& common_name() const;
 
-	//	Returns boroname_, which is the borough in which the tree is located
+	//	Returns the name of borough_, which is the borough in which the tree is
+	//	located
 	std::string borough_name() const;
 
-	//	Returns address_, which is the nearest address to the tree
+	//	Returns the nearest address to the tree, which is house_number_ and 
+	//	the street that street_ points to, or the address column of record_
 	std::string nearest_address() const;
 
+	//	Returns borough_
+	Borough borough() const;
+
+	//	Returns health_, which is 1 if the health is "Good", 2 if it is "Fair",
+	//	3 if it is "Poor" and 0 if it is the empty string
+	int health_code() const;
+
+	//	Returns species_id_, the dense number given to spc_common_ by the 
+	//	collection that stores this Tree. Returns -1 if it was never set
+	int species_id() const;
+
+	//	Sets species_id_ to id
+	void set_species_id(int id);
+
+	//	Returns tree_id_, which is the tree's unique identification number
+	int id() const;
+
 	//	Returns tree_dbh_, which is the tree's diameter
 	int diameter() const;
 
@@ -95,10 +171,64 @@ class Tree {
 	//	longitude_ member
 	void get_position(double& latitude, double& longitude) const;
 
+	//	Returns the memory used by the common names that all Trees share
+	static MemoryUsage species_names_usage();
+
+ protected:
+	//	Sets the members from the data in the string treedata, adding the street
+	//	of its address to streets
+	void parse_line(const std::string& treedata, StreetDictionary* streets);
+
+	//	Sets status and address to the status and address columns of record_,
+	//	which must not be null
+	void parse_record(std::string& status, std::string& address) const;
+
+	//	Returns the comma or newline that ends the column that starts at field
+	static const char* column_end(const char* field);
+
+	//	Sets house_number_ to the part of address before its first space and 
+	//	street_ to the copy in streets of the rest of it. If that part is not a
+	//	plain number, house_number_ is -1 and street_ is the copy of address
+	void set_address(const std::string& address, StreetDictionary* streets);
+
+	//	Returns the copy of text in streets, or in the shared StreetDictionary 
+	//	if streets is null, or null if text is empty
+	static const std::string* intern(const std::string& text, 
+	                                 StreetDictionary* streets);
+
+	//	Returns the Borough of boroname, using the same process of elimination 
+	//	as TreeCollection::convert_to_tree_borough
+	static Borough borough_of(const std::string& boroname);
+
+	//	Returns the TreeHealth of health: NO_HEALTH if it is empty, GOOD or 
+	//	FAIR if it starts like "Good" or "Fair", and POOR otherwise
+	static TreeHealth health_of(const std::string& health);
+
+	//	Returns the text of health, which is empty for NO_HEALTH
+	static const char* health_text(TreeHealth health);
+
+	//	Returns the copy of name that all Trees share, adding it if no Tree has
+	//	that name yet. Any thread may call it
+	static const std::string* species_name(const std::string& name);
+
+	//	The copies of the common names and the lock taken to add to them
+	static StreetDictionary& species_names();
+	static std::mutex& species_names_mutex();
+
+	//	Returns the TreeStatus of status, or NO_STATUS if it is not one
+	static TreeStatus status_of(const std::string& status);
+
+	//	Returns the text of status, which is empty for NO_STATUS
+	static const char* status_text(TreeStatus status);
+
  private:
+	//	The fields queries search and count by come first, so that they share
+	//	the first cache lines of the Tree
 
-	//	The common name of the tree which can be the empty string
-	std::string spc_common_;
+	//	The common name of the tree which can be the empty string. Trees with 
+	//	the same name point to the same string, so names are equal exactly 
+	//	when the pointers are
+	const std::string* spc_common_;
 	
 	//	The unique non-negative identification number of the tree
 	int tree_id_;
@@ -106,27 +236,40 @@ class Tree {
 	//	A non-negative integer representing the diameter of the tree
 	int tree_dbh_;
 
-	//	The living status of the tree which is either "Alive", "Dead", or "Stump"
-	std::string status_;
+	//	The condition of the tree which is either GOOD, FAIR, POOR or NO_HEALTH
+	TreeHealth health_;
 
-	//	The condition of the tree which is either "Good", "Fair", "Poor" or the
-	//	empty string
-	std::string health_;
-
-	//	The address closest to the tree
-	std::string address_;
-
-	//	The borough where the tree is located
-	std::string boroname_;
+	//	The borough where the tree is located, or ALLBOROS if it is empty
+	Borough borough_;
 
 	//	The zipcode where the tree is located
 	int zipcode_;
 
+	//	The dense number of spc_common_, which lets aggregations count by 
+	//	species in an array instead of comparing strings
+	int species_id_;
+
 	//	The latitude of the tree's location
 	double latitude_;
 
 	//	The longitude of the tree's location
 	double longitude_;
+
+	//	The living status of the tree which is either ALIVE, DEAD, STUMP or 
+	//	NO_STATUS
+	TreeStatus status_;
+
+	//	The house number of the address closest to the tree, or -1 if street_ 
+	//	holds the whole address
+	int house_number_;
+
+	//	The street of the address closest to the tree, or the whole address, 
+	//	in a StreetDictionary, or null if the address is empty
+	const std::string* street_;
+
+	//	The census record the status and the address are parsed from when they
+	//	are needed, or null if they were parsed when the Tree was made
+	const char* record_;
 };
 
 #endif
@@ -12,13 +12,20 @@
 *******************************************************************************/
 
 #include "tree_collection.h"
+#include "perf_profiler.h"
+#include "street_dictionary.h"
+#include "trace.h"
 #include <iostream>
 #include <iomanip>
 #include <vector>
 
-TreeCollection::TreeCollection() : trees_(), all_species_()
+TreeCollection::TreeCollection(IndexBackend backend)
+    : trees_(make_tree_index(backend)), backend_(backend), all_species_(),
+    species_by_borough_(0, BY_BOROUGH), species_by_zip_(0, BY_ZIP),
+    traversal_pool_(nullptr), species_allocated_bytes_(0)
 {
 	trees_by_borough_.fill(0);
+	duplicates_by_borough_.fill(0);
 }
 
 TreeCollection::~TreeCollection()
@@ -31,13 +38,13 @@ int TreeCollection::total_tree_count() const {
 
 int TreeCollection::count_of_tree_species(const std::string& species_name) const
 {
-	if (trees_.empty()) {
+	if (trees_->empty()) {
 		return 0;
 	}
-	string_list matches = all_species_.get_matching_species(species_name);
+	string_list matches = get_matching_species(species_name);
 	int total = 0;
 	for (string_list::iterator it = matches.begin(); it != matches.end(); ++it) {
-		total += trees_.count_species(*it);
+		total += trees_->count_species(*it);
 	}
 	return total;
 }
@@ -66,34 +73,226 @@ int TreeCollection::count_of_trees_in_boro(const std::string& boro_name) const {
 
 string_list TreeCollection::get_matching_species(
     const std::string& species_name) const {
+	TraceSpan span("get_matching_species");
 	return all_species_.get_matching_species(species_name);
 }
 
 string_list TreeCollection::get_all_in_zipcode(int zipcode) const {
-	return trees_.all_in_zipcode(zipcode);
+	if (traversal_pool_ != nullptr) {
+		return trees_->all_in_zipcode(zipcode, *traversal_pool_);
+	}
+	return trees_->all_in_zipcode(zipcode);
 }
 
 string_list TreeCollection::get_all_near(double latitude, double longitude,
                                          double distance) const {
-	return trees_.all_nearby(latitude, longitude, distance);
+	if (traversal_pool_ != nullptr) {
+		return trees_->all_nearby(latitude, longitude, distance, *traversal_pool_);
+	}
+	return trees_->all_nearby(latitude, longitude, distance);
+}
+
+int TreeCollection::species_id(const std::string& species_name) const {
+	std::map<std::string, int>::const_iterator it = 
+			species_ids_.find(species_name);
+	if (it == species_ids_.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+int TreeCollection::number_of_species() const {
+	return species_names_.size();
 }
 
 bool TreeCollection::empty() const {
-	if (trees_.empty()) {
+	if (trees_->empty()) {
 		return true;
 	}
 	return false;
 }
 
+void TreeCollection::set_traversal_pool(WorkStealingPool* pool) {
+	traversal_pool_ = pool;
+}
+
 void TreeCollection::insert_tree(const Tree& tree) {
-	trees_.insert(tree);
-	all_species_.add_species(tree.common_name());
-	Borough b = convert_to_tree_borough(tree.borough_name());
+	IngestProfile::time_point since = ingest_profile_.now();
+	Tree new_tree(tree);
+	new_tree.set_species_id(add_species_id(tree.common_name()));
+	ingest_profile_.lap(VIEWS_PHASE, since);
+	bool inserted = trees_->insert(new_tree);
+	ingest_profile_.lap(INDEX_PHASE, since);
+	if (inserted) {
+		species_by_borough_.add(new_tree);
+		species_by_zip_.add(new_tree);
+	}
+	ingest_profile_.lap(VIEWS_PHASE, since);
+	{
+		AllocationScope species_scope(species_allocated_bytes_);
+		all_species_.add_species(tree.common_name());
+	}
+	ingest_profile_.lap(SPECIES_PHASE, since);
+	Borough b = tree.borough();
 	++trees_by_borough_[b];
 	++trees_by_borough_[ALLBOROS];
+	if (!inserted) {
+		++duplicates_by_borough_[b];
+		++duplicates_by_borough_[ALLBOROS];
+	}
+	ingest_profile_.lap(VIEWS_PHASE, since);
 	return;
 }
 
+int TreeCollection::load(std::istream& tree_file) {
+	std::string line;
+	int number_of_lines = 0;
+	TraceSpan load_span("load", "load");
+	TraceSpan chunk_span("parse and insert rows", "load");
+	IngestProfile::time_point since = ingest_profile_.now();
+	while (std::getline(tree_file, line)) {
+		if (tree_file.eof()) {
+			break;
+		}
+		if (0 < number_of_lines && 0 == number_of_lines % kTraceChunkRows) {
+			chunk_span.restart();
+		}
+		ingest_profile_.lap(READ_PHASE, since);
+		Tree new_tree(line, streets_);
+		ingest_profile_.lap(PARSE_PHASE, since);
+		insert_tree(new_tree);
+		since = ingest_profile_.now();
+		++number_of_lines;
+	}
+	ingest_profile_.lap(READ_PHASE, since);
+	//	the census only changes again if a Tree is removed
+	{
+		TraceSpan freeze_span("freeze index", "load");
+		trees_->freeze();
+	}
+	ingest_profile_.lap(FREEZE_PHASE, since);
+	ingest_profile_.add_rows(number_of_lines);
+	return number_of_lines;
+}
+
+int TreeCollection::load(std::shared_ptr<const CensusFile> census) {
+	census_ = census;
+	int number_of_lines = 0;
+	TraceSpan load_span("load", "load");
+	TraceSpan chunk_span("parse and insert rows", "load");
+	IngestProfile::time_point since = ingest_profile_.now();
+	long offset = 0;
+	long end;
+	while (0 <= (end = census->record_end(offset))) {
+		if (0 < number_of_lines && 0 == number_of_lines % kTraceChunkRows) {
+			chunk_span.restart();
+		}
+		ingest_profile_.lap(READ_PHASE, since);
+		Tree new_tree(*census, offset, end);
+		ingest_profile_.lap(PARSE_PHASE, since);
+		insert_tree(new_tree);
+		since = ingest_profile_.now();
+		offset = end + 1;
+		++number_of_lines;
+	}
+	census->end_scan();
+	ingest_profile_.lap(READ_PHASE, since);
+	{
+		TraceSpan freeze_span("freeze index", "load");
+		trees_->freeze();
+	}
+	ingest_profile_.lap(FREEZE_PHASE, since);
+	ingest_profile_.add_rows(number_of_lines);
+	return number_of_lines;
+}
+
+void TreeCollection::set_hilbert_order(bool on) {
+	trees_->set_hilbert_order(on);
+}
+
+void TreeCollection::profile_ingest(bool on) {
+	ingest_profile_.enable(on);
+}
+
+const IngestProfile& TreeCollection::ingest_profile() const {
+	return ingest_profile_;
+}
+
+void TreeCollection::write_ingest_report(std::ostream& out) const {
+	ingest_profile_.write_report(out, backend_name(backend_),
+	                             trees_->rebalance_counters(), trees_->height());
+}
+
+void TreeCollection::add_memory_usage(MemoryReport& report) const {
+	trees_->add_memory_usage(report);
+	//	the nodes of a std::map cannot be reached, so their size is estimated
+	//	from the 32 bytes of colour and links that each one has before its value
+	MemoryUsage ids;
+	std::map<std::string, int>::const_iterator it;
+	for (it = species_ids_.begin(); it != species_ids_.end(); ++it) {
+		MemoryUsage node;
+		node.blocks = 1;
+		node.logical_bytes = sizeof(*it);
+		node.requested_bytes = 32 + sizeof(*it);
+		node.allocated_bytes = allocated_size(node.requested_bytes);
+		ids += node;
+		ids += string_usage(it->first);
+	}
+	report.add("species ids", ids);
+	MemoryUsage names = vector_usage(species_names_);
+	for (unsigned int i = 0; i < species_names_.size(); ++i) {
+		names += string_usage(species_names_[i]);
+	}
+	report.add("species names", names);
+	//	TreeSpecies keeps its list to itself, so only the allocator knows its 
+	//	size
+	MemoryUsage species;
+	species.logical_bytes = -1;
+	species.requested_bytes = -1;
+	species.allocated_bytes = species_allocated_bytes_;
+	report.add("TreeSpecies", species);
+	report.add("species by borough view", species_by_borough_.memory_usage());
+	report.add("species by zip view", species_by_zip_.memory_usage());
+	report.add("street dictionary", streets_.memory_usage());
+}
+
+void TreeCollection::write_memory_report(std::ostream& out) const {
+	MemoryReport report;
+	add_memory_usage(report);
+	report.write(out);
+}
+
+bool TreeCollection::remove_tree(const Tree& tree) {
+	const Tree& stored = trees_->find(tree);
+	if (stored == kNotFound.data) {
+		return false;
+	}
+	//	copy the stored Tree since removing it from trees_ destroys it
+	Tree old_tree(stored);
+	trees_->remove(old_tree);
+	species_by_borough_.remove(old_tree);
+	species_by_zip_.remove(old_tree);
+	--trees_by_borough_[old_tree.borough()];
+	--trees_by_borough_[ALLBOROS];
+	if (0 == species_by_borough_.species_total(old_tree.species_id())) {
+		std::vector<int> species_totals(species_names_.size());
+		for (unsigned int id = 0; id < species_totals.size(); ++id) {
+			species_totals[id] = species_by_borough_.species_total(id);
+		}
+		AllocationScope species_scope(species_allocated_bytes_);
+		all_species_ = species_with_trees(species_ids_, species_totals);
+	}
+	return true;
+}
+
+bool TreeCollection::remove_tree_by_id(int tree_id) {
+	const Tree& stored = trees_->find_by_id(tree_id);
+	if (stored == kNotFound.data) {
+		return false;
+	}
+	return remove_tree(Tree(stored));
+}
+
 //	this method optimizes the running time of comparisons by taking advantage
 //	of the uniqueness of the borough words. This method will only be used to
 //	convert whole borough names that ALREADY EXIST IN THE AVL_TREE into their 
@@ -121,7 +320,7 @@ void TreeCollection::tree_info(const std::string& partial_name) const {
 	if (partial_name == " ") {
 		matches.push_back("");
 	} else {
-		matches = all_species_.get_matching_species(partial_name);
+		matches = get_matching_species(partial_name);
 		if (matches.empty()) {
 			std::cout << "No " << partial_name << " trees were found." << std::endl;
 			std::cout << std::endl;
@@ -140,14 +339,239 @@ void TreeCollection::tree_info(const std::string& partial_name) const {
                     percent_man, percent_bx, percent_bk, percent_q,
                     percent_stat);
 
+	std::array<double, 6> totals = {{total_in_ny, total_in_man, total_in_bx, 
+	                                 total_in_bk, total_in_q, total_in_stat}};
+	print_frequencies(partial_name, matches, totals, trees_by_borough_);
+}
+
+void TreeCollection::total_occurrences(const string_list& match_list,
+                                       double& ny_total, double& man_total, 
+                                       double& bx_total, double& bk_total, 
+                                       double& q_total, double& stat_total,
+                                       double& ny_percent, double& man_percent, 
+                                       double& bx_percent, double& bk_percent, 
+                                       double& q_percent, double& stat_percent)
+																			 const {
+	TraceSpan span("total_occurrences");
+	//	the counts are looked up in the species by borough view instead of 
+	//	finding every matching Tree in trees_
+	for (auto it = match_list.begin(); it != match_list.end(); ++it) {
+		int id = matching_species_id(*it);
+		if (id < 0) {
+			continue;
+		}
+		man_total += species_by_borough_.count(id, MANHATTAN);
+		bx_total += species_by_borough_.count(id, BRONX);
+		bk_total += species_by_borough_.count(id, BROOKLYN);
+		q_total += species_by_borough_.count(id, QUEENS);
+		stat_total += species_by_borough_.count(id, STATEN);
+		ny_total += species_by_borough_.species_total(id);
+	}
+
+	ny_percent = (ny_total / trees_by_borough_[ALLBOROS]) * 100;
+
+	if (0 != trees_by_borough_[MANHATTAN]) {
+		man_percent = (man_total / trees_by_borough_[MANHATTAN]) * 100;
+	}
+
+	if (0 != trees_by_borough_[BRONX]) {
+		bx_percent = (bx_total / trees_by_borough_[BRONX]) * 100;
+	}
+
+	if (0 != trees_by_borough_[BROOKLYN]) {
+		bk_percent = (bk_total / trees_by_borough_[BROOKLYN]) * 100;
+	}
+
+	if (0 != trees_by_borough_[QUEENS]) {
+		q_percent = (q_total / trees_by_borough_[QUEENS]) * 100;
+	}
+
+	if (0 != trees_by_borough_[STATEN]) {
+		stat_percent = (stat_total / trees_by_borough_[STATEN]) * 100;
+	}
+}
+
+void TreeCollection::list_all_names() const {
+	all_species_.print_all_species(std::cout);
+	std::cout << std::endl;
+}
+	
+void TreeCollection::list_all_in_zip(int& zipcode) const {
+	print_zip_counts(zipcode, species_by_zip_, species_by_zip_.slot_of(zipcode),
+	                 species_ids_);
+}
+
+void TreeCollection::list_all_near(double& latitude, double& longitude,
+                                   double& distance) const {
+	GroupBy nearby(number_of_species(), BY_SPECIES);
+	if (traversal_pool_ != nullptr) {
+		trees_->group_nearby(latitude, longitude, distance, nearby,
+		                    *traversal_pool_);
+	} else {
+		trees_->group_nearby(latitude, longitude, distance, nearby);
+	}
+	print_near_counts(latitude, longitude, distance, nearby, species_ids_);
+}
+
+void TreeCollection::list_all_near_batch(const std::vector<NearbyQuery>& 
+                                         queries) const {
+	NearbyBatch batch(queries);
+	std::vector<GroupBy> nearby(queries.size(), 
+	                            GroupBy(number_of_species(), BY_SPECIES));
+	group_nearby_batch(*trees_, batch, nearby);
+	for (unsigned int q = 0; q < queries.size(); ++q) {
+		print_near_counts(queries[q].latitude, queries[q].longitude,
+		                  queries[q].distance, nearby[q], species_ids_);
+	}
+}
+
+void TreeCollection::list_in_corridor(const Corridor& corridor) const {
+	GroupBy found(number_of_species(), BY_SPECIES);
+	group_in_corridor(*trees_, corridor, found);
+	print_corridor_counts(corridor, found, species_ids_);
+}
+
+void TreeCollection::rollup(GroupKey key) const {
+	GroupBy groups(number_of_species(), key);
+	trees_->group_all(groups);
+	print_rollup(groups, species_ids_);
+}
+
+void TreeCollection::lookup(int tree_id) const {
+	const Tree& stored = trees_->find_by_id(tree_id);
+	if (stored == kNotFound.data) {
+		std::cout << "No tree found with id: " << tree_id << std::endl;
+	} else {
+		std::cout << "Tree " << tree_id << ":" << std::endl;
+		std::cout << stored;
+		std::cout.copyfmt(std::ios(nullptr));
+	}
+	std::cout << std::endl;
+}
+
+void TreeCollection::remove(int tree_id) {
+	if (remove_tree_by_id(tree_id)) {
+		std::cout << "Removed tree " << tree_id << std::endl;
+	} else {
+		std::cout << "No tree found with id: " << tree_id << std::endl;
+	}
+	std::cout << std::endl;
+}
+
+void TreeCollection::print_trees(int first, int last) const {
+	int number_of_trees = trees_->get_number_of_trees();
+	if (first < 0) {
+		first = 0;
+	}
+	if (number_of_trees < last) {
+		last = number_of_trees;
+	}
+	if (last <= first) {
+		std::cout << "No trees found from " << first << " to " << last;
+		std::cout << std::endl << std::endl;
+		return;
+	}
+	std::cout << "Trees " << first << " to " << last - 1 << " of ";
+	std::cout << number_of_trees << ":" << std::endl;
+	trees_->print(std::cout, first, last);
+	std::cout.copyfmt(std::ios(nullptr));
+	std::cout << std::endl;
+}
+
+bool TreeCollection::verify() const {
+	GroupBy by_borough(number_of_species(), BY_BOROUGH);
+	GroupBy by_zip(number_of_species(), BY_ZIP);
+	trees_->group_all(by_borough);
+	trees_->group_all(by_zip);
+	return verify_views(species_by_borough_, by_borough, species_by_zip_, by_zip,
+	                    trees_by_borough_, duplicates_by_borough_, species_ids_);
+}
+
+bool TreeCollection::verify_views(const GroupBy& species_by_borough,
+                                  const GroupBy& by_borough,
+                                  const GroupBy& species_by_zip,
+                                  const GroupBy& by_zip,
+                                  const std::array<int, 6>& trees_by_borough,
+                                  const std::array<int, 6>& 
+                                  duplicates_by_borough,
+                                  const std::map<std::string, int>& 
+                                  species_ids) {
+	std::cout << "Verifying materialized views:" << std::endl;
+	int mismatches = 0;
+	std::cout << "Species by borough: ";
+	if (species_by_borough == by_borough) {
+		std::cout << "OK" << std::endl;
+	} else {
+		std::cout << "MISMATCH" << std::endl;
+		mismatches += diff_views(species_by_borough, by_borough,
+		                         species_ids);
+	}
+	std::cout << "Species by zipcode: ";
+	if (species_by_zip == by_zip) {
+		std::cout << "OK" << std::endl;
+	} else {
+		std::cout << "MISMATCH" << std::endl;
+		mismatches += diff_views(species_by_zip, by_zip, species_ids);
+	}
+	//	every row is either a stored Tree or a duplicate of one
+	std::cout << "Total by borough: ";
+	bool totals_match = true;
+	for (int b = ALLBOROS; b <= STATEN; ++b) {
+		int slot = by_borough.slot_of(b);
+		int stored = by_borough.total();
+		if (ALLBOROS != b) {
+			stored = (-1 == slot) ? 0 : by_borough.slot_total(slot);
+		}
+		if (trees_by_borough[b] != stored + duplicates_by_borough[b]) {
+			totals_match = false;
+		}
+	}
+	std::cout << (totals_match ? "OK" : "MISMATCH") << std::endl;
+	if (0 < duplicates_by_borough[ALLBOROS]) {
+		std::cout << duplicates_by_borough[ALLBOROS] << " duplicate rows are ";
+		std::cout << "counted in the borough totals but not stored" << std::endl;
+	}
+	std::cout << std::endl;
+	return 0 == mismatches && totals_match;
+}
+
+void TreeCollection::print_frequencies(const std::string& partial_name,
+                                       const string_list& matches,
+                                       const std::array<double, 6>& totals,
+                                       const std::array<int, 6>& 
+                                       trees_by_borough) {
+	PerfRegion region("output formatting");
+	double total_in_ny = totals[ALLBOROS], total_in_man = totals[MANHATTAN];
+	double total_in_bx = totals[BRONX], total_in_bk = totals[BROOKLYN];
+	double total_in_q = totals[QUEENS], total_in_stat = totals[STATEN];
+	double percent_ny = 0, percent_man = 0, percent_bx = 0, percent_bk = 0; 
+	double percent_q = 0, percent_stat = 0;
+
+	percent_ny = (total_in_ny / trees_by_borough[ALLBOROS]) * 100;
+	if (0 != trees_by_borough[MANHATTAN]) {
+		percent_man = (total_in_man / trees_by_borough[MANHATTAN]) * 100;
+	}
+	if (0 != trees_by_borough[BRONX]) {
+		percent_bx = (total_in_bx / trees_by_borough[BRONX]) * 100;
+	}
+	if (0 != trees_by_borough[BROOKLYN]) {
+		percent_bk = (total_in_bk / trees_by_borough[BROOKLYN]) * 100;
+	}
+	if (0 != trees_by_borough[QUEENS]) {
+		percent_q = (total_in_q / trees_by_borough[QUEENS]) * 100;
+	}
+	if (0 != trees_by_borough[STATEN]) {
+		percent_stat = (total_in_stat / trees_by_borough[STATEN]) * 100;
+	}
+
 	if (partial_name == " ") {
 		std::cout << "Unknown" << std::endl;
 		std::cout << "All dead trees or stumps:" << std::endl;
 	} else {
 		std::cout << partial_name << std::endl;
 		std::cout << "All matching species:" << std::endl;
-		for (string_list::iterator it = matches.begin(); it != matches.end(); ++it) 
-		{
+		for (string_list::const_iterator it = matches.begin(); 
+		     it != matches.end(); ++it) {
 			std::cout << *it << std::endl;
 		}
 	}
@@ -162,7 +586,7 @@ void TreeCollection::tree_info(const std::string& partial_name) const {
 	std::cout << " ";
 	std::cout.width(12);
 	std::cout << total_in_ny;
-	std::cout << " (" << trees_by_borough_[ALLBOROS] << ")" << "	";
+	std::cout << " (" << trees_by_borough[ALLBOROS] << ")" << "	";
 	std::cout.width(15);
 	std::cout << std::setprecision(2) << percent_ny << "%" << std::endl;
 
@@ -170,7 +594,7 @@ void TreeCollection::tree_info(const std::string& partial_name) const {
 	std::cout << "	";
 	std::cout.width(10);
 	std::cout << total_in_man;
-	std::cout << " (" << trees_by_borough_[MANHATTAN] << ")" << "	";
+	std::cout << " (" << trees_by_borough[MANHATTAN] << ")" << "	";
 	std::cout.width(15);
 	std::cout << std::setprecision(2) << percent_man << "%" << std::endl;
 
@@ -178,7 +602,7 @@ void TreeCollection::tree_info(const std::string& partial_name) const {
 	std::cout << "	";
 	std::cout.width(18);
 	std::cout << total_in_bx;
-	std::cout << " (" << trees_by_borough_[BRONX] << ")" << "	";
+	std::cout << " (" << trees_by_borough[BRONX] << ")" << "	";
 	std::cout.width(15);
 	std::cout << std::setprecision(2) << percent_bx << "%" << std::endl;
 
@@ -186,7 +610,7 @@ void TreeCollection::tree_info(const std::string& partial_name) const {
 	std::cout << "	";
 	std::cout.width(10);
 	std::cout << total_in_bk;
-	std::cout << " (" << trees_by_borough_[BROOKLYN] << ")" << "	";
+	std::cout << " (" << trees_by_borough[BROOKLYN] << ")" << "	";
 	std::cout.width(15);
 	std::cout << std::setprecision(2) << percent_bk << "%" << std::endl;
 
@@ -194,7 +618,7 @@ void TreeCollection::tree_info(const std::string& partial_name) const {
 	std::cout << "	";
 	std::cout.width(18);
 	std::cout << total_in_q;
-	std::cout << " (" << trees_by_borough_[QUEENS] << ")" << "	";
+	std::cout << " (" << trees_by_borough[QUEENS] << ")" << "	";
 	std::cout.width(15);
 	std::cout << std::setprecision(2) << percent_q << "%" << std::endl;
 
@@ -202,109 +626,37 @@ void TreeCollection::tree_info(const std::string& partial_name) const {
 	std::cout << "	";
 	std::cout.width(10);
 	std::cout << total_in_stat;
-	std::cout << " (" << trees_by_borough_[STATEN] << ")" << "	";
+	std::cout << " (" << trees_by_borough[STATEN] << ")" << "	";
 	std::cout.width(15);
 	std::cout << std::setprecision(2) << percent_stat << "%" << std::endl;
 	std::cout << std::endl;
 }
 
-void TreeCollection::total_occurrences(const string_list& match_list,
-                                       double& ny_total, double& man_total, 
-                                       double& bx_total, double& bk_total, 
-                                       double& q_total, double& stat_total,
-                                       double& ny_percent, double& man_percent, 
-                                       double& bx_percent, double& bk_percent, 
-                                       double& q_percent, double& stat_percent)
-																			 const {
-	for (auto it1 = match_list.begin(); it1 != match_list.end(); 
-       ++it1) {
-		Tree tree(0, 0, "", "", *it1, 0, "", "", 0, 0);
-		std::list<Tree> tree_matches = trees_.findallmatches(tree);
-		ny_total += tree_matches.size();
-
-		for (std::list<Tree>::iterator it2 = tree_matches.begin(); 
-         it2 != tree_matches.end(); ++it2) {
-			Tree t(*it2);
-			Borough b = convert_to_tree_borough(t.borough_name());
-			switch (b) {
-				case MANHATTAN:
-					++man_total;
-					break;
-				case BRONX:
-					++bx_total;
-					break;
-				case BROOKLYN:
-					++bk_total;
-					break;
-				case QUEENS:
-					++q_total;
-					break;
-				case STATEN:
-					++stat_total;
-					break;
-				default:
-					break;
-			}
-		}
-	}
-
-	ny_percent = (ny_total / trees_by_borough_[ALLBOROS]) * 100;
-
-	if (0 != trees_by_borough_[MANHATTAN]) {
-		man_percent = (man_total / trees_by_borough_[MANHATTAN]) * 100;
-	}
-
-	if (0 != trees_by_borough_[BRONX]) {
-		bx_percent = (bx_total / trees_by_borough_[BRONX]) * 100;
-	}
-
-	if (0 != trees_by_borough_[BROOKLYN]) {
-		bk_percent = (bk_total / trees_by_borough_[BROOKLYN]) * 100;
-	}
-
-	if (0 != trees_by_borough_[QUEENS]) {
-		q_percent = (q_total / trees_by_borough_[QUEENS]) * 100;
-	}
-
-	if (0 != trees_by_borough_[STATEN]) {
-		stat_percent = (stat_total / trees_by_borough_[STATEN]) * 100;
-	}
-}
-
-void TreeCollection::list_all_names() const {
-	all_species_.print_all_species(std::cout);
-	std::cout << std::endl;
-}
-	
-void TreeCollection::list_all_in_zip(int& zipcode) const {
-	string_list matches = get_all_in_zipcode(zipcode);
-	if (matches.empty()) {
+void TreeCollection::print_zip_counts(int zipcode, const GroupBy& groups,
+                                      int slot, const std::map<std::string, 
+                                      int>& species_ids) {
+	PerfRegion region("output formatting");
+	if (slot < 0 || 0 == groups.slot_total(slot)) {
 		std::cout << "No trees found in zipcode: ";
 		std::cout << std::setfill('0') << std::setw(5) << zipcode << std::endl;
 		std::cout.copyfmt(std::ios(nullptr));	//	reset cout stream manipulators
 		std::cout << std::endl;
 		return;
 	}
-	std::vector<string_int_pair> zip_matches = count_duplicates(matches);
 
 	std::cout << "Trees found in zipcode ";
 	std::cout << std::setfill('0') << std::setw(5) << zipcode << ":" << std::endl;
-	for (unsigned int i = 0; i < zip_matches.size(); ++i) {
-		if (zip_matches[i].first == "") {
-			std::cout << "Unknown: ";
-		} else {
-			std::cout << zip_matches[i].first << ": ";
-		}
-		std::cout << zip_matches[i].second << std::endl;
-	}
+	print_species_counts(groups, slot, species_ids);
 	std::cout.copyfmt(std::ios(nullptr));
 	std::cout << std::endl;
 }
 
-void TreeCollection::list_all_near(double& latitude, double& longitude,
-                                   double& distance) const {
-	string_list matches = get_all_near(latitude, longitude, distance);
-	if (matches.empty()) {
+void TreeCollection::print_near_counts(double latitude, double longitude,
+                                       double distance, const GroupBy& nearby,
+                                       const std::map<std::string, int>& 
+                                       species_ids) {
+	PerfRegion region("output formatting");
+	if (0 == nearby.total()) {
 		std::cout << "No trees found within " << distance << " kilometers of ";
 		std::cout << std::setprecision(10) << latitude << " and ";
 		std::cout << std::setprecision(10) << longitude << std::endl;
@@ -312,20 +664,93 @@ void TreeCollection::list_all_near(double& latitude, double& longitude,
 		std::cout << std::endl;
 		return;
 	}
-	std::vector<string_int_pair> nearby = count_duplicates(matches);
 
 	std::cout << "Trees found within " << distance << " kilometers of ";
 	std::cout << std::setprecision(10) << latitude << " and ";
 	std::cout << std::setprecision(10) << longitude << ":" << std::endl;
-	for (unsigned int i = 0; i < nearby.size(); ++i) {
-		if (nearby[i].first == "") {
-			std::cout << "Unknown: ";
+	print_species_counts(nearby, -1, species_ids);
+	std::cout.copyfmt(std::ios(nullptr));
+	std::cout << std::endl;
+}
+
+void TreeCollection::print_corridor_counts(const Corridor& corridor,
+                                           const GroupBy& found,
+                                           const std::map<std::string, int>& 
+                                           species_ids) {
+	PerfRegion region("output formatting");
+	if (0 == found.total()) {
+		std::cout << "No trees found";
+	} else {
+		std::cout << "Trees found";
+	}
+	std::cout << " within " << corridor.distance() << " kilometers of the path";
+	std::cout << " through";
+	const std::vector<CorridorPoint>& points = corridor.points();
+	for (unsigned int i = 0; i < points.size(); ++i) {
+		std::cout << (0 == i ? " " : ", ");
+		std::cout << std::setprecision(10) << points[i].latitude << " and ";
+		std::cout << std::setprecision(10) << points[i].longitude;
+	}
+	if (0 == found.total()) {
+		std::cout << std::endl;
+		std::cout.copyfmt(std::ios(nullptr));
+		std::cout << std::endl;
+		return;
+	}
+	std::cout << ":" << std::endl;
+	std::cout.copyfmt(std::ios(nullptr));
+	print_species_counts(found, -1, species_ids);
+	std::cout << std::endl;
+}
+
+void TreeCollection::print_rollup(const GroupBy& groups,
+                                  const std::map<std::string, int>& 
+                                  species_ids) {
+	PerfRegion region("output formatting");
+	std::cout << "Trees grouped by species";
+	switch (groups.key()) {
+		case BY_ZIP:
+			std::cout << " and zipcode";
+			break;
+		case BY_BOROUGH:
+			std::cout << " and borough";
+			break;
+		case BY_HEALTH:
+			std::cout << " and health";
+			break;
+		case BY_DIAMETER:
+			std::cout << " and diameter";
+			break;
+		default:
+			break;
+	}
+	std::cout << ":" << std::endl;
+
+	if (BY_SPECIES == groups.key()) {
+		print_species_counts(groups, -1, species_ids);
+		std::cout << std::endl;
+		return;
+	}
+
+	std::vector<int> slots = groups.sorted_slots();
+	for (auto it = species_ids.begin(); it != species_ids.end(); ++it) {
+		if (0 == groups.species_total(it->second)) {
+			continue;
+		}
+		if (it->first == "") {
+			std::cout << "Unknown:" << std::endl;
 		} else {
-			std::cout << nearby[i].first << ": ";
+			std::cout << it->first << ":" << std::endl;
+		}
+		for (unsigned int i = 0; i < slots.size(); ++i) {
+			int count = groups.count(it->second, slots[i]);
+			if (0 != count) {
+				std::cout << "	";
+				print_slot(groups, slots[i]);
+				std::cout << ": " << count << std::endl;
+			}
 		}
-		std::cout << nearby[i].second << std::endl;
 	}
-	std::cout.copyfmt(std::ios(nullptr));
 	std::cout << std::endl;
 }
 
@@ -348,3 +773,148 @@ std::vector<string_int_pair> TreeCollection::count_duplicates(
 	}
 	return match_info;
 }
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+void TreeCollection::print_species_counts(const GroupBy& groups, int slot,
+                                          const std::map<std::string, int>& 
+                                          species_ids) {
+	for (auto it = species_ids.begin(); it != species_ids.end(); ++it) {
+		int count = (slot < 0) ? groups.species_total(it->second) :
+								groups.count(it->second, slot);
+		if (0 == count) {
+			continue;
+		}
+		if (it->first == "") {
+			std::cout << "Unknown: ";
+		} else {
+			std::cout << it->first << ": ";
+		}
+		std::cout << count << std::endl;
+	}
+}
+
+void TreeCollection::print_slot(const GroupBy& groups, int slot) {
+	int value = groups.slot_value(slot);
+	switch (groups.key()) {
+		case BY_ZIP:
+			std::cout << std::setfill('0') << std::setw(5) << value;
+			std::cout << std::setfill(' ');
+			break;
+		case BY_BOROUGH: {
+			const char* boroughs[] = {"Unknown", "Manhattan", "Bronx", "Brooklyn",
+																"Queens", "Staten Island"};
+			std::cout << boroughs[value];
+			break;
+		}
+		case BY_HEALTH: {
+			const char* health[] = {"Unknown", "Good", "Fair", "Poor"};
+			std::cout << health[value];
+			break;
+		}
+		case BY_DIAMETER:
+			if (slot == groups.number_of_slots() - 1) {
+				std::cout << value << "+ in";
+			} else {
+				std::cout << value << "-" << value + kDiameterBucket - 1 << " in";
+			}
+			break;
+		default:
+			break;
+	}
+}
+
+int TreeCollection::add_species_id(const std::string& species_name) {
+	std::map<std::string, int>::iterator it = species_ids_.find(species_name);
+	if (it != species_ids_.end()) {
+		return it->second;
+	}
+	int id = species_names_.size();
+	species_ids_[species_name] = id;
+	species_names_.push_back(species_name);
+	species_by_borough_.resize(number_of_species());
+	species_by_zip_.resize(number_of_species());
+	return id;
+}
+
+int TreeCollection::matching_species_id(const std::string& species_name) const
+{
+	return matching_species_id(species_name, species_ids_);
+}
+
+int TreeCollection::matching_species_id(const std::string& species_name,
+                                        const std::map<std::string, int>& 
+                                        species_ids) {
+	std::string spc = species_name;
+	for (char& c : spc) {
+		if (isupper(c)) {
+			c = tolower(c);
+		}
+	}
+	std::map<std::string, int>::const_iterator it = species_ids.find(spc);
+	if (it == species_ids.end() && !spc.empty()) {
+		//	the same change as AVL_Tree::change_case
+		if (islower(spc[0])) {
+			spc[0] = toupper(spc[0]);
+		} else if (ispunct(spc[0]) && 1 < spc.size()) {
+			spc[1] = toupper(spc[1]);
+		}
+		it = species_ids.find(spc);
+	}
+	if (it == species_ids.end()) {
+		return -1;
+	}
+	return it->second;
+}
+
+TreeSpecies TreeCollection::species_with_trees(const std::map<std::string, 
+                                               int>& species_ids,
+                                               const std::vector<int>& 
+                                               species_totals) {
+	TreeSpecies species;
+	for (auto it = species_ids.begin(); it != species_ids.end(); ++it) {
+		if (0 < species_totals[it->second]) {
+			species.add_species(it->first);
+		}
+	}
+	return species;
+}
+
+int TreeCollection::diff_views(const GroupBy& maintained,
+                               const GroupBy& recomputed,
+                               const std::map<std::string, int>& species_ids) {
+	int mismatches = 0;
+	std::vector<int> slots = recomputed.sorted_slots();
+	for (auto it = species_ids.begin(); it != species_ids.end(); ++it) {
+		for (unsigned int i = 0; i < slots.size(); ++i) {
+			int value = recomputed.slot_value(slots[i]);
+			int expected = recomputed.count(it->second, slots[i]);
+			int slot = maintained.slot_of(value);
+			int actual = (slot < 0) ? 0 : maintained.count(it->second, slot);
+			if (expected != actual) {
+				std::cout << "	" << (it->first == "" ? "Unknown" : it->first);
+				std::cout << ", ";
+				print_slot(recomputed, slots[i]);
+				std::cout << ": maintained " << actual << ", recomputed " << expected;
+				std::cout << std::endl;
+				++mismatches;
+			}
+		}
+		//	a key value that only the maintained view has should have no Trees
+		for (int slot = 0; slot < maintained.number_of_slots(); ++slot) {
+			int actual = maintained.count(it->second, slot);
+			if (recomputed.slot_of(maintained.slot_value(slot)) < 0 && 0 != actual) {
+				std::cout << "	" << (it->first == "" ? "Unknown" : it->first);
+				std::cout << ", ";
+				print_slot(maintained, slot);
+				std::cout << ": maintained " << actual << ", recomputed 0" << std::endl;
+				++mismatches;
+			}
+		}
+	}
+	return mismatches;
+}
@@ -18,16 +18,28 @@
 #define __TREECOLLECTION_H__
 
 #include "avl.h"
+#include "census_file.h"
+#include "tree_index.h"
 #include "tree_species.h"
 #include "tree.h"
+#include "group_by.h"
+#include "ingest_profile.h"
+#include "memory_stats.h"
+#include "street_dictionary.h"
+#include "work_stealing.h"
 #include <utility>
 #include <array>
+#include <istream>
+#include <map>
+#include <memory>
+#include <vector>
 
 /*******************************************************************************
 
 		The TreeCollection class acts as database for the 2015 NYC Street Tree 
-		Census. It encapsulates an AVL Tree, a TreeSpecies object, and an array that
-		stores integers. The AVL Tree stores all the Tree objects. The TreeSpecies 
+		Census. It encapsulates a TreeIndex, which is an AVL Tree unless another 
+		IndexBackend is chosen, a TreeSpecies object, and an array that stores 
+		integers. The TreeIndex stores all the Tree objects. The TreeSpecies 
 		object stores the common names of all the Tree species, which is the 
 		spc_common member of each Tree object, and is responsible for determining 
 		if a given string matches any of the species names it stores. The array 
@@ -49,22 +61,17 @@
 
 *******************************************************************************/
 
+//	The number of rows in each span of TreeCollection::load in a trace
+const int kTraceChunkRows = 16384;
+
 typedef std::list<std::string> string_list;
 typedef std::pair<std::string, int> string_int_pair;
 
-enum Borough {
-		ALLBOROS = 0,
-		MANHATTAN,
-		BRONX,
-		BROOKLYN,
-		QUEENS,
-		STATEN
-	};
-
 class TreeCollection {
  public:
-	//	Default constructor for TreeCollection object
-	TreeCollection();
+	//	Creates an empty TreeCollection object that stores its Trees in the 
+	//	given kind of TreeIndex, which is an AVL_Tree by default
+	explicit TreeCollection(IndexBackend backend = AVL_BACKEND);
 
 	//	Destructor for TreeCollection object
 	~TreeCollection();
@@ -99,12 +106,72 @@ class TreeCollection {
 	string_list get_all_near(double latitude, double longitude, double distance)
 											     const;
 
+	//	Returns the species id that was given to species_name when the first 
+	//	Tree with that spc_common was inserted. Returns -1 if no Tree has 
+	//	species_name for an spc_common. This method is case sensitive
+	int species_id(const std::string& species_name) const;
+
+	//	Returns the number of distinct spc_common members in the collection
+	int number_of_species() const;
+
 	//	Returns true if TreeCollection object contains no Trees
 	bool empty() const;
 
-	//	Adds the given tree to the TreeCollection object's AVL_Tree
+	//	Makes the queries that visit every Tree split the AVL_Tree into pieces 
+	//	that pool does in parallel. If pool is null, which is the default, 
+	//	they run on the calling thread. pool must outlive the TreeCollection
+	void set_traversal_pool(WorkStealingPool* pool);
+
+	//	Adds the given tree to the TreeCollection object's AVL_Tree and counts it
+	//	in the materialized views. The StreetDictionary that holds the street 
+	//	of tree's address must outlive the TreeCollection object
 	void insert_tree(const Tree& tree);
 
+	//	Inserts a Tree for each line of tree_file, which is in the format of the
+	//	2015 NYC Tree Census, until the end of the file. A last line that does 
+	//	not end with a newline is ignored. Then freezes the AVL_Tree, so its 
+	//	searches use the FrozenIndex until a Tree is removed. Returns the number
+	//	of Trees inserted
+	int load(std::istream& tree_file);
+
+	//	Does what load(std::istream&) does with the records of census, but the
+	//	Trees only parse their status and address from their records when they
+	//	are needed. The TreeCollection keeps census until it is destroyed
+	int load(std::shared_ptr<const CensusFile> census);
+
+	//	Calls TreeIndex::set_hilbert_order(on) on the TreeIndex, so that once 
+	//	it is frozen the nearby and zipcode searches only read the blocks of 
+	//	Trees that may match
+	void set_hilbert_order(bool on);
+
+	//	Times the phases of the next calls to load and insert_tree if on is 
+	//	true, and stops timing them otherwise
+	void profile_ingest(bool on);
+
+	//	Returns the times of the phases of load and insert_tree since 
+	//	profile_ingest(true) was called
+	const IngestProfile& ingest_profile() const;
+
+	//	Outputs the time each phase of loading took, with rows per second, and 
+	//	the rotations, insert depths and height of the TreeIndex
+	void write_ingest_report(std::ostream& out) const;
+
+	//	Adds the memory used by trees_, the species ids and names, the 
+	//	TreeSpecies, the materialized views and the StreetDictionary to report
+	void add_memory_usage(MemoryReport& report) const;
+
+	//	Outputs a table of the memory add_memory_usage finds
+	void write_memory_report(std::ostream& out) const;
+
+	//	Removes the stored Tree that is equal to tree (same spc_common and 
+	//	tree_id) from the AVL_Tree and takes it out of the materialized views
+	//	Returns false if no such Tree is stored
+	bool remove_tree(const Tree& tree);
+
+	//	Removes the Tree whose tree_id is tree_id, found with the AVL_Tree's 
+	//	tree_id index. Returns false if no such Tree is stored
+	bool remove_tree_by_id(int tree_id);
+
 	//	Returns the corresponding Borough value for the given boro
 	//	This method is only to be used on trees within the TreeCollection since 
 	//	those trees are in one of the five boroughs in New York
@@ -121,11 +188,11 @@ class TreeCollection {
 	void tree_info(const std::string& partial_name) const;
 
 	//	Goes through match_list (which contains a list of Tree spc_common members)
-	//	and for each spc_common, this method gets a list of Trees that have the 
-	//	same spc_common member. This method then goes through that list of trees 
-	//	and calculates the number of these Trees in New York and in each brorough
-	//	Once it's gone through all of match_list, it calculates the percentage of 
-	//	all the Tree species in match_list in New York and in each borough
+	//	and for each spc_common, this method looks up the number of Trees with 
+	//	that spc_common in New York and in each borough in the species by 
+	//	borough view. Once it's gone through all of match_list, it calculates the
+	//	percentage of all the Tree species in match_list in New York and in each
+	//	borough
 	void total_occurrences(const string_list& match_list, double& ny_total, 
                          double& man_total, double& bx_total, double& bk_total, 
                          double& q_total, double& stat_total, double& ny_percent,
@@ -146,6 +213,36 @@ class TreeCollection {
 	//	coordinates
 	void list_all_near(double& latitude, double& longitude, double& distance) 
 										 const;
+
+	//	Outputs what list_all_near outputs for each of queries, in order, but 
+	//	finds the Trees of all of them in one pass over the TreeIndex
+	void list_all_near_batch(const std::vector<NearbyQuery>& queries) const;
+
+	//	Outputs the spc_common member of the Trees within corridor's distance 
+	//	of its path and how many of them there are, like list_all_near. A Tree
+	//	near more than one segment of the path is only counted once
+	void list_in_corridor(const Corridor& corridor) const;
+
+	//	Outputs how many Trees of each species are in the TreeCollection object,
+	//	split up by key unless key is BY_SPECIES
+	void rollup(GroupKey key) const;
+
+	//	Outputs the Tree whose tree_id is tree_id
+	void lookup(int tree_id) const;
+
+	//	Removes the Tree whose tree_id is tree_id and outputs whether it was 
+	//	found
+	void remove(int tree_id);
+
+	//	Outputs the Trees whose positions in the AVL_Tree, counting from 0, are 
+	//	from first up to but not including last
+	void print_trees(int first, int last) const;
+
+	//	Recomputes every materialized view from the AVL_Tree and outputs 
+	//	whether it matches the view that insert_tree and remove_tree maintain
+	//	Every count that does not match is output
+	//	Returns true if all the views match
+	bool verify() const;
 	
 	//	Goes through matches (which contains duplicates of various spc_common 
 	//	names) and counts how many times each spc_common appears in matches 
@@ -155,10 +252,93 @@ class TreeCollection {
 	std::vector<string_int_pair> count_duplicates(const string_list& matches)
 																								const;
 
+	//	Outputs the second part of tree_info: the matching species, followed by
+	//	totals (the number of matching Trees in NYC and in each borough, indexed
+	//	by Borough) out of trees_by_borough and the percentages they make up
+	static void print_frequencies(const std::string& partial_name,
+	                              const string_list& matches,
+	                              const std::array<double, 6>& totals,
+	                              const std::array<int, 6>& trees_by_borough);
+
+	//	Outputs what list_all_in_zip outputs for the counts in slot of groups
+	//	If slot is -1 or has no Trees, outputs that no trees were found
+	static void print_zip_counts(int zipcode, const GroupBy& groups, int slot,
+	                             const std::map<std::string, int>& species_ids);
+
+	//	Outputs what list_all_near outputs for the counts in nearby
+	static void print_near_counts(double latitude, double longitude,
+	                              double distance, const GroupBy& nearby,
+	                              const std::map<std::string, int>& species_ids);
+
+	//	Outputs what list_in_corridor outputs for the counts in found
+	static void print_corridor_counts(const Corridor& corridor, 
+	                                  const GroupBy& found,
+	                                  const std::map<std::string, int>& 
+	                                  species_ids);
+
+	//	Outputs what rollup outputs for the counts in groups
+	static void print_rollup(const GroupBy& groups,
+	                         const std::map<std::string, int>& species_ids);
+
+	//	Outputs what verify outputs when the maintained views species_by_borough
+	//	and species_by_zip are compared with by_borough and by_zip, which were 
+	//	recomputed from the Trees, and the rows counted in trees_by_borough are
+	//	compared with the Trees of each borough in by_borough and the rejected
+	//	duplicates in duplicates_by_borough. Returns true if they all match
+	static bool verify_views(const GroupBy& species_by_borough,
+	                         const GroupBy& by_borough,
+	                         const GroupBy& species_by_zip, const GroupBy& by_zip,
+	                         const std::array<int, 6>& trees_by_borough,
+	                         const std::array<int, 6>& duplicates_by_borough,
+	                         const std::map<std::string, int>& species_ids);
+
+	//	Returns the species id in species_ids of the species that the AVL_Tree 
+	//	would find for species_name, which is species_name in lowercase or, if 
+	//	there is no such species, species_name with its first letter capitalized
+	//	Returns -1 if neither exists
+	static int matching_species_id(const std::string& species_name,
+	                               const std::map<std::string, int>& 
+	                               species_ids);
+
+	//	Returns a TreeSpecies of the names in species_ids whose species still 
+	//	has Trees, where species_totals holds the number of stored Trees of 
+	//	each species id. TreeSpecies cannot take a name out, so it is used to 
+	//	list the names again once the last Tree of a species is removed
+	static TreeSpecies species_with_trees(const std::map<std::string, int>& 
+	                                      species_ids,
+	                                      const std::vector<int>& species_totals);
+
+ protected:
+	//	Outputs the spc_common and count of every species in species_ids that 
+	//	has Trees in slot of groups, in the same order as the AVL_Tree stores the
+	//	species. If slot is -1, the counts of all slots are added together
+	static void print_species_counts(const GroupBy& groups, int slot,
+	                                 const std::map<std::string, int>& 
+	                                 species_ids);
+
+	//	Returns matching_species_id(species_name, species_ids_)
+	int matching_species_id(const std::string& species_name) const;
+
+	//	Outputs every species and key value whose count in maintained is not 
+	//	the same as in recomputed. Returns the number of counts output
+	static int diff_views(const GroupBy& maintained, const GroupBy& recomputed,
+	                      const std::map<std::string, int>& species_ids);
+
+	//	Outputs the key value of slot in groups in a readable form
+	static void print_slot(const GroupBy& groups, int slot);
+
+	//	Returns the species id of species_name, giving it a new one if it does
+	//	not have one yet and making room for it in the materialized views
+	int add_species_id(const std::string& species_name);
+
  private:
 	//	Stores all the Tree objects and uses a Tree's spc_common as the primary 
 	//	key and its tree_id as the secondary key to order the Tree objects
-	AVL_Tree trees_;
+	//	It is an AVL_Tree unless another IndexBackend was given
+	std::unique_ptr<TreeIndex> trees_;
+
+	//	The kind of TreeIndex that trees_ is
+	IndexBackend backend_;
 
 	//	Stores a list of the spc_common members of all the Trees found in trees_
 	TreeSpecies all_species_;
@@ -170,6 +350,49 @@ class TreeCollection {
 	//	total number of Trees in Queens. This way you don’t have to remember which
 	//	number in the array represents which borough
 	std::array<int, 6> trees_by_borough_;
+
+	//	The number of rows counted in trees_by_borough_ whose Tree was not 
+	//	stored because trees_ already had one with the same spc_common and 
+	//	tree_id. tree_info divides by every row of the census, as it always has,
+	//	so duplicates stay in trees_by_borough_ and are counted here for verify
+	std::array<int, 6> duplicates_by_borough_;
+
+	//	Maps each spc_common member to its species id. Since the map is ordered,
+	//	going through it visits the species in the same order as trees_ does
+	std::map<std::string, int> species_ids_;
+
+	//	The spc_common member of each species id
+	std::vector<std::string> species_names_;
+
+	//	Materialized view of the number of Trees of each species in each 
+	//	borough. It is updated by insert_tree and remove_tree, so tree_info 
+	//	only has to look up counts. Unlike trees_by_borough_, which counts every
+	//	Tree given to insert_tree, it only counts Trees stored in trees_
+	GroupBy species_by_borough_;
+
+	//	Materialized view of the number of Trees of each species in each 
+	//	zipcode, used by list_all_in_zip
+	GroupBy species_by_zip_;
+
+	//	Does the traversals of trees_ in parallel, if it is not null
+	WorkStealingPool* traversal_pool_;
+
+	//	The time spent in each phase of loading, if profile_ingest(true) was 
+	//	called
+	IngestProfile ingest_profile_;
+
+	//	The bytes all_species_ holds, counted by the AllocationCounter while it
+	//	adds species. It stays 0 if the AllocationCounter is not enabled
+	long long species_allocated_bytes_;
+
+	//	The census file the Trees parse their other fields from, if it was 
+	//	loaded with load(std::shared_ptr<const CensusFile>)
+	std::shared_ptr<const CensusFile> census_;
+
+	//	The streets of the addresses of the Trees. It is only added to while 
+	//	loading, by the loading thread, and is destroyed with the Trees, so a
+	//	reload starts a new one
+	StreetDictionary streets_;
 };
 
 #endif
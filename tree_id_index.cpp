@@ -0,0 +1,150 @@
+/*******************************************************************************
+  Title          : tree_id_index.cpp
+  Description    : The implementation file for the TreeIdIndex class
+  Purpose        : To find the BinaryNode that stores a Tree using only the 
+                   Tree's tree_id
+  Usage          : Used by AVL_Tree as a secondary index on tree_id
+  Build with     : g++ -c -std=c++11 tree_id_index.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "tree_id_index.h"
+
+const int kEmpty = -1;
+const int kDeleted = -2;
+const int kInitialBits = 4;
+
+TreeIdIndex::TreeIdIndex() {
+	size_ = 0;
+	used_ = 0;
+	bits_ = kInitialBits;
+	ids_.assign(1 << bits_, kEmpty);
+	nodes_.assign(1 << bits_, nullptr);
+}
+
+TreeIdIndex::~TreeIdIndex() {
+}
+
+int TreeIdIndex::size() const {
+	return size_;
+}
+
+BinaryNode<Tree>* TreeIdIndex::find(int tree_id) const {
+	int slot = find_slot(tree_id);
+	if (slot < 0) {
+		return nullptr;
+	}
+	return nodes_[slot];
+}
+
+void TreeIdIndex::insert(int tree_id, BinaryNode<Tree>* node) {
+	if (tree_id < 0) {
+		return;
+	}
+	int slot = find_slot(tree_id);
+	if (0 <= slot) {
+		nodes_[slot] = node;
+		return;
+	}
+	//	keep at most 70% of the slots in use so probe sequences stay short
+	if (10 * (used_ + 1) > 7 * static_cast<int>(ids_.size())) {
+		//	only grow if the table is full of tree_ids and not of deleted marks
+		if (10 * (size_ + 1) > 7 * static_cast<int>(ids_.size()) / 2) {
+			rehash(ids_.size() * 2);
+		} else {
+			rehash(ids_.size());
+		}
+	}
+	unsigned int mask = ids_.size() - 1;
+	unsigned int i = home_slot(tree_id);
+	while (0 <= ids_[i]) {
+		i = (i + 1) & mask;
+	}
+	if (kEmpty == ids_[i]) {
+		++used_;
+	}
+	ids_[i] = tree_id;
+	nodes_[i] = node;
+	++size_;
+}
+
+bool TreeIdIndex::erase(int tree_id) {
+	int slot = find_slot(tree_id);
+	if (slot < 0) {
+		return false;
+	}
+	ids_[slot] = kDeleted;
+	nodes_[slot] = nullptr;
+	--size_;
+	return true;
+}
+
+void TreeIdIndex::clear() {
+	size_ = 0;
+	used_ = 0;
+	bits_ = kInitialBits;
+	ids_.assign(1 << bits_, kEmpty);
+	nodes_.assign(1 << bits_, nullptr);
+}
+
+MemoryUsage TreeIdIndex::memory_usage() const {
+	MemoryUsage usage = vector_usage(ids_);
+	usage += vector_usage(nodes_);
+	return usage;
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+//	Fibonacci hashing: the top bits of the product spread out tree_ids that 
+//	are close together
+unsigned int TreeIdIndex::home_slot(int tree_id) const {
+	return (static_cast<unsigned int>(tree_id) * 2654435769u) >> (32 - bits_);
+}
+
+int TreeIdIndex::find_slot(int tree_id) const {
+	if (tree_id < 0) {
+		return -1;
+	}
+	unsigned int mask = ids_.size() - 1;
+	unsigned int i = home_slot(tree_id);
+	while (kEmpty != ids_[i]) {
+		if (tree_id == ids_[i]) {
+			return i;
+		}
+		i = (i + 1) & mask;
+	}
+	return -1;
+}
+
+void TreeIdIndex::rehash(unsigned int number_of_slots) {
+	std::vector<int> old_ids;
+	std::vector<BinaryNode<Tree>*> old_nodes;
+	old_ids.swap(ids_);
+	old_nodes.swap(nodes_);
+	bits_ = 0;
+	while ((1u << bits_) < number_of_slots) {
+		++bits_;
+	}
+	ids_.assign(1 << bits_, kEmpty);
+	nodes_.assign(1 << bits_, nullptr);
+	size_ = 0;
+	used_ = 0;
+	unsigned int mask = ids_.size() - 1;
+	for (unsigned int j = 0; j < old_ids.size(); ++j) {
+		if (0 <= old_ids[j]) {
+			unsigned int i = home_slot(old_ids[j]);
+			while (kEmpty != ids_[i]) {
+				i = (i + 1) & mask;
+			}
+			ids_[i] = old_ids[j];
+			nodes_[i] = old_nodes[j];
+			++size_;
+			++used_;
+		}
+	}
+}
@@ -0,0 +1,89 @@
+/*******************************************************************************
+  Title          : tree_id_index.h
+  Description    : The interface file for the TreeIdIndex class
+  Purpose        : To find the BinaryNode that stores a Tree using only the 
+                   Tree's tree_id
+  Usage          : Used by AVL_Tree as a secondary index on tree_id
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __TREE_ID_INDEX_H__
+#define __TREE_ID_INDEX_H__
+
+#include "BinaryNode.cpp"
+#include "memory_stats.h"
+#include "tree.h"
+#include <vector>
+
+/*******************************************************************************
+
+		The TreeIdIndex class is a hash table that maps the tree_id of a Tree to 
+		the BinaryNode that stores it. It uses open addressing with linear probing
+		so a lookup usually reads a single slot of one array instead of following 
+		pointers. The number of slots is always a power of 2 so the slot of a 
+		tree_id is found with a multiply and a shift. A removed entry is marked as 
+		deleted instead of emptied so the entries after it can still be found. The
+		table doubles in size when more than 70% of its slots are in use or 
+		deleted. tree_ids are non-negative, so negative values are used to mark 
+		empty and deleted slots and negative tree_ids cannot be stored
+
+*******************************************************************************/
+
+class TreeIdIndex {
+ public:
+	//	Creates an empty TreeIdIndex object
+	TreeIdIndex();
+
+	//	Destroys TreeIdIndex object. The BinaryNodes are not deleted
+	~TreeIdIndex();
+
+	//	Returns the number of tree_ids stored
+	int size() const;
+
+	//	Returns the BinaryNode stored for tree_id, or nullptr if there is none
+	BinaryNode<Tree>* find(int tree_id) const;
+
+	//	Stores node for tree_id, replacing the BinaryNode already stored for it
+	void insert(int tree_id, BinaryNode<Tree>* node);
+
+	//	Removes tree_id. Returns false if tree_id was not stored
+	bool erase(int tree_id);
+
+	//	Removes every tree_id
+	void clear();
+
+	//	Returns the memory used by the table, not counting the BinaryNodes
+	MemoryUsage memory_usage() const;
+
+ protected:
+	//	Returns the first slot to look in for tree_id
+	unsigned int home_slot(int tree_id) const;
+
+	//	Returns the slot that holds tree_id, or -1 if tree_id is not stored
+	int find_slot(int tree_id) const;
+
+	//	Makes a table with number_of_slots slots and puts every stored tree_id 
+	//	into it
+	void rehash(unsigned int number_of_slots);
+
+ private:
+	//	The tree_id stored in each slot, or kEmpty or kDeleted
+	std::vector<int> ids_;
+
+	//	The BinaryNode stored in each slot
+	std::vector<BinaryNode<Tree>*> nodes_;
+
+	//	The number of slots holding a tree_id
+	int size_;
+
+	//	The number of slots holding a tree_id or marked as deleted
+	int used_;
+
+	//	The number of bits in a slot number, so there are 2^bits_ slots
+	int bits_;
+};
+
+#endif
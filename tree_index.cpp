@@ -0,0 +1,65 @@
+/*******************************************************************************
+  Title          : tree_index.cpp
+  Description    : The implementation file for the TreeIndex class
+  Purpose        : To let TreeCollection store its Trees in any of several 
+                   data structures that answer the same queries
+  Usage          : Make a TreeIndex with make_tree_index() and use it through 
+                   a TreeIndex pointer
+  Build with     : g++ -c -std=c++11 tree_index.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "tree_index.h"
+#include "avl.h"
+#include "bplus_tree.h"
+
+TreeIndex::~TreeIndex() {
+}
+
+std::list<std::string> TreeIndex::all_in_zipcode(const int& zip,
+                                                 WorkStealingPool& pool,
+                                                 int grain) const {
+	return all_in_zipcode(zip);
+}
+
+std::list<std::string> TreeIndex::all_nearby(const double& latitude,
+                                             const double& longitude,
+                                             const double& distance,
+                                             WorkStealingPool& pool,
+                                             int grain) const {
+	return all_nearby(latitude, longitude, distance);
+}
+
+void TreeIndex::group_nearby(const double& latitude, const double& longitude,
+                             const double& distance, GroupBy& groups,
+                             WorkStealingPool& pool, int grain) const {
+	group_nearby(latitude, longitude, distance, groups);
+}
+
+void TreeIndex::freeze() {
+}
+
+void TreeIndex::set_hilbert_order(bool on) {
+}
+
+RebalanceCounters TreeIndex::rebalance_counters() const {
+	return RebalanceCounters();
+}
+
+void TreeIndex::add_memory_usage(MemoryReport& report) const {
+}
+
+TreeIndex* make_tree_index(IndexBackend backend) {
+	if (BPLUS_BACKEND == backend) {
+		return new BPlusTree();
+	}
+	return new AVL_Tree();
+}
+
+const char* backend_name(IndexBackend backend) {
+	if (BPLUS_BACKEND == backend) {
+		return "BPlusTree";
+	}
+	return "AVL_Tree";
+}
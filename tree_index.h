@@ -0,0 +1,224 @@
+/*******************************************************************************
+  Title          : tree_index.h
+  Description    : The interface file for the TreeIndex class
+  Purpose        : To let TreeCollection store its Trees in any of several 
+                   data structures that answer the same queries
+  Usage          : Make a TreeIndex with make_tree_index() and use it through 
+                   a TreeIndex pointer
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __TREE_INDEX_H__
+#define __TREE_INDEX_H__
+
+#include "tree.h"
+#include "coordinate_columns.h"
+#include "corridor.h"
+#include "nearby_batch.h"
+#include "group_by.h"
+#include "memory_stats.h"
+#include "work_counters.h"
+#include "work_stealing.h"
+#include <functional>
+#include <list>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//	The largest number of Tree objects in a piece of a parallel traversal
+const int kTraversalGrain = 2048;
+
+//	The function that for_each_in_box calls with each Tree it reads
+typedef std::function<void(const Tree&)> TreeVisitor;
+
+//	The data structures that can store the Trees of a TreeCollection
+enum IndexBackend {AVL_BACKEND, BPLUS_BACKEND};
+
+//	The number of values of IndexBackend
+const int kNumberOfBackends = 2;
+
+//	Counts of the work a TreeIndex did to stay balanced while Trees were 
+//	inserted and removed. insert_depths[d] is the number of Trees that were 
+//	inserted d levels below the root
+struct RebalanceCounters {
+	long long ll_rotations;
+	long long lr_rotations;
+	long long rr_rotations;
+	long long rl_rotations;
+	std::vector<long long> insert_depths;
+
+	RebalanceCounters() 
+	    : ll_rotations(0), lr_rotations(0), rr_rotations(0), rl_rotations(0) {
+	}
+};
+
+/*******************************************************************************
+
+		The TreeIndex class is the interface of the data structures that store 
+		the Tree objects of a TreeCollection, ordered by spc_common and then by 
+		tree_id. It has the operations that TreeCollection uses: inserting and 
+		removing Trees, looking a Tree up by its key or its tree_id, finding the 
+		Trees of a species and counting them, the zipcode and nearby queries, 
+		grouping, and printing a range of ranks. AVL_Tree and BPlusTree are the 
+		two implementations, and make_tree_index makes either one, so the same 
+		TreeCollection can be run on both and their outputs compared. The 
+		parallel versions of the traversals run on the calling thread unless an 
+		implementation can split its work between the workers of a pool
+
+*******************************************************************************/
+
+class TreeIndex {
+ public:
+	//	Destroys the TreeIndex object and every Tree stored in it
+	virtual ~TreeIndex();
+
+	//	Returns true if no Tree objects are stored
+	virtual bool empty() const = 0;
+
+	//	Returns the number of Tree objects stored
+	virtual int get_number_of_trees() const = 0;
+
+	//	Returns the height of the TreeIndex
+	virtual int height() const = 0;
+
+	//	Returns the stored Tree object that is equal to x, or the Tree object 
+	//	stored in kNotFound if there is none
+	virtual const Tree& find(const Tree& x) const = 0;
+
+	//	Returns the Tree object whose tree_id is tree_id, or the Tree object 
+	//	stored in kNotFound if there is none
+	virtual const Tree& find_by_id(int tree_id) const = 0;
+
+	//	Returns a list of the Tree objects whose spc_common member is equal to 
+	//	x's, using the case rules of AVL_Tree::findallmatches
+	virtual std::list<Tree> findallmatches(const Tree& x) const = 0;
+
+	//	Returns the number of Tree objects whose spc_common member equals 
+	//	name_of_species, using the case rules of AVL_Tree::count_species
+	virtual int count_species(const std::string& name_of_species) const = 0;
+
+	//	Returns the spc_common members of the Tree objects in the given zipcode,
+	//	in order. The returned list will contain duplicates
+	virtual std::list<std::string> all_in_zipcode(const int& zip) const = 0;
+
+	//	Returns the spc_common members of the Tree objects within the given 
+	//	distance of the given coordinates in kilometers, in order
+	virtual std::list<std::string> all_nearby(const double& latitude,
+	                                          const double& longitude,
+	                                          const double& distance) const = 0;
+
+	//	Counts every Tree object in groups
+	virtual void group_all(GroupBy& groups) const = 0;
+
+	//	Counts the Tree objects within the given distance of the given 
+	//	coordinates in groups
+	virtual void group_nearby(const double& latitude, const double& longitude,
+	                          const double& distance, GroupBy& groups) const = 0;
+
+	//	Calls visit once with each Tree object that may be inside one of boxes.
+	//	Every Tree inside one is visited, but others may be too, so visit 
+	//	checks each Tree itself. Returns the number of Tree objects read
+	virtual long long for_each_in_box(const std::vector<CoordinateBox>& boxes,
+	                                  const TreeVisitor& visit) const = 0;
+
+	//	The same queries using the workers of pool. The results are the same as
+	//	the ones above. By default they are the ones above and ignore pool
+	virtual std::list<std::string> all_in_zipcode(const int& zip,
+	                                              WorkStealingPool& pool,
+	                                              int grain = kTraversalGrain)
+	                                              const;
+	virtual std::list<std::string> all_nearby(const double& latitude,
+	                                          const double& longitude,
+	                                          const double& distance,
+	                                          WorkStealingPool& pool,
+	                                          int grain = kTraversalGrain) const;
+	virtual void group_nearby(const double& latitude, const double& longitude,
+	                          const double& distance, GroupBy& groups,
+	                          WorkStealingPool& pool,
+	                          int grain = kTraversalGrain) const;
+
+	//	Prints the Tree objects whose ranks are from first up to but not 
+	//	including last
+	virtual void print(std::ostream& out, int first, int last) const = 0;
+
+	//	Adds the Tree object x. Returns false if a Tree object equal to x was 
+	//	already stored
+	virtual bool insert(const Tree& x) = 0;
+
+	//	Removes the Tree object x. Returns false if no Tree object equal to x 
+	//	was stored
+	virtual bool remove(const Tree& x) = 0;
+
+	//	Tells the TreeIndex that no Tree objects will be inserted or removed 
+	//	for a while, so it may lay itself out for reading. By default it does 
+	//	nothing
+	virtual void freeze();
+
+	//	Makes the next freeze lay out the Tree objects' coordinates along a 
+	//	Hilbert curve if on is true, so that nearby Trees are stored together,
+	//	and in the order of their keys otherwise. By default it does nothing
+	virtual void set_hilbert_order(bool on);
+
+	//	Returns the rotations and insert depths counted since the TreeIndex was
+	//	made. By default they are all 0
+	virtual RebalanceCounters rebalance_counters() const;
+
+	//	Adds the memory used by the nodes, the Tree objects and any secondary 
+	//	indexes to report. By default it adds nothing
+	virtual void add_memory_usage(MemoryReport& report) const;
+};
+
+//	Returns a new, empty TreeIndex of the given kind. The caller deletes it
+TreeIndex* make_tree_index(IndexBackend backend);
+
+//	Returns the name of the class that implements backend
+const char* backend_name(IndexBackend backend);
+
+//	Counts in results[q] the Tree objects of index within the distance of 
+//	query q of batch, for every query, with one call to 
+//	index.for_each_in_box. results has a GroupBy for each query. Index is a 
+//	TreeIndex or any class with the same for_each_in_box
+template <class Index>
+void group_nearby_batch(const Index& index, const NearbyBatch& batch,
+                        std::vector<GroupBy>& results) {
+	std::vector<CoordinateBox> boxes;
+	for (int q = 0; q < batch.size(); ++q) {
+		const NearbyQuery& query = batch.query(q);
+		CoordinateBox box;
+		if (CoordinateColumns::bounding_box(query.latitude, query.longitude,
+		                                    query.distance, box)) {
+			boxes.push_back(box);
+		}
+	}
+	long long distances = 0;
+	WorkCounters::add_trees_visited(index.for_each_in_box(boxes,
+	    [&batch, &results, &distances](const Tree& tree) {
+	      distances += batch.add(tree, results);
+	    }));
+	WorkCounters::add_haversines(distances);
+}
+
+//	Counts the Tree objects of index in corridor in groups, each one once, 
+//	with one call to index.for_each_in_box
+template <class Index>
+void group_in_corridor(const Index& index, const Corridor& corridor,
+                       GroupBy& groups) {
+	std::vector<CoordinateBox> boxes;
+	CoordinateColumns::corridor_boxes(corridor, boxes);
+	long long distances = 0;
+	WorkCounters::add_trees_visited(index.for_each_in_box(boxes,
+	    [&corridor, &groups, &distances](const Tree& tree) {
+	      double tree_lat, tree_lon;
+	      tree.get_position(tree_lat, tree_lon);
+	      ++distances;
+	      if (corridor.contains(tree_lat, tree_lon)) {
+	        groups.add(tree);
+	      }
+	    }));
+	WorkCounters::add_haversines(distances);
+}
+
+#endif
@@ -0,0 +1,25 @@
+/*******************************************************************************
+  Title          : work_counters.cpp
+  Description    : The implementation file for the WorkCounters class
+  Purpose        : To count how much work the queries do, like how many trees
+                   they visit and how many distances they compute
+  Usage          : Call enable() before the queries run and read the totals
+                   before and after each one
+  Build with     : g++ -c -std=c++11 work_counters.cpp
+  Modifications  :
+
+*******************************************************************************/
+
+#include "work_counters.h"
+
+std::atomic<bool> WorkCounters::enabled_(false);
+std::atomic<long long> WorkCounters::trees_visited_(0);
+std::atomic<long long> WorkCounters::haversines_(0);
+
+long long WorkCounters::trees_visited() {
+	return trees_visited_.load(std::memory_order_relaxed);
+}
+
+long long WorkCounters::haversines() {
+	return haversines_.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,70 @@
+/*******************************************************************************
+  Title          : work_counters.h
+  Description    : The interface file for the WorkCounters class
+  Purpose        : To count how much work the queries do, like how many trees
+                   they visit and how many distances they compute
+  Usage          : Call enable() before the queries run and read the totals
+                   before and after each one
+  Build with     : No building
+  Modifications  :
+
+*******************************************************************************/
+
+
+#ifndef __WORK_COUNTERS_H__
+#define __WORK_COUNTERS_H__
+
+#include <atomic>
+
+/*******************************************************************************
+
+		The WorkCounters class keeps running totals of the trees that the queries
+		visit and the haversine distances they compute. The indexes add to the
+		totals once for each query, not once for each tree, so a query on several
+		threads only touches the shared totals a few times. Nothing is counted
+		until enable() is called, and while the counters are off adding to them
+		costs one load of a flag that never changes, which is cheap enough for
+		every query to do
+
+*******************************************************************************/
+
+class WorkCounters {
+ public:
+	//	Starts counting if on is true and stops counting otherwise
+	static void enable(bool on) {
+		enabled_.store(on, std::memory_order_relaxed);
+	}
+
+	//	Returns true if the counters are counting
+	static bool enabled() {
+		return enabled_.load(std::memory_order_relaxed);
+	}
+
+	//	Adds trees to the number of trees visited
+	static void add_trees_visited(long long trees) {
+		if (enabled()) {
+			trees_visited_.fetch_add(trees, std::memory_order_relaxed);
+		}
+	}
+
+	//	Adds calls to the number of haversine distances computed
+	static void add_haversines(long long calls) {
+		if (enabled()) {
+			haversines_.fetch_add(calls, std::memory_order_relaxed);
+		}
+	}
+
+	//	Returns the number of trees visited since the counters were enabled
+	static long long trees_visited();
+
+	//	Returns the number of haversine distances computed since the counters
+	//	were enabled
+	static long long haversines();
+
+ private:
+	static std::atomic<bool> enabled_;
+	static std::atomic<long long> trees_visited_;
+	static std::atomic<long long> haversines_;
+};
+
+#endif
@@ -0,0 +1,155 @@
+/*******************************************************************************
+  Title          : work_stealing.cpp
+  Description    : The implementation file for the WorkStealingPool class
+  Purpose        : To split a loop over many independent pieces of work 
+                   between threads so that no thread sits idle while another 
+                   still has pieces left
+  Usage          : Call parallel_for() with the number of pieces and a function
+                   that does one piece
+  Build with     : g++ -c -std=c++11 -pthread work_stealing.cpp
+  Modifications  : 
+ 
+*******************************************************************************/
+
+#include "work_stealing.h"
+
+WorkStealingPool::WorkStealingPool(int number_of_workers)
+    : piece_(nullptr), remaining_(0), busy_(0), steals_(0), call_number_(0),
+      stopping_(false) {
+	if (number_of_workers <= 0) {
+		number_of_workers = std::thread::hardware_concurrency();
+	}
+	if (number_of_workers <= 0) {
+		number_of_workers = 1;
+	}
+	for (int i = 0; i < number_of_workers; ++i) {
+		deques_.push_back(std::unique_ptr<WorkerDeque>(new WorkerDeque));
+	}
+	//	worker 0 is the thread that calls parallel_for()
+	for (int i = 1; i < number_of_workers; ++i) {
+		threads_.push_back(std::thread(&WorkStealingPool::wait_for_work, this, i));
+	}
+}
+
+WorkStealingPool::~WorkStealingPool() {
+	{
+		std::lock_guard<std::mutex> lock(call_lock_);
+		stopping_ = true;
+	}
+	call_started_.notify_all();
+	for (unsigned int i = 0; i < threads_.size(); ++i) {
+		threads_[i].join();
+	}
+}
+
+int WorkStealingPool::size() const {
+	return deques_.size();
+}
+
+void WorkStealingPool::parallel_for(int number_of_pieces,
+                                    const std::function<void(int, int)>& piece)
+{
+	steals_ = 0;
+	if (number_of_pieces <= 0) {
+		return;
+	}
+	if (1 == size()) {
+		for (int i = 0; i < number_of_pieces; ++i) {
+			piece(i, 0);
+		}
+		return;
+	}
+	piece_ = &piece;
+	remaining_ = number_of_pieces;
+	busy_ = size() - 1;
+	{
+		std::lock_guard<std::mutex> lock(deques_[0]->lock);
+		Range all = {0, number_of_pieces};
+		deques_[0]->ranges.push_back(all);
+	}
+	{
+		std::lock_guard<std::mutex> lock(call_lock_);
+		++call_number_;
+	}
+	call_started_.notify_all();
+	work(0);
+	//	piece must stay alive until no thread can call it any more
+	while (0 < busy_) {
+		std::this_thread::yield();
+	}
+	piece_ = nullptr;
+}
+
+int WorkStealingPool::steals() const {
+	return steals_;
+}
+
+/*******************************************************************************
+
+																	PROTECTED
+
+*******************************************************************************/
+
+void WorkStealingPool::wait_for_work(int worker) {
+	unsigned long calls_seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(call_lock_);
+			call_started_.wait(lock, [this, calls_seen]() {
+				return stopping_ || call_number_ != calls_seen;
+			});
+			if (stopping_) {
+				return;
+			}
+			calls_seen = call_number_;
+		}
+		work(worker);
+		--busy_;
+	}
+}
+
+void WorkStealingPool::work(int worker) {
+	while (0 < remaining_) {
+		Range range;
+		if (!take(worker, range)) {
+			std::this_thread::yield();
+			continue;
+		}
+		//	split the range until one piece is left, leaving the upper halves 
+		//	where other workers can steal them
+		while (1 < range.end - range.begin) {
+			int middle = range.begin + (range.end - range.begin) / 2;
+			Range upper = {middle, range.end};
+			{
+				std::lock_guard<std::mutex> lock(deques_[worker]->lock);
+				deques_[worker]->ranges.push_back(upper);
+			}
+			range.end = middle;
+		}
+		(*piece_)(range.begin, worker);
+		--remaining_;
+	}
+}
+
+bool WorkStealingPool::take(int worker, Range& range) {
+	{
+		WorkerDeque& own = *deques_[worker];
+		std::lock_guard<std::mutex> lock(own.lock);
+		if (!own.ranges.empty()) {
+			range = own.ranges.back();
+			own.ranges.pop_back();
+			return true;
+		}
+	}
+	for (int i = 1; i < size(); ++i) {
+		WorkerDeque& victim = *deques_[(worker + i) % size()];
+		std::lock_guard<std::mutex> lock(victim.lock);
+		if (!victim.ranges.empty()) {
+			range = victim.ranges.front();
+			victim.ranges.pop_front();
+			++steals_;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,120 @@
+/*******************************************************************************
+  Title          : work_stealing.h
+  Description    : The interface file for the WorkStealingPool class
+  Purpose        : To split a loop over many independent pieces of work 
+                   between threads so that no thread sits idle while another 
+                   still has pieces left
+  Usage          : Call parallel_for() with the number of pieces and a function
+                   that does one piece
+  Build with     : No building 
+  Modifications  : 
+ 
+*******************************************************************************/
+
+
+#ifndef __WORK_STEALING_H__
+#define __WORK_STEALING_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*******************************************************************************
+
+		The WorkStealingPool class runs parallel_for() on its own threads plus 
+		the thread that calls it. Each of them is a worker with a deque of ranges
+		of piece numbers. parallel_for() puts the range of all the pieces on the 
+		calling worker's deque. A worker takes the range at the back of its own 
+		deque, and while the range has more than one piece it splits it in half,
+		puts the upper half back and keeps the lower half, so it always does the 
+		piece it reached last and leaves big ranges at the front. A worker whose 
+		deque is empty steals the range at the front of another worker's deque, 
+		which is the biggest one there. So the pieces are only split as far as 
+		the number of idle workers needs, and a worker that finishes early takes
+		work from one that is behind. Each deque has its own lock, which is only 
+		ever held for a push, a pop or a steal. Pieces can finish in any order, 
+		so the function should write its results somewhere that belongs to the 
+		piece or to the worker, which is passed to it
+
+*******************************************************************************/
+
+class WorkStealingPool {
+ public:
+	//	Creates a WorkStealingPool object with number_of_workers workers in 
+	//	total, counting the thread that calls parallel_for(), or one for each 
+	//	processor if number_of_workers is 0
+	explicit WorkStealingPool(int number_of_workers = 0);
+
+	//	Stops the workers
+	~WorkStealingPool();
+
+	//	Returns the number of workers, counting the thread that calls 
+	//	parallel_for()
+	int size() const;
+
+	//	Calls piece(i, worker) for every i from 0 up to but not including 
+	//	number_of_pieces, where worker is the number of the worker doing it, 
+	//	from 0 up to size(). Returns once every call has returned. Only one 
+	//	thread may call parallel_for() at a time
+	void parallel_for(int number_of_pieces,
+	                  const std::function<void(int, int)>& piece);
+
+	//	Returns the number of ranges that workers stole from each other during 
+	//	the last call to parallel_for()
+	int steals() const;
+
+ protected:
+	//	A range of piece numbers, from begin up to but not including end
+	struct Range {
+		int begin;
+		int end;
+	};
+
+	//	The deque of a worker and the lock that protects it
+	struct WorkerDeque {
+		std::mutex lock;
+		std::deque<Range> ranges;
+	};
+
+	//	What the threads run: waits for each call to parallel_for() and works 
+	//	on it
+	void wait_for_work(int worker);
+
+	//	Does pieces as worker until every piece of the current call is done
+	void work(int worker);
+
+	//	Takes a range for worker from its own deque or another worker's
+	//	Returns false if no deque had one
+	bool take(int worker, Range& range);
+
+ private:
+	WorkStealingPool(const WorkStealingPool&);
+	WorkStealingPool& operator=(const WorkStealingPool&);
+
+	std::vector<std::unique_ptr<WorkerDeque> > deques_;
+	std::vector<std::thread> threads_;
+
+	//	The function of the current call to parallel_for()
+	const std::function<void(int, int)>* piece_;
+
+	//	The number of pieces of the current call that are not done yet
+	std::atomic<int> remaining_;
+
+	//	The number of threads still working on the current call
+	std::atomic<int> busy_;
+
+	std::atomic<int> steals_;
+
+	//	Protects call_number_ and stopping_
+	std::mutex call_lock_;
+	std::condition_variable call_started_;
+	unsigned long call_number_;
+	bool stopping_;
+};
+
+#endif